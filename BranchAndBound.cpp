@@ -0,0 +1,817 @@
+#include "BranchAndBound.hpp"
+#include "Heuristics.hpp"
+#include "Checkpoint.hpp"
+#include "TinySolver.hpp"
+
+// nodes between open-bound scans when the heap is not keyed on bound
+const int GAP_CHECK_INTERVAL=64;
+
+// most round-off an LP bound is allowed before it is rounded down to an
+// integer, well below the half a fractional bound can be from either integer
+const double INTEGER_BOUND_SLACK=0.1;
+
+/*=============================================================================
+snap_solution - round an integral LP solution onto its integers and value it
+                from the objective coefficients, so the incumbent carries
+                neither the LP's tolerance nor the round-off its pivots and
+                cuts left in the objective row
+===============================================================================*/
+void snap_solution(LinearProgram* lp, OptimalSolution* sol){
+
+  const float* cost=lp->get_cost();
+  double eval=0;
+
+  for (size_t j = 0; j < lp->get_vars(); j++) {
+    sol->args[j]=std::round(sol->args[j])+0.0; // +0.0 turns -0 into 0
+    eval+=(double)cost[j]*sol->args[j];
+  }
+  sol->eval=eval;
+}
+
+/*=============================================================================
+estimate_node - estimated integer value below a node: its LP value less, for
+                each fractional variable, the cheaper rounding distance times
+                the variable's objective coefficient
+===============================================================================*/
+double estimate_node(OptimalSolution* sol, const float* obj_coef, int vars){
+
+  double estimate=sol->eval;
+
+  for (size_t i = 0; i < vars; i++) {
+    double frac=sol->args[i]-std::floor(sol->args[i]);
+    estimate-=std::fabs(obj_coef[i])*std::fmin(frac, 1-frac);
+  }
+
+  return estimate;
+}
+
+/*=============================================================================
+release_node - drop a node's own reference once it is fathomed or branched.
+              Nodes with live children stay until the last child is gone,
+              then the node, its LP unless that belongs to the caller,
+              and its basis go back to the pool, and so on up the tree.
+===============================================================================*/
+void release_node(Node* n){
+
+  while (n!=NULL && n->refs.fetch_sub(1, std::memory_order_acq_rel)==1){
+
+    Node* parent=n->parent;
+
+    if (n->owns_problem) delete n->problem;
+    if (n->path!=NULL) node_pool().release(n->path, n->depth*sizeof(BoundChange));
+    if (n->basis_bits!=NULL) node_pool().release(n->basis_bits, n->basis_words*sizeof(unsigned));
+    delete n;
+
+    n=parent;
+  }
+}
+
+/*=============================================================================
+root_node - pooled node for the caller's root LP
+===============================================================================*/
+Node* root_node(LinearProgram* root_tab){
+  Node* root=new Node{'R', NULL, root_tab, FLT_MAX, FLT_MAX};
+  root->owns_problem=false;
+  return root;
+}
+
+/*=============================================================================
+SearchContext Constructor - keep the root, copy its objective into pooled
+                            storage and start from the caller's pseudocosts
+===============================================================================*/
+SearchContext::SearchContext(LinearProgram* root_tab, const SearchSettings& settings): settings(settings), root(root_tab),
+                             pseudocosts(root_tab->get_vars(), settings.deterministic && settings.threads > 1),
+                             start(std::chrono::steady_clock::now()){
+
+  int vars=root_tab->get_vars();
+  obj_coef=(float*)node_pool().acquire(vars*sizeof(float));
+  integral_objective=true;
+  for (size_t i = 0; i < vars; i++) {
+    obj_coef[i]=root_tab->get_cost()[i];
+    if (obj_coef[i]!=std::floor(obj_coef[i])) integral_objective=false;
+  }
+  guide=(double*)node_pool().acquire(vars*sizeof(double));
+
+  //cuts are rows of the dense root Tableau, SparseLP roots are searched without,
+  //and so is its pricing rule, which every node LP inherits
+  Tableau* tab=dynamic_cast<Tableau*>(root_tab);
+  if (tab!=NULL) tab->set_pricing(settings.pricing);
+  cuts = (settings.cut_rounds > 0 && tab!=NULL) ? new CutPool(*tab) : NULL;
+
+  if (settings.pseudocosts!=NULL && settings.pseudocosts->slots()==pseudocosts.slots()) {
+    std::vector<long long> sums(pseudocosts.slots());
+    std::vector<long> counts(pseudocosts.slots());
+    settings.pseudocosts->save(sums.data(), counts.data());
+    pseudocosts.load(sums.data(), counts.data());
+  }
+}
+
+/*=============================================================================
+SearchContext Destructor - hand the pseudocosts back to the caller's, then
+                           release the pooled storage
+===============================================================================*/
+SearchContext::~SearchContext(){
+
+  if (settings.pseudocosts!=NULL && settings.pseudocosts->slots()==pseudocosts.slots()) {
+    std::vector<long long> sums(pseudocosts.slots());
+    std::vector<long> counts(pseudocosts.slots());
+    pseudocosts.save(sums.data(), counts.data());
+    settings.pseudocosts->load(sums.data(), counts.data());
+  }
+
+  node_pool().release(obj_coef, root->get_vars()*sizeof(float));
+  node_pool().release(guide, root->get_vars()*sizeof(double));
+  delete cuts;
+}
+
+/*=============================================================================
+SearchContext::set_guide - keep the values of a newly accepted incumbent for
+                           guided diving and hand it to the caller's callback.
+                           Search loops accept incumbents one at a time, so
+                           the callback is never entered twice at once.
+===============================================================================*/
+void SearchContext::set_guide(OptimalSolution* sol){
+  {
+    std::lock_guard<std::mutex> lock(guide_lock);
+    for (size_t i = 0; i < root->get_vars(); i++) guide[i]=sol->args[i];
+    has_guide=true;
+  }
+  if (settings.on_incumbent!=NULL) settings.on_incumbent(sol, settings.callback_data);
+}
+
+bool SearchContext::copy_guide(double* values){
+  std::lock_guard<std::mutex> lock(guide_lock);
+  if (!has_guide) return false;
+  for (size_t i = 0; i < root->get_vars(); i++) values[i]=guide[i];
+  return true;
+}
+
+/*=============================================================================
+SearchContext::over_limit - check the node, memory and time limits, in that
+                            order, the clock only read when there is a time
+                            limit. The first limit reached stays the status.
+===============================================================================*/
+bool SearchContext::over_limit(){
+
+  if (stopped()) return true;
+
+  SearchStatus reached=SEARCH_COMPLETE;
+  if (settings.node_limit > 0 && nodes.load(std::memory_order_relaxed) >= settings.node_limit) reached=SEARCH_NODE_LIMIT;
+  else if (settings.memory_stop > 0 && node_pool().bytes_in_use() > settings.memory_stop) reached=SEARCH_MEMORY_LIMIT;
+  else if (settings.time_limit > 0 &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() >= settings.time_limit) reached=SEARCH_TIME_LIMIT;
+  if (reached==SEARCH_COMPLETE) return false;
+
+  int none=SEARCH_COMPLETE;
+  status.compare_exchange_strong(none, reached);
+  return true;
+}
+
+/*=============================================================================
+SearchContext::integer_bound - with an integral objective no integer solution
+                               lies between an LP bound and the integer
+                               below it. The LP value's round-off, relative
+                               to its size but at most INTEGER_BOUND_SLACK,
+                               is allowed for before rounding.
+===============================================================================*/
+double SearchContext::integer_bound(double bound){
+
+  if (!integral_objective || std::isinf(bound) || std::fabs(bound) >= FLT_MAX) return bound;
+
+  double slack=std::fmin(root->get_tolerances().integrality*(1+std::fabs(bound)), INTEGER_BOUND_SLACK);
+  return std::floor(bound+slack);
+}
+
+/*=============================================================================
+SearchContext::within_gap - return if a relaxation bound cannot improve on
+                            the incumbent by more than the configured
+                            absolute or relative gap
+===============================================================================*/
+bool SearchContext::within_gap(double bound, double incumbent){
+
+  double gap=integer_bound(bound)-incumbent;
+
+  if (gap <= settings.abs_gap) return true;
+  if (incumbent != 0 && gap/std::fabs(incumbent) <= settings.rel_gap) return true;
+
+  return false;
+}
+
+/*=============================================================================
+SearchContext::set_bound - the best bound left open or dropped unsolved, or
+                           the incumbent's value if that is higher, and its
+                           gap to the incumbent, both infinite once the root
+                           proved unbounded
+===============================================================================*/
+void SearchContext::set_bound(double open_bound, bool has_incumbent, double incumbent){
+
+  if (unbounded()) {
+    bound=INFINITY;
+    gap=INFINITY;
+    return;
+  }
+
+  open_bound=std::fmax(open_bound, unsolved_bound.load(std::memory_order_relaxed));
+  bound = has_incumbent ? std::fmax(integer_bound(open_bound), incumbent) : integer_bound(open_bound);
+  if (!has_incumbent) gap=INFINITY;
+  else if (bound==incumbent) gap=0;
+  else gap = incumbent!=0 ? (bound-incumbent)/std::fabs(incumbent) : INFINITY;
+}
+
+/*=============================================================================
+SearchContext::report_stats - copy the counters to settings.stats, if given
+===============================================================================*/
+void SearchContext::report_stats(){
+
+  SearchStats* stats=settings.stats;
+  if (stats==NULL) return;
+
+  stats->nodes=nodes.load();
+  stats->lps=lps.load();
+  stats->pivots=pivots.load();
+  stats->tree_size=1+2*branched.load();
+  stats->max_open=max_open.load();
+  stats->pruned=pruned.load();
+  stats->infeasible=infeasible.load();
+  stats->integral=integral.load();
+  stats->unsolved=unsolved.load();
+  stats->root_cuts=root_cuts.load();
+  stats->node_cuts=node_cuts.load();
+  stats->strong_lps=strong_lps.load();
+  stats->heuristic_lps=heuristic_lps.load();
+  stats->heuristic_solutions=heuristic_solutions.load();
+  stats->spilled=spilled.load();
+  stats->restored=restored.load();
+  stats->status=(SearchStatus)status.load();
+  stats->bound=bound;
+  stats->gap=gap;
+
+  pivots_per_lp.copy_to(stats->pivots_per_lp);
+  for (int p = 0; p < PHASE_COUNT; p++) phase_ns[p].copy_to(stats->phase_ns[p]);
+}
+
+/*=============================================================================
+TreeTrace Constructor - DOT output opens the digraph
+===============================================================================*/
+TreeTrace::TreeTrace(std::ostream& out, TraceFormat format): out(out), format(format){
+  if (format==TRACE_DOT) out<<"digraph tree {"<<std::endl<<"  node [shape=box];"<<std::endl;
+}
+
+/*=============================================================================
+TreeTrace Destructor - DOT output closes the digraph
+===============================================================================*/
+TreeTrace::~TreeTrace(){
+  if (format==TRACE_DOT) out<<"}"<<std::endl;
+  out.flush();
+}
+
+/*=============================================================================
+status_name - lower case name of a NodeStatus
+===============================================================================*/
+static const char* status_name(NodeStatus status){
+
+  switch (status){
+    case NODE_PRUNED:     return "pruned";
+    case NODE_INFEASIBLE: return "infeasible";
+    case NODE_INTEGRAL:   return "integral";
+    case NODE_UNBOUNDED:  return "unbounded";
+    case NODE_UNSOLVED:   return "unsolved";
+    default:              return "branched";
+  }
+}
+
+/*=============================================================================
+TreeTrace::record - write one expanded node, as a JSON object or as a DOT
+                    vertex labelled with its branch constraint and LP value
+                    plus the edge from its parent
+===============================================================================*/
+void TreeTrace::record(const Node* n, NodeStatus status, double lp_value){
+
+  bool is_root = n->parent==NULL;
+  const char* sense = n->change.geq ? ">=" : "<=";
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (format==TRACE_JSONL){
+    out<<"{\"id\":"<<n->id<<",\"parent\":";
+    if (is_root) out<<"null,\"depth\":0,\"var\":null,\"sense\":null,\"rhs\":null,\"parent_bound\":null";
+    else out<<n->parent->id<<",\"depth\":"<<n->depth<<",\"var\":"<<n->change.var
+            <<",\"sense\":\""<<sense<<"\",\"rhs\":"<<n->change.bound<<",\"parent_bound\":"<<n->weight;
+    out<<",\"lp\":";
+    if (std::isnan(lp_value)) out<<"null";
+    else out<<lp_value;
+    out<<",\"status\":\""<<status_name(status)<<"\"}\n";
+    return;
+  }
+
+  const char* color = status==NODE_INTEGRAL ? "green" : status==NODE_INFEASIBLE ? "red" :
+                      status==NODE_PRUNED ? "gray" : status==NODE_UNBOUNDED ? "orange" :
+                      status==NODE_UNSOLVED ? "purple" : "black";
+
+  out<<"  n"<<n->id<<" [color="<<color<<",label=\""<<n->id;
+  if (!is_root) out<<"\\nx"<<n->change.var<<" "<<sense<<" "<<n->change.bound;
+  if (!std::isnan(lp_value)) out<<"\\n"<<lp_value;
+  out<<"\\n"<<status_name(status)<<"\"];\n";
+  if (!is_root) out<<"  n"<<n->parent->id<<" -> n"<<n->id<<";\n";
+}
+
+/*=============================================================================
+node_lp - rebuild a node's LP from the solved root and the branch
+          constraints on the path down to it, in the parent's basis when
+          warm starting. The root node solves the root LP itself. The
+          walk up ends early at the stand-in parent of a node read back
+          from disk, which holds the rest of the path.
+===============================================================================*/
+LinearProgram* node_lp(Node* curr, SearchContext& ctx){
+
+  if (curr->parent==NULL) return curr->problem;
+
+  BoundChange* changes=(BoundChange*)node_pool().acquire(curr->depth*sizeof(BoundChange));
+  Node* n=curr;
+  for (; n->parent!=NULL; n=n->parent) changes[n->depth-1]=n->change;
+  for (int i = 0; i < n->depth && n->path!=NULL; i++) changes[i]=n->path[i];
+
+  unsigned* basis_bits = ctx.settings.warm_start ? curr->parent->basis_bits : NULL;
+  LinearProgram* lp=ctx.root->rebuild(changes, curr->depth, basis_bits);
+
+  node_pool().release(changes, curr->depth*sizeof(BoundChange));
+  return lp;
+}
+
+/*=============================================================================
+new_child - open node one branch constraint below its parent
+===============================================================================*/
+Node* new_child(Node* parent, double bound, double estimate, int var, double rhs, bool geq, float distance){
+
+  Node* child=new Node;
+  child->weight=bound;
+  child->distance=distance;
+  child->estimate=estimate;
+  child->parent=parent;
+  child->change.var=var;
+  child->change.bound=rhs;
+  child->change.geq=geq;
+  child->depth=parent->depth+1;
+
+  parent->refs.fetch_add(1, std::memory_order_relaxed);
+  return child;
+}
+
+/*=============================================================================
+finish_node - count how a node was fathomed and trace it, if tracing
+===============================================================================*/
+static NodeStatus finish_node(Node* n, NodeStatus status, double lp_value, SearchContext& ctx){
+
+  switch (status){
+    case NODE_PRUNED:     ctx.pruned.fetch_add(1, std::memory_order_relaxed); break;
+    case NODE_INFEASIBLE: ctx.infeasible.fetch_add(1, std::memory_order_relaxed); break;
+    case NODE_INTEGRAL:   ctx.integral.fetch_add(1, std::memory_order_relaxed); break;
+    case NODE_UNSOLVED:
+      ctx.unsolved.fetch_add(1, std::memory_order_relaxed);
+      ctx.note_unsolved(n->weight);
+      break;
+    default: break;
+  }
+
+  if (ctx.settings.trace!=NULL) ctx.settings.trace->record(n, status, lp_value);
+  return status;
+}
+
+/*=============================================================================
+expand_node - prune, solve and branch one open node against an incumbent:
+              1. nodes whose parent bound cannot beat the incumbent are
+                  pruned without solving
+              2. the node's LP is rebuilt from the root and simplex is
+                  run to find new bound constraints
+              3. integral solutions are reported, otherwise the settings'
+                  start is tried at the root, the primal heuristics run
+                  there and every heuristic_frequency node ids, and the
+                  down and up child are created, holding only their
+                  additional branch constraint
+===============================================================================*/
+NodeStatus expand_node(Node* curr, bool has_incumbent, double incumbent, SearchContext& ctx, Node** children, Node** found){
+
+  const SearchSettings& settings=ctx.settings;
+  *found=NULL;
+  ctx.nodes.fetch_add(1, std::memory_order_relaxed);
+
+  //prune on the parent's bound before paying for simplex
+  if (has_incumbent && ctx.within_gap(curr->weight, incumbent)) return finish_node(curr, NODE_PRUNED, NAN, ctx);
+
+  //rebuild and solve simplex
+  OptimalSolution* sol;
+  {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_BUILD);
+    curr->problem=node_lp(curr, ctx);
+  }
+  {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_SIMPLEX);
+    sol=curr->problem->simplex();
+  }
+
+  //the root LP takes its cuts before any node is rebuilt from it
+  if (curr->parent==NULL && ctx.cuts!=NULL && curr->problem->get_feasibility()) {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_CUTS);
+    ctx.root_cuts.fetch_add(ctx.cuts->root_rounds(*static_cast<Tableau*>(curr->problem), settings.cut_rounds), std::memory_order_relaxed);
+    sol=curr->problem->simplex();
+  }
+  int vars=curr->problem->get_vars();
+  long pivots=curr->problem->get_pivots();
+  ctx.lps.fetch_add(1, std::memory_order_relaxed);
+  ctx.pivots.fetch_add(pivots, std::memory_order_relaxed);
+  PROFILE_SAMPLE(ctx.pivots_per_lp, pivots);
+
+  //every node LP restricts the root's, so only the root can be unbounded, and
+  //then no bound exists to search under
+  if (curr->problem->get_unbounded()) {
+    ctx.status.store(SEARCH_UNBOUNDED, std::memory_order_relaxed);
+    return finish_node(curr, NODE_UNBOUNDED, NAN, ctx);
+  }
+
+  //an LP that stopped at its iteration limit gives no bound of its own, the node
+  //is dropped and its parent's bound stays in the bound of the search
+  if (!curr->problem->get_status()) return finish_node(curr, NODE_UNSOLVED, NAN, ctx);
+
+  //infeasible subproblems and subproblems whose own bound cannot beat the incumbent are fathomed
+  if (!curr->problem->get_feasibility()) return finish_node(curr, NODE_INFEASIBLE, NAN, ctx);
+
+  //how far the branch pulled the bound down teaches the pseudocosts of its variable
+  if (curr->parent!=NULL && (settings.branching==PSEUDOCOST || settings.branching==RELIABILITY)) {
+    ctx.pseudocosts.record(curr->change.var, curr->change.geq, (curr->weight-sol->eval)/curr->distance);
+  }
+
+  if (has_incumbent && ctx.within_gap(sol->eval, incumbent)) return finish_node(curr, NODE_PRUNED, sol->eval, ctx);
+
+  //determine if branching is needed and what the variable would be
+  int branch_var;
+  {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_FIND_FLOAT);
+    long strong_lps=0, strong_pivots=0;
+    branch_var=select_branch(curr->problem, sol, settings.branching, settings.strong_candidates, settings.reliability,
+                             ctx.pseudocosts, strong_lps, strong_pivots);
+    if (strong_lps > 0) {
+      ctx.strong_lps.fetch_add(strong_lps, std::memory_order_relaxed);
+      ctx.pivots.fetch_add(strong_pivots, std::memory_order_relaxed);
+    }
+  }
+
+  //candidate solutions are snapped onto the integers they lie within tolerance of,
+  //and valued from the objective itself rather than the round-off of the LP's value
+  if (branch_var==-1){
+    snap_solution(curr->problem, sol);
+    curr->weight=sol->eval;
+    return finish_node(curr, NODE_INTEGRAL, sol->eval, ctx);
+  }
+
+  //Otherwise there are potentially still candidate solutions down this path,
+  //both children inherit this node's LP value as their bound
+  double value=sol->eval;
+
+  //shallow nodes tighten that bound with cuts valid below them
+  if (ctx.cuts!=NULL && curr->depth > 0 && curr->depth <= settings.cut_depth) {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_CUTS);
+    long added=0;
+    double bound=value;
+    bool feasible=ctx.cuts->node_bound(*static_cast<Tableau*>(curr->problem), settings.cut_rounds, bound, added);
+    ctx.node_cuts.fetch_add(added, std::memory_order_relaxed);
+
+    if (!feasible) return finish_node(curr, NODE_INFEASIBLE, NAN, ctx);
+    value=std::fmin(value, bound);
+    if (has_incumbent && ctx.within_gap(value, incumbent)) return finish_node(curr, NODE_PRUNED, value, ctx);
+  }
+
+  //a known solution of the caller is the root's first candidate
+  if (curr->parent==NULL && settings.start!=NULL) {
+    long start_pivots=0;
+    Node* start=fixed_node(settings.start, ctx, start_pivots);
+    ctx.heuristic_lps.fetch_add(1, std::memory_order_relaxed);
+    ctx.pivots.fetch_add(start_pivots, std::memory_order_relaxed);
+    if (start!=NULL && (!has_incumbent || !ctx.within_gap(start->weight, incumbent))) {
+      *found=start;
+      has_incumbent=true;
+      incumbent=start->weight;
+    }
+    else if (start!=NULL) release_node(start);
+  }
+
+  //look for an integer solution near this node's LP solution
+  if (settings.heuristics && (curr->depth==0 || (settings.heuristic_frequency > 0 && curr->id%settings.heuristic_frequency==0))) {
+    PROFILE_SCOPE(ctx.phase_ns, PHASE_HEURISTICS);
+    Node* better=run_heuristics(curr, sol, has_incumbent, incumbent, ctx);
+    if (better!=NULL) {
+      if (*found!=NULL) release_node(*found);
+      *found=better;
+      has_incumbent=true;
+      incumbent=better->weight;
+    }
+  }
+  if (*found!=NULL && ctx.within_gap(value, incumbent)) return finish_node(curr, NODE_PRUNED, value, ctx);
+
+  double estimate=std::fmin(value, estimate_node(sol, ctx.obj_coef, vars));
+
+  // branch down and up on nearest integer bounds of floating point value
+  double x=sol->args[branch_var];
+  children[0]=new_child(curr, value, estimate, branch_var, std::floor(x), false, x-std::floor(x));
+  children[1]=new_child(curr, value, estimate, branch_var, std::ceil(x), true, std::ceil(x)-x);
+  children[0]->id=ctx.next_id.fetch_add(2, std::memory_order_relaxed);
+  children[1]->id=children[0]->id+1;
+  ctx.branched.fetch_add(1, std::memory_order_relaxed);
+
+  //children only keep this node's basis, its LP is recycled now
+  if (settings.warm_start){
+    curr->basis_words=curr->problem->basis_words();
+    curr->basis_bits=(unsigned*)node_pool().acquire(curr->basis_words*sizeof(unsigned));
+    curr->problem->compress_basis(curr->basis_bits);
+  }
+  if (curr->owns_problem) delete curr->problem;
+  curr->problem=NULL;
+
+  return finish_node(curr, NODE_BRANCHED, value, ctx);
+}
+
+/*=============================================================================
+tiny_search - solve a root with a TinySolver if it fits one: an unsolved dense
+              Tableau of at most TINY_MAX_VARS variables and TINY_MAX_ROWS
+              rows, at its default tolerances, every variable bounded below,
+              every slack in [0, inf), searched serially without cuts,
+              trace, checkpoint, limits, start or pseudocosts. False if it
+              does not fit or the solver hands it back, and the general
+              search runs instead, from start when the solver had found an
+              integer solution. The callback only sees the final incumbent.
+===============================================================================*/
+static bool tiny_search(LinearProgram* root_tab, const SearchSettings& settings, OptimalSolution** result,
+                        std::vector<double>& start){
+
+  Tableau* tab=dynamic_cast<Tableau*>(root_tab);
+  if (!settings.tiny || tab==NULL || tab->get_status() || !tab->get_feasibility()) return false;
+  if (settings.threads > 1 || settings.cut_rounds > 0 || settings.trace!=NULL || settings.checkpoint!=NULL ||
+      settings.time_limit > 0 || settings.node_limit > 0 || settings.memory_stop > 0 || settings.memory_limit > 0 ||
+      settings.start!=NULL || settings.pseudocosts!=NULL) return false;
+
+  //the solver keeps its own thresholds, so a root given others is searched as set
+  const Tolerances& given=tab->get_tolerances();
+  Tolerances defaults=scalar_tolerances<Tableau::Scalar>();
+  if (given.pivot!=defaults.pivot || given.feasibility!=defaults.feasibility ||
+      given.optimality!=defaults.optimality || given.integrality!=defaults.integrality) return false;
+
+  int vars=tab->get_vars();
+  int rows=tab->get_rows()-1;
+  int rhs=tab->get_columns()-1;
+  if (vars > TINY_MAX_VARS || rows > TINY_MAX_ROWS) return false;
+
+  TinyModel<TINY_MAX_VARS, TINY_MAX_ROWS> model;
+  model.vars=vars;
+  model.rows=rows;
+  for (int j = 0; j < vars; j++) {
+    if (tab->get_flipped()[j] || tab->get_lower()[j] <= -FLT_MAX) return false;
+    model.obj[j]=tab->get_cost()[j];
+    model.lower[j]=tab->get_lower()[j];
+    model.upper[j] = tab->get_upper()[j] >= FLT_MAX ? TINY_INFINITY : (double)tab->get_upper()[j];
+  }
+
+  //set_bounds moved each RHS to the lower bounds, the model's own is restored
+  for (int i = 0; i < rows; i++) {
+    int slack=vars+i;
+    if (tab->get_basis()[i]!=slack || tab->get_flipped()[slack] || tab->get_lower()[slack]!=0 ||
+        tab->get_upper()[slack] < FLT_MAX) return false;
+    double b=(*tab)[i][rhs];
+    for (int j = 0; j < vars; j++) {
+      model.cons[i][j]=(*tab)[i][j];
+      b+=model.cons[i][j]*model.lower[j];
+    }
+    model.cons[i][vars]=b;
+  }
+
+  TinyResult<TINY_MAX_VARS> tiny=TinySolver<TINY_MAX_VARS, TINY_MAX_ROWS>::solve(model, settings.abs_gap, settings.rel_gap);
+  if (tiny.status==TINY_UNSOLVED) {
+    if (tiny.found) start.assign(tiny.args.begin(), tiny.args.begin()+vars);
+    return false;
+  }
+
+  *result=NULL;
+  if (tiny.status==TINY_OPTIMAL) {
+    OptimalSolution sol{tiny.eval, tiny.args.data()};
+    *result=copy_solution(&sol, vars);
+    if (settings.on_incumbent!=NULL) settings.on_incumbent(*result, settings.callback_data);
+  }
+
+  SearchStats* stats=settings.stats;
+  if (stats!=NULL) {
+    *stats=SearchStats();
+    stats->nodes=tiny.nodes;
+    stats->lps=tiny.nodes;
+    stats->pivots=tiny.pivots;
+    stats->tree_size=1+2*tiny.branched;
+    stats->max_open=1;
+    if (*result!=NULL) {
+      stats->bound=(*result)->eval;
+      stats->gap=0;
+    }
+  }
+  return true;
+}
+
+/*=============================================================================
+branch_and_bound - performs a tree search, in the order chosen by the
+                    settings' NodeSelection, expanding each visited node.
+                    Integer solutions replace the incumbent if they improve
+                    on it, the children of fractional nodes are pushed onto
+                    the open nodes. The search ends early once every open
+                    node is within the configured gap of the incumbent, or
+                    once a limit is reached, checked before each node.
+                    Nodes go back to the pool as soon as they are fathomed
+                    or branched, the returned solution is the caller's.
+                    With a checkpoint file the search snapshots itself
+                    between expansions, and can resume from there. A
+                    search stopped by a limit keeps a last snapshot.
+                    Models as small as the example's go to a TinySolver.
+=============================================================================*/
+OptimalSolution* branch_and_bound(LinearProgram* root_tab, SearchSettings settings){
+
+  //a model the TinySolver hands back is searched from its incumbent
+  OptimalSolution* tiny;
+  std::vector<double> tiny_start;
+  if (tiny_search(root_tab, settings, &tiny, tiny_start)) return tiny;
+  if (!tiny_start.empty()) settings.start=tiny_start.data();
+
+  if (settings.threads > 1) return parallel_branch_and_bound(root_tab, settings);
+
+  SearchContext ctx(root_tab, settings);
+  CheckpointWriter checkpoints(settings);
+
+  OpenNodes next_up(settings);
+  Node* best=NULL;
+  if (!resume_search(next_up, ctx, &best)) {
+    next_up.push(root_node(root_tab));
+    ctx.note_open(1);
+  }
+
+  Node* curr;
+  Node* children[2];
+  Node* found;
+
+  bool has_incumbent = best!=NULL;
+  double incumbent = best!=NULL ? best->weight : -FLT_MAX;
+  int processed=0;
+
+  while(!next_up.is_empty()){
+
+    //stop once no open node can improve on the incumbent by more than the gap
+    if (has_incumbent && (next_up.bound_is_cheap() || processed%GAP_CHECK_INTERVAL==0) &&
+        ctx.within_gap(next_up.max_weight(), incumbent)) break;
+
+    //a limit leaves the open nodes unexplored, their bound is reported
+    if (ctx.over_limit()) break;
+
+    //examine next problem
+    {
+      PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+      curr=next_up.pop();
+    }
+    processed++;
+
+    NodeStatus status=expand_node(curr, has_incumbent, incumbent, ctx, children, &found);
+
+    //a heuristic solution better than the incumbent replaces it
+    if (found!=NULL) {
+      if (best!=NULL) release_node(best);
+      best=found;
+      incumbent=found->weight;
+      has_incumbent=true;
+      next_up.incumbent_found();
+      ctx.set_guide(found->problem->get_sol());
+    }
+
+    switch (status){
+
+      //If an improving candidate solution has been found, it becomes the incumbent
+      //and the one it replaces is recycled
+      case NODE_INTEGRAL:
+        if (best!=NULL) release_node(best);
+        best=curr;
+        incumbent=curr->weight;
+        has_incumbent=true;
+        next_up.incumbent_found();
+        ctx.set_guide(curr->problem->get_sol());
+        break;
+
+      // push children onto the open nodes, up branch explored first when diving,
+      // the parent's LP has been copied into them and is recycled
+      case NODE_BRANCHED:
+        {
+          PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+          next_up.push(children[0]);
+          next_up.push(children[1]);
+        }
+        ctx.note_open(next_up.size);
+        release_node(curr);
+        break;
+
+      // pruned and infeasible nodes are recycled straight away
+      default:
+        release_node(curr);
+        break;
+    }
+
+    if (checkpoints.due()) checkpoints.write(snapshot_search(next_up, ctx, best, ctx.next_id.load()));
+  }
+
+  if (ctx.stopped() && !ctx.unbounded() && checkpoints.enabled()) checkpoints.finish(snapshot_search(next_up, ctx, best, ctx.next_id.load()));
+  else checkpoints.finish();
+  ctx.set_bound(next_up.max_weight(), has_incumbent, incumbent);
+  next_up.clear();
+  next_up.report(ctx);
+  ctx.report_stats();
+
+  //If there are no integer-feasible solutions to the problem, or no optimal one, return NULL for UI-level handling
+  if (best==NULL) return NULL;
+  if (ctx.unbounded()) {
+    release_node(best);
+    return NULL;
+  }
+
+  //the incumbent's LP goes back to the pool, the caller owns a copy of its solution
+  OptimalSolution* result=copy_solution(best->problem->get_sol(), root_tab->get_vars());
+  release_node(best);
+  return result;
+}
+
+/*=============================================================================
+PresolvedCallback - the caller's incumbent callback, behind one that maps the
+                    reduced problem's solutions back onto the original columns
+===============================================================================*/
+struct PresolvedCallback{
+  Presolver* presolver;
+  IncumbentCallback callback;
+  void* data;
+};
+
+static void postsolve_incumbent(const OptimalSolution* reduced, void* data){
+  PresolvedCallback* outer=(PresolvedCallback*)data;
+  OptimalSolution* sol=outer->presolver->postsolve(const_cast<OptimalSolution*>(reduced));
+  outer->callback(sol, outer->data);
+  delete[] sol->args;
+  delete sol;
+}
+
+/*=============================================================================
+branch_and_bound - presolve, search the reduced problem and postsolve its
+                   solution. A problem whose columns were all fixed is
+                   solved by presolve alone. Incumbents passed to the
+                   callback and the reported bound are of the original
+                   problem.
+=============================================================================*/
+OptimalSolution* branch_and_bound(Presolver& presolver, SearchSettings settings, bool sparse){
+
+  if (!presolver.presolve()) return NULL;
+
+  LinearProgram* root=presolver.build(sparse);
+  if (root==NULL) {
+    OptimalSolution* fixed=presolver.postsolve(NULL);
+    if (settings.stats!=NULL) {
+      settings.stats->bound=fixed->eval;
+      settings.stats->gap=0;
+    }
+    return fixed;
+  }
+
+  //a start and pseudocosts are in the original columns, which the reduced root has lost
+  settings.start=NULL;
+  settings.pseudocosts=NULL;
+
+  PresolvedCallback outer{&presolver, settings.on_incumbent, settings.callback_data};
+  if (settings.on_incumbent!=NULL) {
+    settings.on_incumbent=postsolve_incumbent;
+    settings.callback_data=&outer;
+  }
+
+  OptimalSolution* reduced=branch_and_bound(root, settings);
+  OptimalSolution* result = reduced==NULL ? NULL : presolver.postsolve(reduced);
+
+  //the fixed columns add a constant to every objective value, the reduced
+  //problem's value at its origin. A bound at the incumbent stays on it, and
+  //the gap is taken again against the postsolved incumbent
+  SearchStats* stats=settings.stats;
+  if (stats!=NULL && stats->bound!=-FLT_MAX) {
+    if (reduced!=NULL && stats->bound==reduced->eval) stats->bound=result->eval;
+    else {
+      std::vector<double> origin(root->get_vars(), 0.0);
+      OptimalSolution at_origin{0, origin.data()};
+      OptimalSolution* shifted=presolver.postsolve(&at_origin);
+      stats->bound+=shifted->eval;
+      delete[] shifted->args;
+      delete shifted;
+    }
+
+    if (result==NULL || std::isinf(stats->bound)) stats->gap=INFINITY;
+    else if (stats->bound<=result->eval) stats->gap=0;
+    else stats->gap = result->eval!=0 ? (stats->bound-result->eval)/std::fabs(result->eval) : INFINITY;
+  }
+
+  if (reduced!=NULL) {
+    delete[] reduced->args;
+    delete reduced;
+  }
+  delete root;
+  return result;
+}
@@ -0,0 +1,398 @@
+#include <iostream>
+#include <cfloat>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "Tableau.hpp"
+#include "SparseLP.hpp"
+#include "Stack.hpp"
+#include "NodeHeap.hpp"
+#include "NodeStore.hpp"
+#include "Profile.hpp"
+#include "Presolve.hpp"
+#include "Cuts.hpp"
+#include "Branching.hpp"
+
+#ifndef BRANCHANDBOUND_HPP
+#define BRANCHANDBOUND_HPP
+
+/*=============================================================================
+NodeSelection - order in which open nodes are explored
+===============================================================================*/
+enum NodeSelection{
+  DEPTH_FIRST,        // LIFO stack, newest child first
+  BEST_FIRST,         // largest LP bound first
+  BEST_ESTIMATE,      // largest estimated integer value first
+  DEPTH_THEN_BEST     // depth first until an incumbent exists, then best first
+};
+
+/*=============================================================================
+SearchStatus - why a search ended
+===============================================================================*/
+enum SearchStatus{
+  SEARCH_COMPLETE,      // every open node was fathomed, or is within the gaps of the incumbent
+  SEARCH_TIME_LIMIT,    // time_limit seconds passed
+  SEARCH_NODE_LIMIT,    // node_limit nodes were taken off the open nodes
+  SEARCH_MEMORY_LIMIT,  // pooled bytes passed memory_stop
+  SEARCH_UNBOUNDED      // the root LP is unbounded, so no optimum is reported
+};
+
+/*=============================================================================
+SearchStats - counters of one search, filled in when the settings point at
+              them. Pivots include those of reinverting a parent's basis.
+              The histograms stay empty when built with BB_NO_PROFILE.
+===============================================================================*/
+struct SearchStats{
+  long nodes=0;         // nodes taken off the open nodes, pruned ones included
+  long lps=0;           // node LPs solved
+  long pivots=0;        // simplex pivots over every node LP
+  long tree_size=0;     // nodes created, the root and two children per branch
+  long max_open=0;      // most nodes open at once
+  long pruned=0;        // nodes fathomed by bound, before or after their LP
+  long infeasible=0;    // nodes whose LP had no feasible point
+  long integral=0;      // nodes whose LP solution was integral
+  long unsolved=0;      // nodes dropped because their LP stopped at its iteration limit
+  long root_cuts=0;     // cuts added to the root LP over its cut rounds
+  long node_cuts=0;     // cuts added to copies of shallow node LPs
+  long strong_lps=0;    // child LPs solved by strong branching, their pivots count in pivots
+  long heuristic_lps=0; // LPs solved by the primal heuristics, their pivots count in pivots
+  long heuristic_solutions=0; // improving integer solutions the primal heuristics found
+  long spilled=0;       // open nodes written to the spill file, again each time one is re-spilled
+  long restored=0;      // spilled nodes read back into memory
+  SearchStatus status=SEARCH_COMPLETE;  // why the search ended
+  double bound=-FLT_MAX; // proven bound: no integer solution is better, the incumbent's value once complete unless nodes
+                         // were unsolved, infinite if unbounded
+  double gap=INFINITY;   // (bound - incumbent) / |incumbent|, infinite without an incumbent
+  Histogram pivots_per_lp;          // pivots of each node LP
+  Histogram phase_ns[PHASE_COUNT];  // nanoseconds per call of each ProfilePhase
+};
+
+class TreeTrace;
+
+/*=============================================================================
+IncumbentCallback - receives each improving solution as the search accepts
+                    it, with the settings' callback_data. Called from the
+                    thread that found it, one call at a time and in
+                    improving order. The solution is only valid during the
+                    call.
+===============================================================================*/
+typedef void (*IncumbentCallback)(const OptimalSolution*, void* data);
+
+/*=============================================================================
+SearchSettings - node selection policy and the tolerances controlling pruning
+                 and early termination. A node is pruned, and the search stops,
+                 once the bound still to be explored is within either gap of
+                 the incumbent, or earlier once a limit is reached.
+===============================================================================*/
+struct SearchSettings{
+  double abs_gap=1e-6;                      // absolute gap: bound - incumbent
+  double rel_gap=0;                         // relative gap: (bound - incumbent) / |incumbent|
+  NodeSelection selection=DEPTH_THEN_BEST;  // policy for picking the next open node
+  BranchingRule branching=RELIABILITY;      // rule for picking the branching variable
+  int strong_candidates=8;                  // most variables strong branching solves the children of per node
+  int reliability=4;                        // observations per side after which pseudocosts are trusted
+  bool heuristics=true;                     // run the primal heuristics at the root and every heuristic_frequency nodes
+  int heuristic_frequency=50;               // node ids between reruns in the tree, 0 for the root only
+  double heuristic_time=0.005;              // seconds each heuristic may spend per run, ignored by the deterministic search
+  size_t memory_limit=0;                    // pooled bytes above which search switches to depth first, 0 for none
+  double time_limit=0;                      // seconds after which the search stops, 0 for none
+  long node_limit=0;                        // nodes after which the search stops, 0 for none
+  size_t memory_stop=0;                     // pooled bytes above which the search stops, 0 for none
+  IncumbentCallback on_incumbent=NULL;      // called with every improving solution when not NULL
+  void* callback_data=NULL;                 // passed to on_incumbent
+  const double* start=NULL;                 // integer values of a known solution, tried at the root as the first incumbent
+  Pseudocosts* pseudocosts=NULL;            // of earlier searches of the same columns, the search starts from them and adds its own
+  int spill_nodes=0;                        // heap nodes above which the coldest are spilled to disk, 0 for none
+  const char* spill_directory=NULL;         // directory of the spill file, $TMPDIR or /tmp if NULL
+  const char* checkpoint=NULL;              // file the serial and deterministic searches snapshot themselves to, NULL for none
+  double checkpoint_interval=60;            // seconds between snapshots
+  bool resume=false;                        // continue from the checkpoint file when it exists
+  bool warm_start=true;                     // rebuild node LPs in their parent's basis instead of the root's
+  PricingRule pricing=PRICE_STEEPEST_EDGE;  // entering column rule of a dense Tableau root and its nodes
+  bool tiny=true;                           // solve models that fit a TinySolver with it
+  int threads=1;                            // worker threads, more than 1 runs the parallel search
+  bool deterministic=false;                 // parallel search in synchronized rounds, reproducible results
+  int cut_rounds=0;                         // rounds of Gomory cuts on a Tableau root LP, 0 for none
+  int cut_depth=0;                          // nodes down to this depth also tighten their bound with cuts
+  SearchStats* stats=NULL;                  // receives the search's counters when not NULL
+  TreeTrace* trace=NULL;                    // records every expanded node when not NULL
+};
+
+/*=============================================================================
+snap_solution - round an integral LP solution onto its integers, its value
+                recomputed from the LP's objective coefficients
+===============================================================================*/
+void snap_solution(LinearProgram*, OptimalSolution*);
+
+/*=============================================================================
+NodeStatus - outcome of expanding one open node
+===============================================================================*/
+enum NodeStatus{
+  NODE_PRUNED,        // bound cannot beat the incumbent
+  NODE_INFEASIBLE,    // LP relaxation has no feasible point
+  NODE_INTEGRAL,      // LP solution is integral, a candidate incumbent
+  NODE_BRANCHED,      // fractional, two children were created
+  NODE_UNBOUNDED,     // LP relaxation is unbounded, the search stops
+  NODE_UNSOLVED       // LP stopped at its iteration limit, the node is dropped and its bound kept
+};
+
+/*=============================================================================
+TraceFormat - layout of a TreeTrace
+===============================================================================*/
+enum TraceFormat{
+  TRACE_JSONL,        // one JSON object per expanded node
+  TRACE_DOT           // Graphviz digraph, one vertex per node and an edge from its parent
+};
+
+/*=============================================================================
+TreeTrace - export of the explored tree: for every expanded node its id, its
+            parent's id, the branch constraint it adds, the bound inherited
+            from its parent, its LP value and how it was fathomed. The LP
+            value is NaN, written as null, for nodes pruned before their LP
+            was solved and for infeasible ones. Records are written under a
+            lock as nodes finish, so parallel searches interleave them in
+            completion order. The stream must outlive the trace.
+===============================================================================*/
+class TreeTrace{
+  private:
+    std::ostream& out;
+    TraceFormat format;
+    std::mutex lock;
+
+  public:
+    TreeTrace(std::ostream&, TraceFormat);  // Constructor, writes the DOT header
+    ~TreeTrace();                           // Destructor, writes the DOT footer
+    void record(const Node*, NodeStatus, double lp_value);
+};
+
+/*=============================================================================
+SearchContext - state shared by every node of one search: the settings, the
+                root LP every node's LP is rebuilt from, the root's
+                objective coefficients for node estimates, the cut pool,
+                the pseudocosts, the incumbent's values guiding the
+                heuristics and the counters every worker adds to
+===============================================================================*/
+struct SearchContext{
+  SearchSettings settings;
+  LinearProgram* root;  // solved in place by the root node, read-only afterwards
+  float* obj_coef;      // objective coefficients
+  bool integral_objective;  // every objective coefficient is an integer, and so is every solution's value
+  CutPool* cuts;        // Gomory cuts of a Tableau root when settings ask for cuts, otherwise NULL
+  Pseudocosts pseudocosts;  // staged in the deterministic parallel search, committed after each round
+  std::atomic<long> nodes{0}, lps{0}, pivots{0}, branched{0};
+  std::atomic<long> pruned{0}, infeasible{0}, integral{0}, unsolved{0};
+  std::atomic<long> root_cuts{0}, node_cuts{0}, strong_lps{0};
+  std::atomic<long> heuristic_lps{0}, heuristic_solutions{0};
+  std::atomic<long> spilled{0}, restored{0};
+  std::mutex guide_lock;
+  double* guide;        // values of the incumbent, set by the search loops as they accept one
+  bool has_guide=false;
+  std::atomic<long> max_open{0};
+  std::atomic<double> unsolved_bound{-FLT_MAX}; // largest parent bound of the unsolved nodes
+  std::atomic<long> next_id{1};               // id of the next node created, the root is 0
+  std::chrono::steady_clock::time_point start; // construction, the time limit counts from here
+  std::atomic<int> status{SEARCH_COMPLETE};   // first limit reached, a SearchStatus
+  double bound=-FLT_MAX;                      // proven bound once the search has ended
+  double gap=INFINITY;                        // relative gap of the bound to the incumbent
+  SharedHistogram pivots_per_lp;
+  SharedHistogram phase_ns[PHASE_COUNT];
+
+  SearchContext(LinearProgram*, const SearchSettings&);
+  ~SearchContext();
+
+  //record the number of open nodes if it is the largest so far
+  void note_open(long open) {
+    long seen=max_open.load(std::memory_order_relaxed);
+    while (open > seen && !max_open.compare_exchange_weak(seen, open, std::memory_order_relaxed));
+  }
+
+  //keep the parent bound of an unsolved node in the bound of the search
+  void note_unsolved(double weight) {
+    double seen=unsolved_bound.load(std::memory_order_relaxed);
+    while (weight > seen && !unsolved_bound.compare_exchange_weak(seen, weight, std::memory_order_relaxed));
+  }
+
+  bool stopped() { return status.load(std::memory_order_relaxed)!=SEARCH_COMPLETE; }
+  bool unbounded() { return status.load(std::memory_order_relaxed)==SEARCH_UNBOUNDED; }
+  bool over_limit();    // a limit has been reached, recorded as the status if it is the first
+  double integer_bound(double);       // an LP bound rounded down to an integer if the objective is integral
+  bool within_gap(double bound, double incumbent);  // the bound cannot beat the incumbent by more than the settings' gaps
+  void set_bound(double open_bound, bool has_incumbent, double incumbent);  // bound and gap of the ended search
+  void report_stats();  // copy the counters to settings.stats, if given
+  void set_guide(OptimalSolution*);   // copy a newly accepted incumbent's values and pass it to on_incumbent
+  bool copy_guide(double*);           // the incumbent's values, false if there is none yet
+};
+
+/*=============================================================================
+expand_node - prune, solve and branch one open node against an incumbent.
+              Integral solutions are snapped onto the integers, branched nodes
+              fill children with the down and up child, and found receives an
+              improving solution of the primal heuristics or, at the root,
+              the settings' start, or NULL. Touches no
+              shared state but the context's counters, so workers can expand
+              nodes concurrently.
+===============================================================================*/
+NodeStatus expand_node(Node*, bool has_incumbent, double incumbent, SearchContext&, Node** children, Node** found);
+
+/*=============================================================================
+release_node - drop a node's own reference once it is fathomed or branched.
+              Nodes with live children stay until the last child is gone,
+              then the node, its LP unless that belongs to the caller,
+              and its basis go back to the pool, and so on up the tree.
+===============================================================================*/
+void release_node(Node*);
+
+/*=============================================================================
+root_node - pooled node for the caller's root LP
+===============================================================================*/
+Node* root_node(LinearProgram*);
+
+/*=============================================================================
+OpenNodes - the open nodes of the search. Nodes live on the Stack while diving
+            and in a NodeHeap for best-first and best-estimate selection.
+            While the pool holds more than the memory limit, children go on
+            the stack whatever the policy, and the stack is always emptied
+            before the heap, so the search dives until memory is released.
+            With a spill limit, a heap grown past it keeps its best half
+            and spills the rest to a NodeStore on disk. A spilled batch is
+            read back once its best key beats the heap's, so the heap
+            order is kept across memory and disk.
+===============================================================================*/
+struct OpenNodes{
+  NodeSelection selection;
+  bool diving;          // policy currently wants depth first
+  size_t memory_limit;  // pooled bytes that force depth first, 0 for none
+  int spill_nodes;      // heap size that triggers a spill, 0 for none
+  long size=0;          // nodes currently open, spilled ones included
+  Stack stack;
+  NodeHeap heap;
+  NodeStore* store;     // spilled heap nodes, NULL without a spill limit
+
+  OpenNodes(const SearchSettings& s): selection(s.selection), diving(s.selection==DEPTH_FIRST || s.selection==DEPTH_THEN_BEST),
+                                      memory_limit(s.memory_limit), spill_nodes(s.spill_nodes), heap(s.selection==BEST_ESTIMATE),
+                                      store(s.spill_nodes > 0 ? new NodeStore(s.spill_directory, s.selection==BEST_ESTIMATE) : NULL) {}
+  ~OpenNodes() { delete store; }
+
+  bool is_empty() { return stack.is_empty() && heap.is_empty() && (store==NULL || store->is_empty()); }
+  double max_weight() {
+    double max=std::fmax(stack.max_weight(), heap.max_weight());
+    return store==NULL ? max : std::fmax(max, store->max_weight());
+  }
+  bool bound_is_cheap() { return heap.is_empty() || selection!=BEST_ESTIMATE; }
+  bool over_budget() { return memory_limit!=0 && node_pool().bytes_in_use() > memory_limit; }
+
+  //spill the colder half of a heap grown past the limit
+  void spill() {
+    if (store!=NULL && heap.size() > spill_nodes) store->spill(heap, spill_nodes/2);
+  }
+
+  void push(Node* n) {
+    size++;
+    if (diving || over_budget()) stack.push(n);
+    else {
+      heap.insert(n);
+      spill();
+    }
+  }
+
+  Node* pop() {
+    Node* n;
+    size--;
+    if (!stack.is_empty()) { n=stack.top(); stack.pop(); return n; }
+    if (store!=NULL && !store->is_empty() && (heap.is_empty() || store->max_key() > heap.top_key())) store->restore(heap);
+    n=heap.top();
+    heap.pop();
+    return n;
+  }
+
+  //put back a node of a checkpoint, on the stack or in the heap as it was
+  void reopen(Node* n, bool stacked) {
+    size++;
+    if (stacked) stack.push(n);
+    else {
+      heap.insert(n);
+      spill();
+    }
+  }
+
+  //leave the dive for best-first once an incumbent exists
+  void incumbent_found() {
+    if (selection!=DEPTH_THEN_BEST || !diving) return;
+    diving=false;
+    while (!stack.is_empty()) { heap.insert(stack.top()); stack.pop(); }
+    spill();
+  }
+
+  //release every node still open, after an early stop, spilled nodes
+  //are dropped unread
+  void clear() {
+    if (store!=NULL) {
+      size-=store->size();
+      store->clear();
+    }
+    while (!is_empty()) release_node(pop());
+  }
+
+  //count the nodes spilled and read back into the search's counters
+  void report(SearchContext& ctx) {
+    if (store==NULL) return;
+    ctx.spilled.fetch_add(store->get_spilled(), std::memory_order_relaxed);
+    ctx.restored.fetch_add(store->get_restored(), std::memory_order_relaxed);
+  }
+};
+
+/*=============================================================================
+branch_and_bound - solve the pure integer program of the root LP, return the
+                  best integer solution found or NULL if there is none. The
+                  root's type picks the LP engine for every node: a dense
+                  Tableau, or a SparseLP for large sparse problems. A search
+                  stopped by a limit returns its incumbent, and its stats
+                  say which limit and how far the bound still is from it.
+                  An unbounded root LP returns NULL with the status
+                  SEARCH_UNBOUNDED.
+===============================================================================*/
+OptimalSolution* branch_and_bound(LinearProgram*, SearchSettings settings=SearchSettings());
+
+/*=============================================================================
+branch_and_bound - presolve the problem, solve the reduced root LP, built as
+                  a SparseLP if sparse or a Tableau otherwise, and map its
+                  best integer solution back onto the original columns.
+                  NULL if presolve or the search finds no integer solution.
+===============================================================================*/
+OptimalSolution* branch_and_bound(Presolver&, SearchSettings settings=SearchSettings(), bool sparse=false);
+
+/*=============================================================================
+parallel_branch_and_bound - branch_and_bound on settings.threads workers,
+                            called by branch_and_bound when threads > 1
+===============================================================================*/
+OptimalSolution* parallel_branch_and_bound(LinearProgram*, const SearchSettings&);
+
+class RoundPool;
+
+/*=============================================================================
+BatchSolver - fixed pool of threads for many small independent integer
+              programs. Each problem gets a serial search on one worker,
+              workers take the next unsolved problem as they finish, and
+              the threads are kept between batches so the per-thread pool
+              caches holding their nodes and LPs stay warm.
+===============================================================================*/
+class BatchSolver{
+  private:
+    int threads;
+    RoundPool* pool;
+
+  public:
+    BatchSolver(int threads=0);   // Constructor, 0 for one worker per hardware thread
+    ~BatchSolver();               // Destructor, joins the workers
+
+    //branch_and_bound of every problem, results in input order, NULL where a
+    //problem has no integer solution. settings.threads, stats and trace are ignored.
+    std::vector<OptimalSolution*> solve(const std::vector<LinearProgram*>&, SearchSettings settings=SearchSettings());
+};
+
+/*=============================================================================
+solve_batch - one batch on a BatchSolver of the given number of threads
+===============================================================================*/
+std::vector<OptimalSolution*> solve_batch(const std::vector<LinearProgram*>&, int threads=0, SearchSettings settings=SearchSettings());
+
+#endif
@@ -1,72 +1,39 @@
-#include "Tableau.hpp"
-#include "Stack.hpp"
-#include "PriorityQueue.hpp"
+#include "BranchAndBound.hpp"
+#include "ModelReader.hpp"
 
-/*=============================================================================
-branch_and_bound - performs DFS traversal of tree where at each visited node:
-                    1. Simplex is run to find new bound constraints
-                    2. child nodes are inserted into the tree and pushed with
-                        corresponding subproblems with additional constraints
-=============================================================================*/
-OptimalSolution* branch_and_bound(Tableau* root_tab){
 
-  Node root={'R', NULL, root_tab};
-  PriorityQueue best_sols;
-  Stack next_up;
-  next_up.push(&root);
-
-  int branch_var;
-  Node* curr;
-
-  while(!next_up.is_empty()){
-
-    //examine next problem
-    curr=next_up.top();
-    next_up.pop();
-
-    //solve simplex
-    curr->problem->simplex();
-
-    //determine if branching is needed and what the variable would be
-    branch_var=find_float(curr->problem->get_sol()->args,curr->problem->get_vars());
+  /*========================================
+  Driver with example Pure Integer Program,
+  or the MPS or LP file given as argument
+  ==========================================*/
+int main(int argc, char const *argv[]) {
 
-    //If a candidate solution has been found, enqueue into the PriorityQueue based on objective function value
-    if (branch_var==-1){
-      curr->weight=curr->problem->get_sol()->eval;
-      best_sols.insert(curr);
+  if (argc > 1) {
+    try {
+      Model model=read_model(argv[1]);
+      int vars=model.lp->get_vars();
+
+      SearchStats stats;
+      SearchSettings settings;
+      settings.stats=&stats;
+      OptimalSolution* opt=branch_and_bound(model.lp, settings);
+      if (opt==NULL && stats.status==SEARCH_UNBOUNDED) std::cout<<"Unbounded"<<std::endl;
+      else if (opt==NULL) std::cout<<"No integer solution"<<std::endl;
+      else {
+        opt->eval=model.objective(opt->eval);
+        print_solution(opt,vars);
+        delete[] opt->args;
+        delete opt;
+      }
+
+      delete model.lp;
     }
-
-    //If there are potentially still candidate solutions down this path
-    if (curr->problem->get_feasibility() && branch_var != -1){
-
-      // branch down...
-      Node* right_child = new Node;
-      right_child->problem = new Tableau(*curr->problem, branch_var,std::floor(curr->problem->get_sol()->args[branch_var]), false);
-
-      // and up on nearest integer bounds of floating point value
-      Node* left_child = new Node;
-      left_child->problem = new Tableau(*curr->problem, branch_var, std::ceil(curr->problem->get_sol()->args[branch_var]), true);
-
-      // And push them onto the stack
-      next_up.push(right_child);
-      next_up.push(left_child);
-
-
+    catch (const std::exception& error) {
+      std::cerr<<argv[1]<<": "<<error.what()<<std::endl;
+      return 1;
     }
+    return 0;
   }
-    //If there are no integer-feasible solutions to the problem, return NULL for UI-level handling
-    if (best_sols.is_empty()) return NULL;
-
-
-    return best_sols.front()->problem->get_sol();
-}
-
-
-
-  /*========================================
-  Driver with example Pure Integer Program
-  ==========================================*/
-int main(int argc, char const *argv[]) {
 
 
   //============Insert IP Here================
@@ -0,0 +1,215 @@
+#include "Branching.hpp"
+#include "Tableau.hpp"
+#include <vector>
+#include <algorithm>
+
+// fixed point units per unit of degradation in pseudocost sums
+const double PSEUDOCOST_SCALE=1024;
+
+// largest degradation per unit recorded, keeps the fixed point sums in range
+const double PSEUDOCOST_MAX=1e9;
+
+// floor of each side's degradation in the product score, so a side that
+// does not degrade still lets the other one decide
+const double SCORE_EPS=1e-6;
+
+// degradation of a strong branching child whose LP is infeasible, that
+// child is pruned as soon as it is created
+const double INFEASIBLE_DEGRADATION=1e30;
+
+/*=============================================================================
+Pseudocosts::Constructor - zeroed sums and counts for every variable and the
+                           totals, and the same again for staged records
+===============================================================================*/
+Pseudocosts::Pseudocosts(int vars, bool staged): vars(vars), staged(staged){
+
+  int size=2*(vars+1);
+  sum=new std::atomic<long long>[size];
+  count=new std::atomic<long>[size];
+  pending_sum = staged ? new std::atomic<long long>[size] : NULL;
+  pending_count = staged ? new std::atomic<long>[size] : NULL;
+
+  for (size_t k = 0; k < size; k++) {
+    sum[k]=0;
+    count[k]=0;
+    if (staged) {
+      pending_sum[k]=0;
+      pending_count[k]=0;
+    }
+  }
+}
+
+Pseudocosts::~Pseudocosts(){
+  delete[] sum;
+  delete[] count;
+  delete[] pending_sum;
+  delete[] pending_count;
+}
+
+/*=============================================================================
+Pseudocosts::record - add one observation to a variable's side and to the
+                      totals of that side
+===============================================================================*/
+void Pseudocosts::record(int var, bool up, double degradation){
+
+  if (!(degradation > 0)) degradation=0;
+  long long fixed=std::llround(std::fmin(degradation, PSEUDOCOST_MAX)*PSEUDOCOST_SCALE);
+
+  std::atomic<long long>* sums = staged ? pending_sum : sum;
+  std::atomic<long>* counts = staged ? pending_count : count;
+
+  sums[index(var, up)].fetch_add(fixed, std::memory_order_relaxed);
+  counts[index(var, up)].fetch_add(1, std::memory_order_relaxed);
+  sums[index(vars, up)].fetch_add(fixed, std::memory_order_relaxed);
+  counts[index(vars, up)].fetch_add(1, std::memory_order_relaxed);
+}
+
+/*=============================================================================
+Pseudocosts::commit - move staged records into the visible sums
+===============================================================================*/
+void Pseudocosts::commit(){
+
+  if (!staged) return;
+
+  for (size_t k = 0; k < 2*(vars+1); k++) {
+    sum[k].fetch_add(pending_sum[k].exchange(0), std::memory_order_relaxed);
+    count[k].fetch_add(pending_count[k].exchange(0), std::memory_order_relaxed);
+  }
+}
+
+/*=============================================================================
+Pseudocosts::get - mean degradation per unit of a variable's side, falling
+                   back on the mean of that side over every variable
+===============================================================================*/
+double Pseudocosts::get(int var, bool up) const{
+
+  long n=count[index(var, up)].load(std::memory_order_relaxed);
+  if (n > 0) return sum[index(var, up)].load(std::memory_order_relaxed)/(n*PSEUDOCOST_SCALE);
+
+  n=count[index(vars, up)].load(std::memory_order_relaxed);
+  if (n > 0) return sum[index(vars, up)].load(std::memory_order_relaxed)/(n*PSEUDOCOST_SCALE);
+
+  return 1;
+}
+
+long Pseudocosts::observations(int var, bool up) const{
+  return count[index(var, up)].load(std::memory_order_relaxed);
+}
+
+/*=============================================================================
+Pseudocosts::save, load - the committed sums and counts, for checkpoints
+===============================================================================*/
+void Pseudocosts::save(long long* sums, long* counts) const{
+  for (int k = 0; k < slots(); k++) {
+    sums[k]=sum[k].load(std::memory_order_relaxed);
+    counts[k]=count[k].load(std::memory_order_relaxed);
+  }
+}
+
+void Pseudocosts::load(const long long* sums, const long* counts){
+  for (int k = 0; k < slots(); k++) {
+    sum[k].store(sums[k], std::memory_order_relaxed);
+    count[k].store(counts[k], std::memory_order_relaxed);
+  }
+}
+
+/*=============================================================================
+score - product of the down and up degradations, each floored at SCORE_EPS,
+        which favours variables that degrade both children
+===============================================================================*/
+static double score(double down, double up){
+  return std::fmax(down, SCORE_EPS)*std::fmax(up, SCORE_EPS);
+}
+
+/*=============================================================================
+strong_score - solve both children of branching on var from the node's LP,
+               record their degradations as pseudocosts and score them
+===============================================================================*/
+static double strong_score(LinearProgram* lp, OptimalSolution* sol, int var, Pseudocosts& pseudocosts, long& lps, long& pivots){
+
+  double x=sol->args[var];
+  double f=x-std::floor(x);
+  double degradation[2];
+
+  for (int up = 0; up < 2; up++) {
+    BoundChange change;
+    change.var=var;
+    change.bound = up ? std::ceil(x) : std::floor(x);
+    change.geq=up;
+
+    LinearProgram* child=lp->rebuild(&change, 1, NULL);
+    OptimalSolution* child_sol=child->simplex();
+    lps++;
+    pivots+=child->get_pivots();
+
+    if (!child->get_feasibility()) degradation[up]=INFEASIBLE_DEGRADATION;
+    else {
+      degradation[up]=std::fmax(0, sol->eval-child_sol->eval);
+      pseudocosts.record(var, up, degradation[up]/(up ? 1-f : f));
+    }
+    delete child;
+  }
+
+  return score(degradation[0], degradation[1]);
+}
+
+/*=============================================================================
+select_branch - pick the branching variable of a fractional LP solution:
+                first and most fractional look at the fractional parts only,
+                pseudocost branching ranks every fractional variable by its
+                pseudocost score, strong branching solves both children of
+                the most fractional candidates, and reliability branching
+                goes down the pseudocost ranking, strong branching the first
+                candidates whose pseudocosts rest on too few observations.
+                -1 if the solution is integral.
+===============================================================================*/
+int select_branch(LinearProgram* lp, OptimalSolution* sol, BranchingRule rule, int candidates, int reliability,
+                  Pseudocosts& pseudocosts, long& lps, long& pivots){
+
+  int vars=lp->get_vars();
+  double integrality=lp->get_tolerances().integrality;
+  if (rule==FIRST_FRACTIONAL) return find_float(sol->args, vars, integrality);
+
+  //fractional variables by decreasing key, fractionality for the most fractional
+  //and strong rules, pseudocost score for the others
+  std::vector<std::pair<double, int> > ranked;
+  for (size_t j = 0; j < vars; j++) {
+    double x=sol->args[j];
+    if (std::fabs(x-std::round(x)) <= integrality) continue;
+
+    double f=x-std::floor(x);
+    double key = (rule==MOST_FRACTIONAL || rule==STRONG) ? std::fmin(f, 1-f)
+               : score(f*pseudocosts.get(j, false), (1-f)*pseudocosts.get(j, true));
+    ranked.push_back(std::make_pair(-key, (int)j));
+  }
+  if (ranked.empty()) return -1;
+  std::stable_sort(ranked.begin(), ranked.end());
+
+  if (rule==MOST_FRACTIONAL || rule==PSEUDOCOST) return ranked[0].second;
+
+  int best=ranked[0].second;
+  double best_score=-1;
+  int strong=0;
+
+  for (size_t k = 0; k < ranked.size(); k++) {
+    int j=ranked[k].second;
+    bool reliable = rule==RELIABILITY && pseudocosts.observations(j, false) >= reliability &&
+                    pseudocosts.observations(j, true) >= reliability;
+
+    double s;
+    if (reliable) s=-ranked[k].first;
+    else if (strong < candidates) {
+      strong++;
+      s=strong_score(lp, sol, j, pseudocosts, lps, pivots);
+    }
+    else if (rule==RELIABILITY) s=-ranked[k].first;
+    else break;
+
+    if (s > best_score) {
+      best_score=s;
+      best=j;
+    }
+  }
+
+  return best;
+}
@@ -0,0 +1,65 @@
+#include <atomic>
+#include "LinearProgram.hpp"
+
+#ifndef BRANCHING_HPP
+#define BRANCHING_HPP
+
+/*=============================================================================
+BranchingRule - how the fractional variable a node branches on is chosen
+===============================================================================*/
+enum BranchingRule{
+  FIRST_FRACTIONAL,   // lowest index fractional variable
+  MOST_FRACTIONAL,    // fractional part closest to one half
+  PSEUDOCOST,         // best product of the down and up degradations its pseudocosts predict
+  STRONG,             // best product of the degradations found by solving both children
+                      // of the most fractional candidates
+  RELIABILITY         // pseudocosts, strong branching candidates with too few observations
+};
+
+/*=============================================================================
+Pseudocosts - per variable mean degradation of the LP value per unit the down
+              and up branch moved the variable, from every solved child and
+              strong branching LP. Variables without observations of a side
+              use the mean over all variables, or 1 before any.
+
+              Sums are kept in fixed point so concurrent records add up to the
+              same totals in any order. Staged pseudocosts hold new records
+              back until commit(), so the deterministic parallel search sees
+              the same values however its workers interleave.
+===============================================================================*/
+class Pseudocosts{
+  private:
+    int vars;
+    bool staged;
+    std::atomic<long long>* sum;    // fixed point degradation sums, down then up, the totals last
+    std::atomic<long>* count;       // observations behind each sum
+    std::atomic<long long>* pending_sum; // records not yet committed, NULL unless staged
+    std::atomic<long>* pending_count;
+
+    int index(int var, bool up) const { return (up ? vars+1 : 0)+var; }
+
+  public:
+    Pseudocosts(int vars, bool staged=false); // Constructor, no observations
+    ~Pseudocosts();
+
+    void record(int var, bool up, double degradation); // one observation, degradation per unit of branch distance
+    void commit();                          // make staged records visible, call while no worker selects
+    double get(int var, bool up) const;     // mean degradation per unit
+    long observations(int var, bool up) const;
+    int slots() const { return 2*(vars+1); }  // length of the arrays save and load take
+    void save(long long* sums, long* counts) const; // copy the committed sums and counts
+    void load(const long long* sums, const long* counts); // replace them, nothing may be staged
+};
+
+/*=============================================================================
+select_branch - variable a node with a fractional LP solution branches on,
+                under the given rule. Strong and reliability branching solve
+                both children of at most candidates variables from the
+                node's LP, counting those LPs and their pivots in lps and
+                pivots, and variables count as reliable once both of their
+                sides have the given number of observations.
+===============================================================================*/
+int select_branch(LinearProgram*, OptimalSolution*, BranchingRule, int candidates, int reliability,
+                  Pseudocosts&, long& lps, long& pivots);
+
+#endif
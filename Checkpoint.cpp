@@ -0,0 +1,287 @@
+#include "Checkpoint.hpp"
+#include "Heuristics.hpp"
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+// first bytes of a checkpoint, the digit counts layout versions
+const char CHECKPOINT_MAGIC[8]="BBCKPT3";
+
+// search counters kept in a checkpoint
+const int CHECKPOINT_COUNTERS=16;
+
+/*=============================================================================
+CheckpointHeader - fixed start of a checkpoint, followed by the incumbent's
+                   values if there is one, the pseudocost sums and counts,
+                   then the records of the stacked nodes, top first, and
+                   of the other open nodes
+===============================================================================*/
+struct CheckpointHeader{
+  char magic[8];
+  int vars;             // decision variables of the root
+  int basis_words;      // length of the root's compressed basis once it has its cuts
+  unsigned long model;  // hash of the root's objective
+  long next_id;         // id of the next node created
+  long stack_nodes;     // records of nodes on the stack
+  long heap_nodes;      // records of nodes in the heap or spilled
+  bool diving;          // the open nodes were on their depth first phase
+  bool has_incumbent;
+  double incumbent;
+  double unsolved_bound; // largest parent bound of the nodes dropped unsolved
+  long counters[CHECKPOINT_COUNTERS];
+};
+
+/*=============================================================================
+counters - the context's counters in checkpoint order, spilled and restored
+           without the open nodes' store, which reports them at the end
+===============================================================================*/
+static void counters(SearchContext& ctx, std::atomic<long>** c){
+  std::atomic<long>* all[CHECKPOINT_COUNTERS]={&ctx.nodes, &ctx.lps, &ctx.pivots, &ctx.branched, &ctx.pruned,
+                                               &ctx.infeasible, &ctx.integral, &ctx.unsolved, &ctx.root_cuts, &ctx.node_cuts,
+                                               &ctx.strong_lps, &ctx.heuristic_lps, &ctx.heuristic_solutions,
+                                               &ctx.max_open, &ctx.spilled, &ctx.restored};
+  for (int k = 0; k < CHECKPOINT_COUNTERS; k++) c[k]=all[k];
+}
+
+/*=============================================================================
+model_hash - FNV-1a hash of the root's variable count and objective
+===============================================================================*/
+unsigned long model_hash(LinearProgram* root){
+
+  unsigned long hash=14695981039346656037ul;
+  int vars=root->get_vars();
+  const unsigned char* bytes=(const unsigned char*)root->get_cost();
+
+  for (size_t i = 0; i < vars*sizeof(float); i++) hash=(hash^bytes[i])*1099511628211ul;
+  return (hash^vars)*1099511628211ul;
+}
+
+static void append(std::vector<char>& out, const void* p, size_t bytes){
+  out.insert(out.end(), (const char*)p, (const char*)p+bytes);
+}
+
+/*=============================================================================
+CheckpointWriter Constructor - off unless the settings name a file
+===============================================================================*/
+CheckpointWriter::CheckpointWriter(const SearchSettings& settings):
+  path(settings.checkpoint!=NULL ? settings.checkpoint : ""), interval(settings.checkpoint_interval),
+  last(std::chrono::steady_clock::now()) {}
+
+CheckpointWriter::~CheckpointWriter(){
+  if (writing.joinable()) writing.join();
+}
+
+bool CheckpointWriter::due(){
+  if (path.empty() || busy.load(std::memory_order_acquire)) return false;
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-last).count() >= interval;
+}
+
+/*=============================================================================
+CheckpointWriter::write - write, sync and rename a snapshot in the
+                          background. A snapshot that cannot be written is
+                          dropped and the previous checkpoint stays.
+===============================================================================*/
+void CheckpointWriter::write(std::vector<char>* bytes){
+
+  if (writing.joinable()) writing.join();
+  last=std::chrono::steady_clock::now();
+  busy.store(true, std::memory_order_release);
+
+  writing=std::thread([this, bytes](){
+    std::string temp=path+".tmp";
+    int fd=open(temp.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    bool written = fd >= 0;
+
+    size_t done=0;
+    while (written && done < bytes->size()) {
+      ssize_t w=::write(fd, bytes->data()+done, bytes->size()-done);
+      if (w <= 0) written=false;
+      else done+=w;
+    }
+    if (fd >= 0) {
+      written = written && fsync(fd)==0;
+      close(fd);
+    }
+    if (!written || rename(temp.c_str(), path.c_str())!=0) unlink(temp.c_str());
+
+    delete bytes;
+    busy.store(false, std::memory_order_release);
+  });
+}
+
+/*=============================================================================
+CheckpointWriter::finish - wait for the writes, a search stopped early keeps
+                           its last snapshot to resume from
+===============================================================================*/
+void CheckpointWriter::finish(std::vector<char>* last){
+  if (last!=NULL) write(last);
+  if (writing.joinable()) writing.join();
+  if (last==NULL && !path.empty()) unlink(path.c_str());
+}
+
+/*=============================================================================
+snapshot_search - header, incumbent, pseudocosts, then the stack top first,
+                  the heap in array order and the spilled records
+===============================================================================*/
+std::vector<char>* snapshot_search(OpenNodes& next_up, SearchContext& ctx, Node* best, long next_id){
+
+  int vars=ctx.root->get_vars();
+
+  CheckpointHeader header={};
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.vars=vars;
+  header.basis_words=ctx.root->basis_words();
+  header.model=model_hash(ctx.root);
+  header.next_id=next_id;
+  header.diving=next_up.diving;
+  header.has_incumbent = best!=NULL;
+  header.incumbent = best!=NULL ? best->weight : -FLT_MAX;
+  header.unsolved_bound=ctx.unsolved_bound.load();
+
+  std::atomic<long>* c[CHECKPOINT_COUNTERS];
+  counters(ctx, c);
+  for (int k = 0; k < CHECKPOINT_COUNTERS; k++) header.counters[k]=c[k]->load();
+  if (next_up.store!=NULL) {
+    header.counters[CHECKPOINT_COUNTERS-2]+=next_up.store->get_spilled();
+    header.counters[CHECKPOINT_COUNTERS-1]+=next_up.store->get_restored();
+  }
+
+  //the bottom sentinel, whose next is NULL, ends the stack
+  std::vector<Node*> stacked;
+  for (Node* n = next_up.stack.top(); n->next!=NULL; n=n->next) stacked.push_back(n);
+  header.stack_nodes=stacked.size();
+  header.heap_nodes=next_up.heap.size()+(next_up.store!=NULL ? next_up.store->size() : 0);
+
+  std::vector<char>* out=new std::vector<char>;
+  append(*out, &header, sizeof(header));
+  if (best!=NULL) append(*out, best->problem->get_sol()->args, vars*sizeof(double));
+
+  int slots=ctx.pseudocosts.slots();
+  std::vector<long long> sums(slots);
+  std::vector<long> counts(slots);
+  ctx.pseudocosts.save(sums.data(), counts.data());
+  append(*out, sums.data(), slots*sizeof(long long));
+  append(*out, counts.data(), slots*sizeof(long));
+
+  for (size_t i = 0; i < stacked.size(); i++) {
+    size_t at=out->size();
+    out->resize(at+record_bytes(stacked[i]));
+    write_record(&(*out)[at], stacked[i]);
+  }
+  for (int i = 0; i < next_up.heap.size(); i++) {
+    size_t at=out->size();
+    out->resize(at+record_bytes(next_up.heap.at(i)));
+    write_record(&(*out)[at], next_up.heap.at(i));
+  }
+  if (next_up.store!=NULL) next_up.store->copy_records(*out);
+
+  return out;
+}
+
+/*=============================================================================
+read_file - whole contents of a file, false if it does not exist
+===============================================================================*/
+static bool read_file(const std::string& path, std::vector<char>& bytes){
+
+  int fd=open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno==ENOENT) return false;
+    throw std::runtime_error("cannot open checkpoint "+path);
+  }
+
+  char buffer[1<<16];
+  ssize_t got;
+  while ((got=read(fd, buffer, sizeof(buffer))) > 0) bytes.insert(bytes.end(), buffer, buffer+got);
+  close(fd);
+
+  if (got < 0) throw std::runtime_error("cannot read checkpoint "+path);
+  return true;
+}
+
+/*=============================================================================
+solve_root - bring the root LP back to the state its expansion left it in,
+             solved with its cut rounds
+===============================================================================*/
+void solve_root(SearchContext& ctx){
+
+  ctx.root->simplex();
+  if (ctx.cuts!=NULL && ctx.root->get_feasibility()) {
+    ctx.cuts->root_rounds(*static_cast<Tableau*>(ctx.root), ctx.settings.cut_rounds);
+    ctx.root->simplex();
+  }
+}
+
+/*=============================================================================
+resume_search - check the file against the root, restore the search state and
+                put every open node back where it was
+===============================================================================*/
+bool resume_search(OpenNodes& next_up, SearchContext& ctx, Node** best){
+
+  std::string path = ctx.settings.checkpoint!=NULL ? ctx.settings.checkpoint : "";
+  std::vector<char> bytes;
+  if (path.empty() || !ctx.settings.resume || !read_file(path, bytes)) return false;
+
+  int vars=ctx.root->get_vars();
+  int slots=ctx.pseudocosts.slots();
+
+  CheckpointHeader header;
+  if (bytes.size() < sizeof(header)) throw std::runtime_error("checkpoint "+path+" is truncated");
+  memcpy(&header, bytes.data(), sizeof(header));
+  if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic))!=0) throw std::runtime_error(path+" is not a checkpoint");
+  if (header.vars!=vars || header.model!=model_hash(ctx.root)) throw std::runtime_error("checkpoint "+path+" is of another problem");
+
+  size_t fixed=sizeof(header)+(header.has_incumbent ? vars*sizeof(double) : 0)+slots*(sizeof(long long)+sizeof(long));
+  if (bytes.size() < fixed) throw std::runtime_error("checkpoint "+path+" is truncated");
+
+  //every record must fit before any node is made
+  const char* end=bytes.data()+bytes.size();
+  const char* q=bytes.data()+fixed;
+  for (long i = 0; i < header.stack_nodes+header.heap_nodes; i++) {
+    size_t length=record_length(q, end);
+    if (length==0) throw std::runtime_error("checkpoint "+path+" is truncated");
+    q+=length;
+  }
+
+  solve_root(ctx);
+  bool keep_basis = ctx.settings.warm_start && header.basis_words==ctx.root->basis_words();
+
+  //counters go back after the root's solve, which the checkpoint already counted
+  std::atomic<long>* c[CHECKPOINT_COUNTERS];
+  counters(ctx, c);
+  for (int k = 0; k < CHECKPOINT_COUNTERS; k++) c[k]->store(header.counters[k]);
+  ctx.unsolved_bound.store(header.unsolved_bound);
+
+  const char* p=bytes.data()+sizeof(header);
+  *best=NULL;
+  if (header.has_incumbent) {
+    std::vector<double> values(vars);
+    memcpy(values.data(), p, vars*sizeof(double));
+    p+=vars*sizeof(double);
+    long pivots=0;
+    *best=fixed_node(values.data(), ctx, pivots);
+    if (*best!=NULL) ctx.set_guide((*best)->problem->get_sol());
+  }
+
+  std::vector<long long> sums(slots);
+  std::vector<long> counts(slots);
+  memcpy(sums.data(), p, slots*sizeof(long long));
+  p+=slots*sizeof(long long);
+  memcpy(counts.data(), p, slots*sizeof(long));
+  p+=slots*sizeof(long);
+  ctx.pseudocosts.load(sums.data(), counts.data());
+
+  std::vector<Node*> stacked;
+  next_up.diving=header.diving;
+  for (long i = 0; i < header.stack_nodes+header.heap_nodes; i++) {
+    Node* n;
+    p=read_record(p, &n, keep_basis);
+    if (i < header.stack_nodes) stacked.push_back(n);
+    else next_up.reopen(n, false);
+  }
+  for (size_t i = stacked.size(); i-- > 0;) next_up.reopen(stacked[i], true);
+
+  ctx.next_id.store(header.next_id);
+  return true;
+}
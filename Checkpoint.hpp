@@ -0,0 +1,72 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BranchAndBound.hpp"
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+/*=============================================================================
+model_hash - hash of a root's variable count and objective, identifying the
+             problem a checkpoint or a remote worker belongs to
+===============================================================================*/
+unsigned long model_hash(LinearProgram*);
+
+/*=============================================================================
+solve_root - solve the context's root LP in place and give it the settings'
+             cut rounds, as expanding the root node does, so nodes of an
+             earlier search or another process rebuild from the same root
+===============================================================================*/
+void solve_root(SearchContext&);
+
+/*=============================================================================
+CheckpointWriter - writes snapshots of a search to the settings' checkpoint
+                   file on a thread of its own, so the search only stops to
+                   copy its state into a buffer. Each snapshot goes to a
+                   temporary file beside the checkpoint and is renamed over
+                   it once it is on disk, so an interrupted write leaves the
+                   previous checkpoint whole. A snapshot is not due while
+                   the previous one is still being written.
+===============================================================================*/
+class CheckpointWriter{
+  private:
+    std::string path;     // checkpoint file, empty when checkpoints are off
+    double interval;      // seconds between snapshots
+    std::chrono::steady_clock::time_point last; // time of the last snapshot, or of construction
+    std::thread writing;  // thread writing the last snapshot
+    std::atomic<bool> busy{false};  // a snapshot is being written
+
+  public:
+    CheckpointWriter(const SearchSettings&);  // Constructor, the first snapshot is due an interval from now
+    ~CheckpointWriter();  // Destructor, waits for the last write
+    bool enabled() { return !path.empty(); }
+    bool due();           // time for a snapshot
+    void write(std::vector<char>*);  // write a snapshot in the background, taking ownership of it
+    void finish(std::vector<char>* last=NULL);  // the search has ended: write its last snapshot and keep it, or without one remove the checkpoint
+};
+
+/*=============================================================================
+snapshot_search - compact binary image of a search between two expansions:
+                  the root's identity, the counters, pseudocosts and next
+                  node id, the incumbent's values, and every open node as
+                  its self-contained record, spilled ones included. The
+                  root must have been expanded.
+===============================================================================*/
+std::vector<char>* snapshot_search(OpenNodes&, SearchContext&, Node* best, long next_id);
+
+/*=============================================================================
+resume_search - continue a search from its checkpoint file, false if there is
+                none: the root LP is solved again and takes the same cut
+                rounds, then the counters, pseudocosts and open nodes are
+                restored, the context's next_id included, and the
+                incumbent's LP is solved again into best.
+                Open nodes warm-start from their saved bases when the cut
+                root has the same shape, otherwise from the root's. Throws
+                std::runtime_error for a file of another problem or a
+                damaged one.
+===============================================================================*/
+bool resume_search(OpenNodes&, SearchContext&, Node** best);
+
+#endif
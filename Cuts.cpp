@@ -0,0 +1,393 @@
+#include "Cuts.hpp"
+#include <cfloat>
+#include <algorithm>
+
+// rounds a cut may stay slack in the root LP before it is dropped from it
+const int CUT_MAX_AGE=3;
+
+// fractional rows cut from per round, most fractional first
+const int CUT_MAX_PER_ROUND=20;
+
+// cuts kept in the pool, the oldest inactive ones are forgotten beyond it
+const int CUT_POOL_SIZE=1000;
+
+// a basic value this close to an integer gives no cut
+const double CUT_MIN_FRACTION=0.01;
+
+// rows with an entry this large are too badly scaled to cut from
+const double CUT_MAX_ENTRY=1e6;
+
+// largest over smallest coefficient beyond which a cut is numerically unsafe
+const double CUT_MAX_DYNAMISM=1e4;
+
+// each right hand side is relaxed by this much relative to the size of the
+// cut's terms, covering the float round-off of the tableau it came from
+const double CUT_RELAX=1e-5;
+
+// violation, relative to the size of a cut, for it to count as violated
+const double CUT_MIN_VIOLATION=1e-4;
+
+// cosine above which a new cut is too close to parallel to one already in
+// the LP or found this round, nearly parallel rows make the basis
+// ill-conditioned
+const double CUT_MAX_PARALLEL=0.99;
+
+// relative bound improvement below which a round counts as stalled, two
+// stalled rounds in a row end the root rounds
+const double CUT_MIN_GAIN=1e-4;
+
+/*=============================================================================
+column_values - value of every column of a solved tableau, its origin plus,
+                for basic columns, the row value in its direction
+===============================================================================*/
+static void column_values(Tableau& tab, double* y){
+
+  int cols=tab.get_columns()-1;
+  for (size_t j = 0; j < cols; j++) y[j] = tab.get_flipped()[j] ? tab.get_upper()[j] : tab.get_lower()[j];
+
+  for (size_t i = 0; i < tab.get_rows()-1; i++) {
+    int j=tab.get_basis()[i];
+    y[j]+=(tab.get_flipped()[j] ? -1 : 1)*(double)tab[i][cols];
+  }
+}
+
+/*=============================================================================
+violation - amount by which column values fall short of a cut, relative to
+            the size of its terms
+===============================================================================*/
+static double violation(const Cut* cut, const double* y){
+
+  double activity=0, scale=std::fabs(cut->rhs);
+  for (size_t j = 0; j < cut->coef.size(); j++) {
+    activity+=cut->coef[j]*y[j];
+    scale+=std::fabs(cut->coef[j]*y[j]);
+  }
+  return (cut->rhs-activity)/(1+scale);
+}
+
+/*=============================================================================
+parallel - return if two cuts are nearly parallel
+===============================================================================*/
+static bool parallel(const Cut* a, const Cut* b){
+
+  double dot=0, norm_a=0, norm_b=0;
+  for (size_t j = 0; j < a->coef.size(); j++) {
+    dot+=a->coef[j]*b->coef[j];
+    norm_a+=a->coef[j]*a->coef[j];
+    norm_b+=b->coef[j]*b->coef[j];
+  }
+  return dot > CUT_MAX_PARALLEL*std::sqrt(norm_a*norm_b);
+}
+
+/*=============================================================================
+gomory_cut - Gomory mixed-integer cut of a tableau row whose basic column is
+            an integer variable at a fractional distance f0 from an integral
+            origin. The row reads z_b + sum a_j z_j = b over the nonbasic
+            distances z_j >= 0, which are integral for the decision
+            variables measured from integral bounds and continuous for
+            slacks. With f_j the fractional part of a_j, the cut is
+
+              sum_{integer, f_j <= f0} f_j/f0 z_j
+            + sum_{integer, f_j > f0} (1-f_j)/(1-f0) z_j
+            + sum_{continuous, a_j > 0} a_j/f0 z_j
+            + sum_{continuous, a_j < 0} -a_j/(1-f0) z_j  >=  1
+
+            It is then written over column values, slacks of earlier cuts,
+            given by cut_columns from column base on, are substituted by
+            their own cuts, and the right hand side is relaxed for
+            round-off. NULL if the row is unsuitable or the cut unsafe.
+===============================================================================*/
+static Cut* gomory_cut(Tableau& tab, int row, const bool* is_basic, const double* y,
+                       const std::vector<const Cut*>& cut_columns, int base){
+
+  int cols=tab.get_columns()-1;
+  int vars=tab.get_vars();
+  const Tableau::Scalar* r=tab[row];
+  const Tableau::Scalar* lower=tab.get_lower();
+  const Tableau::Scalar* upper=tab.get_upper();
+  const bool* flipped=tab.get_flipped();
+
+  double f0=r[cols]-std::floor(r[cols]);
+
+  std::vector<double> coef(base, 0);
+  double rhs=1;
+
+  for (size_t j = 0; j < cols; j++) {
+    double a=r[j];
+    if (is_basic[j] || a==0) continue;
+    if (std::fabs(a) > CUT_MAX_ENTRY) return NULL;
+
+    double origin = flipped[j] ? upper[j] : lower[j];
+    bool integer = j<vars && origin==std::floor(origin);
+
+    double pi;
+    if (integer) {
+      double fj=a-std::floor(a);
+      pi = fj <= f0 ? fj/f0 : (1-fj)/(1-f0);
+    }
+    else pi = a > 0 ? a/f0 : -a/(1-f0);
+    if (pi==0) continue;
+
+    //z_j = dir*(y_j - origin)
+    double dir = flipped[j] ? -1 : 1;
+    rhs+=pi*dir*origin;
+
+    if (j<base) coef[j]+=pi*dir;
+    else {
+      //slack of an earlier cut: t = c.y - rhs_c
+      const Cut* c=cut_columns[j-base];
+      for (size_t k = 0; k < base; k++) coef[k]+=pi*dir*c->coef[k];
+      rhs+=pi*dir*c->rhs;
+    }
+  }
+
+  double largest=0, smallest=DBL_MAX, scale=std::fabs(rhs);
+  for (size_t j = 0; j < base; j++) {
+    if (coef[j]==0) continue;
+    largest=std::fmax(largest, std::fabs(coef[j]));
+    smallest=std::fmin(smallest, std::fabs(coef[j]));
+    scale+=std::fabs(coef[j]*y[j]);
+  }
+  if (largest==0 || largest > CUT_MAX_DYNAMISM*smallest) return NULL;
+
+  //largest coefficient 1, so cut rows are scaled like the others
+  Cut* cut=new Cut;
+  cut->coef.resize(base);
+  for (size_t j = 0; j < base; j++) cut->coef[j]=coef[j]/largest;
+  cut->rhs=(rhs-CUT_RELAX*(1+scale))/largest;
+
+  //float storage and the relaxation must still leave the current point cut off
+  if (violation(cut, y) < CUT_MIN_VIOLATION) {
+    delete cut;
+    return NULL;
+  }
+  return cut;
+}
+
+/*=============================================================================
+separate - Gomory cuts of up to CUT_MAX_PER_ROUND rows of a solved tableau
+          whose basic decision variable is furthest from integral, leaving
+          out cuts nearly parallel to one in the LP or found before them
+===============================================================================*/
+static void separate(Tableau& tab, const double* y, const std::vector<const Cut*>& cut_columns, int base, std::vector<Cut*>& found){
+
+  int cols=tab.get_columns()-1;
+  int rows=tab.get_rows()-1;
+  const int* basis=tab.get_basis();
+
+  bool* is_basic=(bool*)node_pool().acquire(cols);
+  for (size_t j = 0; j < cols; j++) is_basic[j]=false;
+  for (size_t i = 0; i < rows; i++) is_basic[basis[i]]=true;
+
+  //rows by distance of their fraction from one half
+  std::vector<std::pair<double, int> > candidates;
+  for (size_t i = 0; i < rows; i++) {
+    int j=basis[i];
+    if (j >= tab.get_vars()) continue;
+    double origin = tab.get_flipped()[j] ? tab.get_upper()[j] : tab.get_lower()[j];
+    if (origin!=std::floor(origin)) continue;
+
+    double f0=tab[i][cols]-std::floor(tab[i][cols]);
+    if (f0 < CUT_MIN_FRACTION || f0 > 1-CUT_MIN_FRACTION) continue;
+    candidates.push_back(std::make_pair(std::fabs(f0-0.5), (int)i));
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  size_t first=found.size();
+  for (size_t k = 0; k < candidates.size() && found.size()-first < CUT_MAX_PER_ROUND; k++) {
+    Cut* cut=gomory_cut(tab, candidates[k].second, is_basic, y, cut_columns, base);
+    if (cut==NULL) continue;
+
+    bool keep=true;
+    for (size_t c = 0; c < cut_columns.size() && keep; c++) keep=!parallel(cut, cut_columns[c]);
+    for (size_t c = first; c < found.size() && keep; c++) keep=!parallel(cut, found[c]);
+
+    if (keep) found.push_back(cut);
+    else delete cut;
+  }
+
+  node_pool().release(is_basic, cols);
+}
+
+/*=============================================================================
+CutPool::Constructor - cuts are written over the root's columns as they are
+                       before any cut
+===============================================================================*/
+CutPool::CutPool(Tableau& root): base(root.get_columns()-1){}
+
+CutPool::~CutPool(){
+  for (size_t k = 0; k < cuts.size(); k++) delete cuts[k];
+}
+
+/*=============================================================================
+CutPool::age - count another round for every cut whose slack is positive,
+               restart the count of tight ones, and take cuts slack for
+               CUT_MAX_AGE rounds out of the root LP. Later cuts' slack
+               columns move down as earlier ones go.
+===============================================================================*/
+void CutPool::age(Tableau& tab){
+
+  int cols=tab.get_columns()-1;
+  double* y=(double*)node_pool().acquire(cols*sizeof(double));
+  column_values(tab, y);
+
+  for (int k = (int)active.size()-1; k >= 0; k--) {
+    Cut* cut=active[k];
+    double slack=y[base+k];
+
+    if (slack > CUT_MIN_VIOLATION*(1+std::fabs(cut->rhs))) cut->age++;
+    else cut->age=0;
+
+    if (cut->age >= CUT_MAX_AGE && tab.remove_cut(base+k)) {
+      cut->active=false;
+      active.erase(active.begin()+k);
+    }
+  }
+
+  node_pool().release(y, cols*sizeof(double));
+}
+
+/*=============================================================================
+CutPool::trim - forget the oldest cuts outside the root LP while the pool
+                holds more than CUT_POOL_SIZE
+===============================================================================*/
+void CutPool::trim(){
+
+  size_t excess = cuts.size() > CUT_POOL_SIZE ? cuts.size()-CUT_POOL_SIZE : 0;
+
+  std::vector<Cut*> kept;
+  for (size_t k = 0; k < cuts.size(); k++) {
+    if (excess > 0 && !cuts[k]->active) {
+      delete cuts[k];
+      excess--;
+    }
+    else kept.push_back(cuts[k]);
+  }
+  cuts.swap(kept);
+}
+
+/*=============================================================================
+CutPool::root_rounds - up to the given number of rounds on the root LP:
+                       1. the LP is solved, rounds end once it is integral
+                          or infeasible
+                       2. new Gomory cuts and pooled cuts it violates are
+                          added as rows
+                       3. the dual simplex re-optimizes and slack cuts age
+                       Rounds also end when no cut is found or the bound
+                       stalls. Return the number of cuts added.
+===============================================================================*/
+int CutPool::root_rounds(Tableau& tab, int rounds){
+
+  int added=0, stalled=0;
+  int vars=tab.get_vars();
+
+  for (int round = 0; round < rounds; round++) {
+
+    OptimalSolution* sol=tab.simplex();
+    if (!tab.get_feasibility() || find_float(sol->args, vars, tab.get_tolerances().integrality)==-1) break;
+    double before=sol->eval;
+
+    int cols=tab.get_columns()-1;
+    double* y=(double*)node_pool().acquire(cols*sizeof(double));
+    column_values(tab, y);
+
+    std::vector<const Cut*> cut_columns(active.begin(), active.end());
+    std::vector<Cut*> found;
+    separate(tab, y, cut_columns, base, found);
+
+    //pooled cuts violated again, then this round's new ones
+    std::vector<Cut*> entering;
+    for (size_t k = 0; k < cuts.size(); k++) {
+      if (!cuts[k]->active && violation(cuts[k], y) > CUT_MIN_VIOLATION) entering.push_back(cuts[k]);
+    }
+    for (size_t k = 0; k < found.size(); k++) {
+      cuts.push_back(found[k]);
+      entering.push_back(found[k]);
+    }
+    node_pool().release(y, cols*sizeof(double));
+
+    if (entering.empty()) break;
+
+    for (size_t k = 0; k < entering.size(); k++) {
+      Cut* cut=entering[k];
+      tab.add_cut(cut->coef.data(), base, cut->rhs);
+      cut->active=true;
+      cut->age=0;
+      active.push_back(cut);
+    }
+    added+=entering.size();
+
+    sol=tab.simplex();
+    if (!tab.get_feasibility()) break;
+
+    age(tab);
+    trim();
+
+    if (before-sol->eval <= CUT_MIN_GAIN*(1+std::fabs(sol->eval))) {
+      if (++stalled >= 2) break;
+    }
+    else stalled=0;
+  }
+
+  return added;
+}
+
+/*=============================================================================
+CutPool::node_bound - bound of a solved node LP tightened by up to the given
+                      number of cut rounds on a copy of it, each adding the
+                      pooled cuts outside the root LP that its solution
+                      violates and Gomory cuts of its own rows. Those are
+                      only valid below the node and are discarded with the
+                      copy. Return false if the cuts leave no feasible point,
+                      so the node holds no integer solution.
+===============================================================================*/
+bool CutPool::node_bound(Tableau& node, int rounds, double& bound, long& added) const{
+
+  Tableau* probe=static_cast<Tableau*>(node.rebuild(NULL, 0, NULL));
+  OptimalSolution* sol=probe->simplex();
+  int vars=probe->get_vars();
+  bool feasible=true;
+
+  std::vector<const Cut*> cut_columns(active.begin(), active.end());
+  std::vector<bool> used(cuts.size(), false);
+  std::vector<Cut*> local;
+
+  for (int round = 0; round < rounds && find_float(sol->args, vars, probe->get_tolerances().integrality)!=-1; round++) {
+
+    int cols=probe->get_columns()-1;
+    double* y=(double*)node_pool().acquire(cols*sizeof(double));
+    column_values(*probe, y);
+
+    std::vector<Cut*> entering;
+    for (size_t k = 0; k < cuts.size(); k++) {
+      if (cuts[k]->active || used[k] || violation(cuts[k], y) <= CUT_MIN_VIOLATION) continue;
+      used[k]=true;
+      entering.push_back(cuts[k]);
+    }
+
+    size_t first_local=local.size();
+    separate(*probe, y, cut_columns, base, local);
+    for (size_t k = first_local; k < local.size(); k++) entering.push_back(local[k]);
+    node_pool().release(y, cols*sizeof(double));
+
+    if (entering.empty()) break;
+
+    for (size_t k = 0; k < entering.size(); k++) {
+      probe->add_cut(entering[k]->coef.data(), base, entering[k]->rhs);
+      cut_columns.push_back(entering[k]);
+    }
+    added+=entering.size();
+
+    sol=probe->simplex();
+    if (!probe->get_feasibility()) {
+      feasible=false;
+      break;
+    }
+  }
+
+  if (feasible) bound=sol->eval;
+
+  for (size_t k = 0; k < local.size(); k++) delete local[k];
+  delete probe;
+  return feasible;
+}
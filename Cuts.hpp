@@ -0,0 +1,54 @@
+#include <vector>
+#include "Tableau.hpp"
+
+#ifndef CUTS_HPP
+#define CUTS_HPP
+
+/*=============================================================================
+Cut - valid inequality coef.y >= rhs over the values y of the LP's columns
+      before any cut was added: the decision variables, then the slacks of
+      the original rows. Slacks of other cuts are substituted out when a
+      cut is derived, so a cut stays meaningful after those are dropped.
+===============================================================================*/
+struct Cut{
+  std::vector<float> coef;  // coefficient of each original column
+  float rhs;                // right hand side of coef.y >= rhs
+  int age=0;                // consecutive rounds the cut has been slack in the root LP
+  bool active=false;        // currently a row of the root LP
+};
+
+/*=============================================================================
+CutPool - Gomory mixed-integer cuts of one search. Cuts are derived at the
+          root in rounds, each round adding the cuts of the optimal
+          tableau's fractional rows and re-optimizing with the dual simplex.
+          Cuts slack for CUT_MAX_AGE rounds in a row leave the root LP but
+          stay pooled, and go back in when a later round's solution violates
+          them. The root LP every node is rebuilt from keeps the cuts still
+          active when the rounds end.
+
+          Shallow nodes may tighten their own bound with the pooled cuts
+          they violate and with local cuts from their tableau, valid only
+          below them, on a copy of their LP. The pool is read-only once
+          the root rounds are done, so workers share it without locking.
+===============================================================================*/
+class CutPool{
+  private:
+    int base;                     // columns of the LP before any cut, variables and row slacks
+    std::vector<Cut*> cuts;       // every cut kept, oldest first
+    std::vector<Cut*> active;     // cuts in the root LP, the k-th one's slack is column base+k
+    void age(Tableau&);           // age slack cuts and drop the expired ones from the root LP
+    void trim();                  // forget the oldest inactive cuts over CUT_POOL_SIZE
+
+  public:
+    CutPool(Tableau&);            // Constructor, for the unsolved or solved root LP before any cut
+    ~CutPool();
+
+    int root_rounds(Tableau&, int rounds);  // cut and re-solve the root LP, return the cuts added
+    bool node_bound(Tableau&, int rounds, double& bound, long& added) const; // bound of a solved node LP with cuts, false if they leave it infeasible
+
+    // Accessors
+    int get_size() { return cuts.size(); }      // cuts in the pool
+    int get_active() { return active.size(); }  // cuts in the root LP
+};
+
+#endif
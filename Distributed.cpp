@@ -0,0 +1,623 @@
+#include "Distributed.hpp"
+#include "Checkpoint.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//***************************************
+// Tree search over worker processes,
+// subtrees and incumbents exchanged as
+// messages on sockets
+//***************************************
+
+// milliseconds the coordinator waits for messages before it hands out work again
+const int COORDINATOR_POLL_MS=10;
+
+// milliseconds before a worker that had nothing to return is asked again
+const int DONATE_BACKOFF_MS=20;
+
+// node ids of each worker start this far apart
+const long WORKER_ID_SPAN=1L<<40;
+
+// counters a worker reports each time it runs out of work
+const int WORKER_COUNTERS=12;
+
+/*=============================================================================
+MessageType - what a message carries, after its MessageHeader
+===============================================================================*/
+enum MessageType{
+  MSG_HELLO,          // worker: WorkerHello, coordinator's reply: WorkerWelcome
+  MSG_WORK,           // open node records to search
+  MSG_INCUMBENT,      // an improving solution, its value then its count of values
+  MSG_DONATE,         // the coordinator asks for half of a worker's open nodes
+  MSG_NODES,          // the open node records returned, possibly none
+  MSG_IDLE,           // the worker has no open node, with its counters since it was last idle
+                      // and the largest parent bound of the nodes it dropped unsolved
+  MSG_STOP            // the search is over, or the worker's problem was refused
+};
+
+struct MessageHeader{
+  int type;           // a MessageType
+  int count;          // records or values in the payload
+  long bytes;         // length of the payload
+};
+
+struct WorkerHello{
+  int vars;           // decision variables of the worker's root
+  int basis_words;    // length of its compressed basis once it has its cuts
+  unsigned long model;  // model_hash of its root
+};
+
+struct WorkerWelcome{
+  long first_id;      // id of the worker's first node
+  bool keep_basis;    // the roots have the same shape, so records carry usable bases
+};
+
+/*=============================================================================
+send_all, recv_all - move every byte over a socket, false once the peer is
+                     gone
+===============================================================================*/
+static bool send_all(int fd, const void* p, size_t bytes){
+
+  const char* c=(const char*)p;
+  while (bytes > 0) {
+    ssize_t sent=send(fd, c, bytes, MSG_NOSIGNAL);
+    if (sent < 0 && errno==EINTR) continue;
+    if (sent <= 0) return false;
+    c+=sent;
+    bytes-=sent;
+  }
+  return true;
+}
+
+static bool recv_all(int fd, void* p, size_t bytes){
+
+  char* c=(char*)p;
+  while (bytes > 0) {
+    ssize_t got=recv(fd, c, bytes, 0);
+    if (got < 0 && errno==EINTR) continue;
+    if (got <= 0) return false;
+    c+=got;
+    bytes-=got;
+  }
+  return true;
+}
+
+static bool send_message(int fd, int type, int count, const void* payload, size_t bytes){
+  MessageHeader header{type, count, (long)bytes};
+  return send_all(fd, &header, sizeof(header)) && (bytes==0 || send_all(fd, payload, bytes));
+}
+
+static bool recv_message(int fd, MessageHeader& header, std::vector<char>& payload){
+  if (!recv_all(fd, &header, sizeof(header)) || header.bytes < 0 || header.count < 0) return false;
+  payload.resize(header.bytes);
+  return header.bytes==0 || recv_all(fd, payload.data(), header.bytes);
+}
+
+//a message is waiting
+static bool readable(int fd){
+  pollfd p{fd, POLLIN, 0};
+  return poll(&p, 1, 0) > 0;
+}
+
+/*=============================================================================
+open_socket - listening or connected stream socket for "unix:/path" or
+              "host:port"
+===============================================================================*/
+static int open_socket(const char* address, bool listening){
+
+  std::string text(address);
+  std::string failure=(listening ? "cannot listen on " : "cannot connect to ")+text;
+
+  if (text.compare(0, 5, "unix:")==0) {
+    std::string path=text.substr(5);
+    sockaddr_un addr={};
+    addr.sun_family=AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("bad socket path "+path);
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int fd=socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error(failure);
+    if (listening) unlink(path.c_str());
+    bool opened = listening ? bind(fd, (sockaddr*)&addr, sizeof(addr))==0 && listen(fd, SOMAXCONN)==0
+                            : connect(fd, (sockaddr*)&addr, sizeof(addr))==0;
+    if (!opened) {
+      close(fd);
+      throw std::runtime_error(failure);
+    }
+    return fd;
+  }
+
+  size_t colon=text.rfind(':');
+  if (colon==std::string::npos) throw std::runtime_error("address "+text+" is neither unix:path nor host:port");
+  std::string host=text.substr(0, colon), port=text.substr(colon+1);
+
+  addrinfo hints={};
+  hints.ai_family=AF_UNSPEC;
+  hints.ai_socktype=SOCK_STREAM;
+  hints.ai_flags = listening ? AI_PASSIVE : 0;
+  addrinfo* found;
+  if (getaddrinfo(host.empty() ? NULL : host.c_str(), port.c_str(), &hints, &found)!=0) throw std::runtime_error(failure);
+
+  int fd=-1;
+  for (addrinfo* a = found; a!=NULL; a=a->ai_next) {
+    fd=socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+    int on=1;
+    if (listening) {
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      if (bind(fd, a->ai_addr, a->ai_addrlen)==0 && listen(fd, SOMAXCONN)==0) break;
+    }
+    else if (connect(fd, a->ai_addr, a->ai_addrlen)==0) {
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      break;
+    }
+    close(fd);
+    fd=-1;
+  }
+  freeaddrinfo(found);
+
+  if (fd < 0) throw std::runtime_error(failure);
+  return fd;
+}
+
+/*=============================================================================
+worker_counters - the counters a worker reports, in message order
+===============================================================================*/
+static void worker_counters(SearchContext& ctx, std::atomic<long>** c){
+  std::atomic<long>* all[WORKER_COUNTERS]={&ctx.nodes, &ctx.lps, &ctx.pivots, &ctx.branched, &ctx.pruned,
+                                           &ctx.infeasible, &ctx.integral, &ctx.unsolved, &ctx.node_cuts, &ctx.strong_lps,
+                                           &ctx.heuristic_lps, &ctx.heuristic_solutions};
+  for (int k = 0; k < WORKER_COUNTERS; k++) c[k]=all[k];
+}
+
+/*=============================================================================
+append_record - serialize an open node at the end of a buffer
+===============================================================================*/
+static void append_record(std::vector<char>& out, Node* n){
+  size_t at=out.size();
+  out.resize(at+record_bytes(n));
+  write_record(&out[at], n);
+}
+
+/*=============================================================================
+push_records - open the nodes of count records, false and none opened if
+               they do not fit the buffer
+===============================================================================*/
+static bool push_records(const std::vector<char>& bytes, int count, bool keep_basis, OpenNodes& open){
+
+  const char* end=bytes.data()+bytes.size();
+  const char* p=bytes.data();
+  for (int i = 0; i < count; i++) {
+    size_t length=record_length(p, end);
+    if (length==0) return false;
+    p+=length;
+  }
+
+  p=bytes.data();
+  for (int i = 0; i < count; i++) {
+    Node* n;
+    p=read_record(p, &n, keep_basis);
+    open.push(n);
+  }
+  return true;
+}
+
+static bool send_incumbent(int fd, double value, const double* values, int vars){
+  std::vector<char> payload((1+vars)*sizeof(double));
+  memcpy(payload.data(), &value, sizeof(double));
+  memcpy(payload.data()+sizeof(double), values, vars*sizeof(double));
+  return send_message(fd, MSG_INCUMBENT, vars, payload.data(), payload.size());
+}
+
+/*=============================================================================
+donate - return every other open node to the coordinator, keeping the one
+         the worker would take next, and the others in their order
+===============================================================================*/
+static bool donate(int fd, OpenNodes& next_up){
+
+  std::vector<Node*> open;
+  while (!next_up.is_empty()) open.push_back(next_up.pop());
+
+  std::vector<char> records;
+  int count=0;
+  for (size_t i = 1; i < open.size(); i+=2) {
+    append_record(records, open[i]);
+    release_node(open[i]);
+    count++;
+  }
+  for (size_t i = open.size(); i-- > 0;) if (i%2==0) next_up.push(open[i]);
+
+  return send_message(fd, MSG_NODES, count, records.data(), records.size());
+}
+
+/*=============================================================================
+serve_search - say hello, then alternate between the coordinator's messages
+               and expanding the open nodes of the subtrees it sent, as the
+               serial search does. Reports its counters whenever it runs
+               dry, and waits there for more work or the end.
+===============================================================================*/
+void serve_search(LinearProgram* root_tab, const char* address, SearchSettings settings){
+
+  settings.threads=1;
+  settings.checkpoint=NULL;
+  settings.stats=NULL;
+
+  int fd=open_socket(address, false);
+  SearchContext ctx(root_tab, settings);
+  solve_root(ctx);
+  int vars=root_tab->get_vars();
+
+  MessageHeader header;
+  std::vector<char> payload;
+  WorkerHello hello{vars, root_tab->basis_words(), model_hash(root_tab)};
+  WorkerWelcome welcome;
+  if (!send_message(fd, MSG_HELLO, 0, &hello, sizeof(hello)) || !recv_message(fd, header, payload) ||
+      header.type!=MSG_HELLO || payload.size()!=sizeof(welcome)) {
+    close(fd);
+    return;
+  }
+  memcpy(&welcome, payload.data(), sizeof(welcome));
+  ctx.next_id.store(welcome.first_id);
+
+  OpenNodes next_up(settings);
+  Node* curr;
+  Node* children[2];
+  Node* found;
+  Node* best=NULL;
+  std::vector<double> values(vars);
+
+  bool has_incumbent=false;
+  double incumbent=-FLT_MAX;
+  bool idle=false, stopping=false;
+
+  //an improving solution of this worker is kept and reported at once
+  auto accept=[&](Node* n){
+    if (best!=NULL) release_node(best);
+    best=n;
+    incumbent=n->weight;
+    has_incumbent=true;
+    next_up.incumbent_found();
+    ctx.set_guide(n->problem->get_sol());
+    if (!send_incumbent(fd, n->weight, n->problem->get_sol()->args, vars)) stopping=true;
+  };
+
+  while (!stopping) {
+
+    //subtrees that cannot beat the incumbent are dropped whole
+    if (has_incumbent && !next_up.is_empty() && ctx.within_gap(next_up.max_weight(), incumbent)) next_up.clear();
+
+    if (next_up.is_empty() && !idle) {
+      std::atomic<long>* c[WORKER_COUNTERS];
+      long counts[WORKER_COUNTERS];
+      worker_counters(ctx, c);
+      for (int k = 0; k < WORKER_COUNTERS; k++) counts[k]=c[k]->exchange(0);
+      double unsolved_bound=ctx.unsolved_bound.exchange(-FLT_MAX);
+      std::vector<char> report(sizeof(counts)+sizeof(double));
+      memcpy(report.data(), counts, sizeof(counts));
+      memcpy(report.data()+sizeof(counts), &unsolved_bound, sizeof(double));
+      if (!send_message(fd, MSG_IDLE, WORKER_COUNTERS, report.data(), report.size())) break;
+      idle=true;
+    }
+
+    //wait for messages while idle, otherwise only take those already here
+    while (!stopping && (idle || readable(fd))) {
+      if (!recv_message(fd, header, payload)) {
+        stopping=true;
+        break;
+      }
+      switch (header.type) {
+
+        case MSG_WORK:
+          if (!push_records(payload, header.count, welcome.keep_basis, next_up)) stopping=true;
+          idle=next_up.is_empty();
+          break;
+
+        //a better incumbent of another worker prunes this one's nodes too
+        case MSG_INCUMBENT: {
+          double value;
+          if (payload.size()!=(1+vars)*sizeof(double)) {
+            stopping=true;
+            break;
+          }
+          memcpy(&value, payload.data(), sizeof(double));
+          if (has_incumbent && value <= incumbent) break;
+          memcpy(values.data(), payload.data()+sizeof(double), vars*sizeof(double));
+          OptimalSolution sol{value, values.data()};
+          ctx.set_guide(&sol);
+          incumbent=value;
+          has_incumbent=true;
+          next_up.incumbent_found();
+          break;
+        }
+
+        case MSG_DONATE:
+          if (!donate(fd, next_up)) stopping=true;
+          break;
+
+        default:
+          stopping=true;
+          break;
+      }
+    }
+    if (stopping || next_up.is_empty()) continue;
+
+    curr=next_up.pop();
+    NodeStatus status=expand_node(curr, has_incumbent, incumbent, ctx, children, &found);
+
+    if (found!=NULL) accept(found);
+
+    switch (status){
+      case NODE_INTEGRAL:
+        accept(curr);
+        break;
+
+      case NODE_BRANCHED:
+        next_up.push(children[0]);
+        next_up.push(children[1]);
+        release_node(curr);
+        break;
+
+      default:
+        release_node(curr);
+        break;
+    }
+  }
+
+  next_up.clear();
+  if (best!=NULL) release_node(best);
+  close(fd);
+}
+
+/*=============================================================================
+WorkerLink - the coordinator's view of one connected worker
+===============================================================================*/
+struct WorkerLink{
+  int fd;                   // its socket, -1 once it is dropped
+  bool ready=false;         // said hello with the same problem
+  bool keep_basis=true;     // its records carry bases of a root shaped as the coordinator's
+  bool busy=false;          // holds work and has not reported idle since
+  bool asked=false;         // a donation request is unanswered
+  std::chrono::steady_clock::time_point next_ask{};  // earliest time to ask for nodes again
+  std::vector<char> assigned{};  // records handed to it since it was last idle
+  int assigned_count=0;
+  double bound=-FLT_MAX;    // largest bound of those records
+};
+
+/*=============================================================================
+coordinate_search - seed the open nodes best-first, then hand out subtrees,
+                    forward incumbents and rebalance until nothing is open
+                    and every worker is idle
+===============================================================================*/
+OptimalSolution* coordinate_search(LinearProgram* root_tab, const char* address, int workers, SearchSettings settings){
+
+  settings.threads=1;
+  settings.selection=BEST_FIRST;
+  settings.checkpoint=NULL;
+
+  int listener=open_socket(address, true);
+  SearchContext ctx(root_tab, settings);
+  int vars=root_tab->get_vars();
+
+  OpenNodes pool(settings);
+  pool.push(root_node(root_tab));
+  ctx.note_open(1);
+
+  Node* children[2];
+  Node* found;
+  std::vector<double> values(vars);   // the incumbent's values
+  bool has_incumbent=false;
+  double incumbent=-FLT_MAX;
+
+  auto improve=[&](double value, const double* x){
+    values.assign(x, x+vars);
+    incumbent=value;
+    has_incumbent=true;
+    OptimalSolution sol{value, values.data()};
+    ctx.set_guide(&sol);
+  };
+
+  //seed enough subtrees to hand every expected worker some
+  while (!pool.is_empty() && pool.size < (long)SEED_NODES_PER_WORKER*workers) {
+    if (has_incumbent && ctx.within_gap(pool.max_weight(), incumbent)) break;
+    if (ctx.over_limit()) break;
+
+    Node* curr=pool.pop();
+    NodeStatus status=expand_node(curr, has_incumbent, incumbent, ctx, children, &found);
+    if (found!=NULL) {
+      improve(found->weight, found->problem->get_sol()->args);
+      release_node(found);
+    }
+    if (status==NODE_INTEGRAL) improve(curr->weight, curr->problem->get_sol()->args);
+    if (status==NODE_BRANCHED) {
+      pool.push(children[0]);
+      pool.push(children[1]);
+      ctx.note_open(pool.size);
+    }
+    release_node(curr);
+  }
+
+  std::vector<WorkerLink> links;
+  std::vector<pollfd> fds;
+  MessageHeader header;
+  std::vector<char> payload;
+  long next_first_id=WORKER_ID_SPAN;
+
+  //a lost worker's subtrees are handed out again
+  auto drop=[&](WorkerLink& link){
+    if (link.fd < 0) return;
+    push_records(link.assigned, link.assigned_count, true, pool);
+    ctx.note_open(pool.size);
+    close(link.fd);
+    link.fd=-1;
+  };
+
+  while (true) {
+
+    if (has_incumbent && ctx.within_gap(pool.max_weight(), incumbent)) pool.clear();
+
+    bool working=false, waiting=false;
+    for (size_t i = 0; i < links.size(); i++) {
+      if (links[i].busy || links[i].asked) working=true;
+      if (links[i].ready && !links[i].busy) waiting=true;
+    }
+    if (pool.is_empty() && !working) break;
+    if (ctx.over_limit()) break;
+
+    //the best open subtree to each idle worker
+    for (size_t i = 0; i < links.size() && !pool.is_empty(); i++) {
+      WorkerLink& link=links[i];
+      if (link.fd < 0 || !link.ready || link.busy) continue;
+
+      Node* n=pool.pop();
+      std::vector<char> record;
+      append_record(record, n);
+      link.bound=std::fmax(link.bound, n->weight);
+      release_node(n);
+
+      link.assigned.insert(link.assigned.end(), record.begin(), record.end());
+      link.assigned_count++;
+      link.busy=true;
+      if (!send_message(link.fd, MSG_WORK, 1, record.data(), record.size())) drop(link);
+    }
+
+    //idle workers and nothing to give them: busy ones share their nodes
+    auto now=std::chrono::steady_clock::now();
+    if (pool.is_empty() && waiting) {
+      for (size_t i = 0; i < links.size(); i++) {
+        WorkerLink& link=links[i];
+        if (link.fd < 0 || !link.busy || link.asked || now < link.next_ask) continue;
+        link.asked=true;
+        if (!send_message(link.fd, MSG_DONATE, 0, NULL, 0)) drop(link);
+      }
+    }
+
+    fds.clear();
+    fds.push_back(pollfd{listener, POLLIN, 0});
+    for (size_t i = 0; i < links.size(); i++) fds.push_back(pollfd{links[i].fd, POLLIN, 0});
+    if (poll(fds.data(), fds.size(), COORDINATOR_POLL_MS) <= 0) continue;
+
+    for (size_t i = 1; i < fds.size(); i++) {
+      WorkerLink& link=links[i-1];
+      if (fds[i].revents==0 || link.fd < 0) continue;
+      if (!recv_message(link.fd, header, payload)) {
+        drop(link);
+        continue;
+      }
+
+      switch (header.type) {
+
+        //a worker of another problem is sent away
+        case MSG_HELLO: {
+          WorkerHello hello;
+          if (payload.size()!=sizeof(hello)) {
+            drop(link);
+            break;
+          }
+          memcpy(&hello, payload.data(), sizeof(hello));
+          if (hello.vars!=vars || hello.model!=model_hash(root_tab)) {
+            send_message(link.fd, MSG_STOP, 0, NULL, 0);
+            drop(link);
+            break;
+          }
+          WorkerWelcome welcome{next_first_id, hello.basis_words==root_tab->basis_words()};
+          next_first_id+=WORKER_ID_SPAN;
+          link.keep_basis=welcome.keep_basis;
+          link.ready=true;
+          if (!send_message(link.fd, MSG_HELLO, 0, &welcome, sizeof(welcome)) ||
+              (has_incumbent && !send_incumbent(link.fd, incumbent, values.data(), vars))) drop(link);
+          break;
+        }
+
+        //improvements go on to every other worker
+        case MSG_INCUMBENT: {
+          double value;
+          if (payload.size()!=(1+vars)*sizeof(double)) {
+            drop(link);
+            break;
+          }
+          memcpy(&value, payload.data(), sizeof(double));
+          if (has_incumbent && value <= incumbent) break;
+          improve(value, (const double*)(payload.data()+sizeof(double)));
+          for (size_t k = 0; k < links.size(); k++) {
+            if (&links[k]==&link || links[k].fd < 0 || !links[k].ready) continue;
+            if (!send_incumbent(links[k].fd, incumbent, values.data(), vars)) drop(links[k]);
+          }
+          break;
+        }
+
+        case MSG_NODES:
+          link.asked=false;
+          if (header.count==0) link.next_ask=now+std::chrono::milliseconds(DONATE_BACKOFF_MS);
+          else if (!push_records(payload, header.count, link.keep_basis, pool)) drop(link);
+          ctx.note_open(pool.size);
+          break;
+
+        case MSG_IDLE: {
+          std::atomic<long>* c[WORKER_COUNTERS];
+          worker_counters(ctx, c);
+          if (payload.size()!=WORKER_COUNTERS*sizeof(long)+sizeof(double)) {
+            drop(link);
+            break;
+          }
+          const long* counts=(const long*)payload.data();
+          for (int k = 0; k < WORKER_COUNTERS; k++) c[k]->fetch_add(counts[k], std::memory_order_relaxed);
+          double unsolved_bound;
+          memcpy(&unsolved_bound, payload.data()+WORKER_COUNTERS*sizeof(long), sizeof(double));
+          ctx.note_unsolved(unsolved_bound);
+          link.busy=false;
+          link.assigned.clear();
+          link.assigned_count=0;
+          link.bound=-FLT_MAX;
+          break;
+        }
+
+        default:
+          drop(link);
+          break;
+      }
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int fd=accept(listener, NULL, NULL);
+      int on=1;
+      if (fd >= 0) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        links.push_back(WorkerLink{fd});
+      }
+    }
+
+    //forget dropped workers
+    size_t kept=0;
+    for (size_t i = 0; i < links.size(); i++) if (links[i].fd >= 0) links[kept++]=links[i];
+    links.resize(kept);
+  }
+
+  //subtrees still out with workers when a limit stops the search bound it too
+  double open_bound=pool.max_weight();
+  for (size_t i = 0; i < links.size(); i++) {
+    open_bound=std::fmax(open_bound, links[i].bound);
+    send_message(links[i].fd, MSG_STOP, 0, NULL, 0);
+    close(links[i].fd);
+  }
+  ctx.set_bound(open_bound, has_incumbent, incumbent);
+  close(listener);
+  if (strncmp(address, "unix:", 5)==0) unlink(address+5);
+
+  pool.clear();
+  ctx.report_stats();
+
+  if (!has_incumbent || ctx.unbounded()) return NULL;
+  OptimalSolution sol{incumbent, values.data()};
+  return copy_solution(&sol, vars);
+}
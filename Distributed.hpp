@@ -0,0 +1,44 @@
+#include "BranchAndBound.hpp"
+
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+// open nodes per expected worker the coordinator expands to before handing any out
+const int SEED_NODES_PER_WORKER=2;
+
+/*=============================================================================
+coordinate_search - branch_and_bound over worker processes connected to a
+                    socket. The address is "unix:/path" for a Unix socket,
+                    or "host:port" for TCP, with an empty host to listen
+                    on every interface. The coordinator expands the root,
+                    then best-first nodes until it holds
+                    SEED_NODES_PER_WORKER per expected worker. After that
+                    it hands each idle worker the best open subtree,
+                    described by its bound changes from the root and its
+                    parent's basis. Improving incumbents are forwarded to
+                    every worker as they arrive. When the coordinator
+                    runs out of subtrees while workers are idle, it asks
+                    busy workers to return half of their open nodes.
+                    Subtrees of a worker that disconnects are handed out
+                    again. Workers may join at any time, and the search
+                    ends once nothing is open and every worker is idle,
+                    or once a limit of the settings is reached, workers'
+                    nodes counting as they go idle. Waits for workers as
+                    long as it has work. Throws
+                    std::runtime_error if the address cannot be bound.
+===============================================================================*/
+OptimalSolution* coordinate_search(LinearProgram*, const char* address, int workers, SearchSettings settings=SearchSettings());
+
+/*=============================================================================
+serve_search - worker process of a coordinate_search on the same problem:
+               solve the root as the coordinator did, then search the
+               subtrees it hands out with the serial search under the
+               given settings. Incumbents are reported back as soon as
+               they are found, and the search returns once the
+               coordinator stops it or goes away. Throws
+               std::runtime_error if the address cannot be reached, and
+               returns at once if the coordinator refuses the problem.
+===============================================================================*/
+void serve_search(LinearProgram*, const char* address, SearchSettings settings=SearchSettings());
+
+#endif
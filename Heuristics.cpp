@@ -0,0 +1,312 @@
+#include "Heuristics.hpp"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+// randomized roundings tried per run
+const int RANDOM_ROUNDINGS=4;
+
+// feasibility pump iterations per run
+const int PUMP_ITERATIONS=30;
+
+// variables moved to their other rounding when the pump repeats a point
+const int PUMP_FLIPS=10;
+
+/*=============================================================================
+HeuristicRun - state of one run_heuristics call: the value to beat, the best
+               solution found so far, the LPs solved and the deadline of the
+               heuristic currently running
+===============================================================================*/
+struct HeuristicRun{
+  SearchContext& ctx;
+  int vars;
+  double integrality;   // the root LP's integrality tolerance
+  bool has_value;       // an incumbent or a solution of this run exists
+  double value;         // the better of them
+  Node* best=NULL;      // best solution of this run, NULL if none improved
+  long lps=0, pivots=0, solutions=0;
+  bool timed;           // heuristics stop at their deadline
+  std::chrono::steady_clock::time_point deadline;
+
+  HeuristicRun(SearchContext& ctx, bool has_incumbent, double incumbent):
+    ctx(ctx), vars(ctx.root->get_vars()), integrality(ctx.root->get_tolerances().integrality),
+    has_value(has_incumbent), value(incumbent),
+    timed(!(ctx.settings.deterministic && ctx.settings.threads > 1)) {}
+
+  //give the next heuristic its own budget
+  void start() {
+    deadline=std::chrono::steady_clock::now()+
+             std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(ctx.settings.heuristic_time));
+  }
+  bool out_of_time() { return timed && std::chrono::steady_clock::now() > deadline; }
+
+  //a solution of this value would beat the incumbent by more than the gap
+  bool improves(double v) { return !has_value || !ctx.within_gap(v, value); }
+
+  OptimalSolution* solve(LinearProgram* lp) {
+    long before=lp->get_pivots();
+    OptimalSolution* sol=lp->simplex();
+    lps++;
+    pivots+=lp->get_pivots()-before;
+    return sol;
+  }
+
+  //keep an integral node if it improves, recycle it otherwise
+  void offer(Node* n) {
+    if (!improves(n->weight)) {
+      release_node(n);
+      return;
+    }
+    if (best!=NULL) release_node(best);
+    best=n;
+    value=n->weight;
+    has_value=true;
+    solutions++;
+  }
+};
+
+/*=============================================================================
+integral_node - node holding an LP whose solution is integral, its values
+                snapped onto the integers
+===============================================================================*/
+static Node* integral_node(LinearProgram* lp, OptimalSolution* sol){
+
+  snap_solution(lp, sol);
+
+  return new Node{'H', NULL, lp, sol->eval, sol->eval};
+}
+
+/*=============================================================================
+fixed_node - the root LP with every variable fixed at an integer point,
+             solved, NULL if the point is infeasible
+===============================================================================*/
+Node* fixed_node(const double* x, SearchContext& ctx, long& pivots){
+
+  int vars=ctx.root->get_vars();
+
+  BoundChange* changes=(BoundChange*)node_pool().acquire(2*vars*sizeof(BoundChange));
+  for (size_t j = 0; j < vars; j++) {
+    changes[2*j].var=j;
+    changes[2*j].bound=x[j];
+    changes[2*j].geq=true;
+    changes[2*j+1].var=j;
+    changes[2*j+1].bound=x[j];
+    changes[2*j+1].geq=false;
+  }
+  LinearProgram* lp=ctx.root->rebuild(changes, 2*vars, NULL);
+  node_pool().release(changes, 2*vars*sizeof(BoundChange));
+
+  long before=lp->get_pivots();
+  OptimalSolution* sol=lp->simplex();
+  pivots+=lp->get_pivots()-before;
+  if (!lp->get_feasibility()) {
+    delete lp;
+    return NULL;
+  }
+  return integral_node(lp, sol);
+}
+
+/*=============================================================================
+try_point - check an integer point on the root LP with every variable fixed
+            at it, skipping points whose objective cannot improve
+===============================================================================*/
+static void try_point(const double* x, HeuristicRun& run){
+
+  double value=0;
+  for (size_t j = 0; j < run.vars; j++) value+=run.ctx.obj_coef[j]*x[j];
+  if (!run.improves(value)) return;
+
+  Node* n=fixed_node(x, run.ctx, run.pivots);
+  run.lps++;
+  if (n!=NULL) run.offer(n);
+}
+
+/*=============================================================================
+simple_rounding - every variable to its nearest integer, then every variable
+                  down, which keeps <= rows with non-negative coefficients
+===============================================================================*/
+static void simple_rounding(const double* x, HeuristicRun& run){
+
+  run.start();
+  std::vector<double> nearest(run.vars), down(run.vars);
+  for (size_t j = 0; j < run.vars; j++) {
+    nearest[j]=std::round(x[j]);
+    down[j]=std::floor(x[j]+run.integrality);
+  }
+
+  try_point(nearest.data(), run);
+  if (down!=nearest && !run.out_of_time()) try_point(down.data(), run);
+}
+
+/*=============================================================================
+randomized_rounding - round each fractional variable up with probability
+                      equal to its fractional part, RANDOM_ROUNDINGS times
+                      from a seed, skipping points already tried
+===============================================================================*/
+static void randomized_rounding(const double* x, unsigned long seed, HeuristicRun& run){
+
+  run.start();
+  unsigned long state=2654435761ul*(seed+1);
+
+  std::vector<std::vector<double> > tried;
+  for (int k = 0; k < RANDOM_ROUNDINGS && !run.out_of_time(); k++) {
+
+    std::vector<double> point(run.vars);
+    for (size_t j = 0; j < run.vars; j++) {
+      state^=state<<13; state^=state>>7; state^=state<<17;
+      double f=x[j]-std::floor(x[j]);
+      point[j] = (state>>11)*(1.0/9007199254740992.0) < f ? std::ceil(x[j]) : std::floor(x[j]);
+      if (std::fabs(x[j]-std::round(x[j])) <= run.integrality) point[j]=std::round(x[j]);
+    }
+
+    if (std::find(tried.begin(), tried.end(), point)!=tried.end()) continue;
+    tried.push_back(point);
+    try_point(point.data(), run);
+  }
+}
+
+/*=============================================================================
+dive - from a node's LP, repeatedly round one fractional variable and
+       re-solve, trying the other rounding once when the first leaves the LP
+       infeasible. Fractional diving rounds the variable closest to an
+       integer to that integer, guided diving the variable closest to the
+       incumbent's value towards it. Ends with an integral LP, which
+       is offered, an infeasible one, or a bound that cannot improve.
+===============================================================================*/
+static void dive(LinearProgram* start, OptimalSolution* sol, const double* guide, HeuristicRun& run){
+
+  run.start();
+  LinearProgram* lp=NULL;   // current dive LP, NULL while still at the node's own
+
+  for (int step = 0; step < 2*run.vars && !run.out_of_time(); step++) {
+
+    if (run.has_value && run.ctx.within_gap(sol->eval, run.value)) break;
+
+    int var=-1;
+    double closest=DBL_MAX;
+    for (size_t j = 0; j < run.vars; j++) {
+      double x=sol->args[j];
+      if (std::fabs(x-std::round(x)) <= run.integrality) continue;
+      double distance = guide!=NULL ? std::fabs(x-guide[j]) : std::fabs(x-std::round(x));
+      if (distance < closest) {
+        closest=distance;
+        var=j;
+      }
+    }
+
+    if (var==-1) {
+      if (lp!=NULL) run.offer(integral_node(lp, sol));
+      lp=NULL;
+      break;
+    }
+
+    double x=sol->args[var];
+    bool up = guide!=NULL ? guide[var] > x : std::round(x) > x;
+
+    BoundChange change;
+    change.var=var;
+    change.bound = up ? std::ceil(x) : std::floor(x);
+    change.geq=up;
+
+    LinearProgram* base = lp==NULL ? start : lp;
+    LinearProgram* next=base->rebuild(&change, 1, NULL);
+    OptimalSolution* next_sol=run.solve(next);
+
+    if (!next->get_feasibility()) {
+      delete next;
+      change.bound = up ? std::floor(x) : std::ceil(x);
+      change.geq=!up;
+      next=base->rebuild(&change, 1, NULL);
+      next_sol=run.solve(next);
+      if (!next->get_feasibility()) {
+        delete next;
+        break;
+      }
+    }
+
+    if (lp!=NULL) delete lp;
+    lp=next;
+    sol=next_sol;
+  }
+
+  if (lp!=NULL) delete lp;
+}
+
+/*=============================================================================
+feasibility_pump - alternate between rounding the LP point and moving the LP
+                   point as close as possible to the rounding, by re-solving
+                   a copy of the root Tableau for the objective of the
+                   distance: variables rounded to a bound are pushed towards
+                   it, others towards the side of their rounding. When a
+                   rounding repeats, the PUMP_FLIPS variables furthest from
+                   it move to their other rounding.
+===============================================================================*/
+static void feasibility_pump(Tableau* start, OptimalSolution* sol, HeuristicRun& run){
+
+  run.start();
+  int vars=run.vars;
+  Tableau* lp=static_cast<Tableau*>(start->rebuild(NULL, 0, NULL));
+
+  std::vector<double> x(sol->args, sol->args+vars), rounded(vars), previous;
+  std::vector<float> cost(vars);
+
+  for (int iteration = 0; iteration < PUMP_ITERATIONS && !run.out_of_time(); iteration++) {
+
+    bool integral=true;
+    for (size_t j = 0; j < vars; j++) {
+      rounded[j]=std::round(x[j]);
+      if (std::fabs(x[j]-rounded[j]) > run.integrality) integral=false;
+    }
+
+    if (rounded==previous) {
+      std::vector<std::pair<double, int> > furthest;
+      for (size_t j = 0; j < vars; j++) furthest.push_back(std::make_pair(-std::fabs(x[j]-rounded[j]), (int)j));
+      std::sort(furthest.begin(), furthest.end());
+      for (size_t k = 0; k < PUMP_FLIPS && k < vars && furthest[k].first < 0; k++) {
+        int j=furthest[k].second;
+        rounded[j] += x[j] > rounded[j] ? 1 : -1;
+      }
+    }
+
+    try_point(rounded.data(), run);
+    if (run.best!=NULL || integral) break;
+
+    for (size_t j = 0; j < vars; j++) {
+      if (rounded[j] <= lp->get_lower()[j]) cost[j]=-1;
+      else if (rounded[j] >= lp->get_upper()[j]) cost[j]=1;
+      else cost[j] = x[j] > rounded[j] ? -1 : x[j] < rounded[j] ? 1 : 0;
+    }
+    lp->set_cost(cost.data());
+
+    OptimalSolution* pumped=run.solve(lp);
+    if (!lp->get_feasibility()) break;
+
+    x.assign(pumped->args, pumped->args+vars);
+    previous=rounded;
+  }
+
+  delete lp;
+}
+
+/*=============================================================================
+run_heuristics - every heuristic in turn, each with its own time budget
+===============================================================================*/
+Node* run_heuristics(Node* curr, OptimalSolution* sol, bool has_incumbent, double incumbent, SearchContext& ctx){
+
+  HeuristicRun run(ctx, has_incumbent, incumbent);
+
+  simple_rounding(sol->args, run);
+  randomized_rounding(sol->args, curr->id, run);
+  dive(curr->problem, sol, NULL, run);
+
+  std::vector<double> guide(run.vars);
+  if (ctx.copy_guide(guide.data())) dive(curr->problem, sol, guide.data(), run);
+
+  Tableau* tab=dynamic_cast<Tableau*>(curr->problem);
+  if (curr->depth==0 && tab!=NULL && !run.has_value) feasibility_pump(tab, sol, run);
+
+  ctx.heuristic_lps.fetch_add(run.lps, std::memory_order_relaxed);
+  ctx.heuristic_solutions.fetch_add(run.solutions, std::memory_order_relaxed);
+  ctx.pivots.fetch_add(run.pivots, std::memory_order_relaxed);
+  return run.best;
+}
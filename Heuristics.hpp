@@ -0,0 +1,33 @@
+#include "BranchAndBound.hpp"
+
+#ifndef HEURISTICS_HPP
+#define HEURISTICS_HPP
+
+/*=============================================================================
+run_heuristics - look for an integer solution near a node's fractional LP
+                 solution, better than the incumbent if there is one:
+                 1. simple rounding, to the nearest integers and down
+                 2. randomized rounding, up with probability equal to the
+                    fractional part, seeded by the node id
+                 3. fractional diving, fixing the least fractional variable
+                    and re-solving until the LP is integral or infeasible
+                 4. guided diving, the same towards the incumbent's values
+                 5. at the root, a feasibility pump on a dense Tableau while
+                    nothing has been found
+                 Rounded points are checked on the root LP with every
+                 variable fixed, whose solved copy becomes the returned
+                 node, or NULL if no heuristic improved on the incumbent.
+                 Each heuristic stops after settings.heuristic_time
+                 seconds, except in the deterministic search where only
+                 their iteration limits apply.
+===============================================================================*/
+Node* run_heuristics(Node*, OptimalSolution*, bool has_incumbent, double incumbent, SearchContext&);
+
+/*=============================================================================
+fixed_node - node holding the root LP with every variable fixed at an
+             integer point, solved and snapped onto the integers, or NULL
+             if the point is infeasible. Adds the LP's pivots to pivots.
+===============================================================================*/
+Node* fixed_node(const double*, SearchContext&, long& pivots);
+
+#endif
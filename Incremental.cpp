@@ -0,0 +1,129 @@
+#include "Incremental.hpp"
+
+/*=============================================================================
+IncrementalSolver Constructor - keep the model's data, every column in
+                                [0, inf), and build its root Tableau
+===============================================================================*/
+IncrementalSolver::IncrementalSolver(float* obj, int var_count, float** constraints, int constraint_count):
+                                     vars(var_count), rows(constraint_count), cost(obj, obj+var_count),
+                                     lower(var_count+constraint_count, 0), upper(var_count+constraint_count, FLT_MAX),
+                                     root(NULL), pseudocosts(var_count), incumbent(var_count){
+
+  for (size_t i = 0; i < rows; i++) cons.push_back(std::vector<float>(constraints[i], constraints[i]+vars+1));
+  rebuild();
+}
+
+IncrementalSolver::~IncrementalSolver(){
+  delete root;
+}
+
+/*=============================================================================
+IncrementalSolver::rebuild - a Tableau of the current data, pivoted into the
+                             old root's basis if there is one
+===============================================================================*/
+long IncrementalSolver::rebuild(){
+
+  std::vector<float*> rows_at(rows);
+  for (size_t i = 0; i < rows; i++) rows_at[i]=cons[i].data();
+
+  Tableau* fresh=new Tableau(cost.data(), vars, rows_at.data(), rows);
+  for (size_t j = 0; j < vars+rows; j++) {
+    if (lower[j]!=0 || upper[j] < FLT_MAX) fresh->set_bounds(j, lower[j], upper[j]);
+  }
+
+  if (root==NULL) {
+    root=fresh;
+    return 0;
+  }
+
+  std::vector<unsigned> basis_bits(root->basis_words());
+  root->compress_basis(basis_bits.data());
+  Tableau* warm=new Tableau(*fresh, NULL, 0, basis_bits.data());
+
+  delete fresh;
+  delete root;
+  root=warm;
+  return warm->get_pivots();
+}
+
+/*=============================================================================
+IncrementalSolver::set_cost - the root reprices its objective row for the
+                              current basis
+===============================================================================*/
+void IncrementalSolver::set_cost(const float* obj){
+  for (size_t j = 0; j < vars; j++) cost[j]=obj[j];
+  root->set_cost(obj);
+}
+
+/*=============================================================================
+IncrementalSolver::set_rhs - the root's basic values move with the change
+===============================================================================*/
+void IncrementalSolver::set_rhs(int row, float rhs){
+  root->shift_rhs(row, rhs-cons[row][vars]);
+  cons[row][vars]=rhs;
+}
+
+/*=============================================================================
+IncrementalSolver::set_bounds - the root measures the column from its new
+                                bound, throwing for a free column before
+                                anything is kept
+===============================================================================*/
+void IncrementalSolver::set_bounds(int column, float new_lower, float new_upper){
+  root->set_bounds(column, new_lower, new_upper);
+  lower[column]=new_lower;
+  upper[column]=new_upper;
+}
+
+/*=============================================================================
+IncrementalSolver::solve - re-optimize the root in place, then search a copy
+                           of it from the last incumbent and the learnt
+                           pseudocosts. Crossed bounds, which a copy would
+                           not notice, and an infeasible or unbounded root
+                           end the solve before any search.
+===============================================================================*/
+OptimalSolution* IncrementalSolver::solve(SearchSettings settings){
+
+  long pivots=0;
+  if (!root->get_feasibility() || ++solves >= REBUILD_SOLVES) {
+    pivots+=rebuild();
+    solves=0;
+  }
+
+  bool crossed=false;
+  for (size_t j = 0; j < vars+rows; j++) if (lower[j] > upper[j]) crossed=true;
+
+  root->set_pricing(settings.pricing);
+  long before=root->get_pivots();
+  if (!crossed) root->simplex();
+  pivots+=root->get_pivots()-before;
+
+  if (crossed || !root->get_feasibility()) {
+    if (settings.stats!=NULL) {
+      *settings.stats=SearchStats();
+      settings.stats->nodes=1;
+      settings.stats->lps = crossed ? 0 : 1;
+      settings.stats->pivots=pivots;
+      settings.stats->tree_size=1;
+      if (root->get_unbounded()) {
+        settings.stats->status=SEARCH_UNBOUNDED;
+        settings.stats->bound=INFINITY;
+      }
+      else settings.stats->infeasible=1;
+    }
+    return NULL;
+  }
+
+  settings.start = has_incumbent ? incumbent.data() : NULL;
+  settings.pseudocosts=&pseudocosts;
+
+  LinearProgram* copy=root->rebuild(NULL, 0, NULL);
+  OptimalSolution* result=branch_and_bound(copy, settings);
+  delete copy;
+
+  if (settings.stats!=NULL) settings.stats->pivots+=pivots;
+  if (result!=NULL) {
+    for (size_t j = 0; j < vars; j++) incumbent[j]=result->args[j];
+    has_incumbent=true;
+  }
+  return result;
+}
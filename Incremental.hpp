@@ -0,0 +1,62 @@
+#include <vector>
+#include "BranchAndBound.hpp"
+
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+// solves between rebuilding the root LP from the model's data, clearing the round-off of its updates
+const int REBUILD_SOLVES=64;
+
+/*=============================================================================
+IncrementalSolver - one integer program solved again and again as its
+                    objective, right hand sides and bounds change. Takes the
+                    same arrays and set_bounds calls as the Tableau
+                    constructor, and keeps its root Tableau in the optimal
+                    basis of the last solve. Updates are applied to that
+                    basis: a new objective leaves it primal feasible for the
+                    primal simplex, new right hand sides and bounds leave
+                    it dual feasible for the dual simplex. Each search then
+                    starts from the last integer solution found, when it is
+                    still feasible, and from the pseudocosts every earlier
+                    search learnt. The search runs on a copy of the root,
+                    so its cuts never reach the kept one. A root left
+                    infeasible, or updated for REBUILD_SOLVES solves, is
+                    rebuilt from the data and pivoted back into its basis.
+===============================================================================*/
+class IncrementalSolver{
+  private:
+    int vars, rows;                         // dimensions of the model
+    std::vector<float> cost;                // objective coefficient of each variable
+    std::vector<std::vector<float> > cons;  // each row's coefficients and current right hand side
+    std::vector<float> lower, upper;        // bounds of each column, slacks from vars on
+    Tableau* root;                          // root LP in the basis of the last solve
+    Pseudocosts pseudocosts;                // learnt over every search so far
+    std::vector<double> incumbent;          // values of the last integer solution found
+    bool has_incumbent=false;
+    int solves=0;                           // solves since the root was last rebuilt
+
+    long rebuild();                         // fresh root from the data in the current basis, its pivots
+
+  public:
+    IncrementalSolver(float*, int, float**, int); // Constructor, same arguments as the Tableau constructor
+
+    /*          args:   float* obj,               // coefficients of objective function
+                        int var_count,            // number of decision variables in LP
+                        float** constraints,      // 2-D array of constraint arrays, each of length var_count+1
+                        int constraint_count):    // number of independent constraints
+    */
+
+    ~IncrementalSolver();
+    void set_cost(const float*);            // replace the objective coefficients
+    void set_rhs(int, float);               // replace the right hand side of a row
+    void set_bounds(int, float, float);     // bounds of a column or, from var_count on, a row's slack
+    OptimalSolution* solve(SearchSettings settings=SearchSettings()); // branch_and_bound from the last basis, its start and pseudocosts the solver's
+
+    // Accessors
+    int get_vars() { return vars; }
+    int get_rows() { return rows; }
+    const float* get_cost() { return cost.data(); }
+    float get_rhs(int row) { return cons[row][vars]; }
+};
+
+#endif
@@ -0,0 +1,342 @@
+#include "Kernels.hpp"
+#include <cfloat>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+//***************************************
+// Scalar versions, always available and
+// used for the tails of the SIMD loops
+//***************************************
+
+template<class T>
+static void add_rows_scalar(T* mutable_row, const T* pivot_row, T c, int length){
+  for (int i = 0; i < length; i++) mutable_row[i]-=c*pivot_row[i];
+}
+
+template<class T>
+static void scale_row_scalar(T* row, T pivot, int length){
+  for (int i = 0; i < length; i++) row[i]=row[i]/pivot;
+}
+
+template<class T>
+static void add_squares_scalar(T* sums, const T* row, int length){
+  for (int i = 0; i < length; i++) sums[i]+=row[i]*row[i];
+}
+
+template<class T>
+static int argmin_scalar(const T* row, int length){
+  T min=std::numeric_limits<T>::max();
+  int argmin=0;
+  for (int i = 0; i < length; i++){
+    if (row[i]<min){
+      min=row[i];
+      argmin=i;
+    }
+  }
+  return argmin;
+}
+
+#ifdef KERNELS_X86
+
+//***************************************
+// SSE versions, 4 floats per operation
+//***************************************
+
+__attribute__((target("sse2")))
+static void add_rows_sse(float* mutable_row, const float* pivot_row, float c, int length){
+  __m128 vc=_mm_set1_ps(c);
+  int i=0;
+  for (; i+4 <= length; i+=4){
+    __m128 r=_mm_loadu_ps(mutable_row+i);
+    _mm_storeu_ps(mutable_row+i, _mm_sub_ps(r, _mm_mul_ps(vc, _mm_loadu_ps(pivot_row+i))));
+  }
+  add_rows_scalar(mutable_row+i, pivot_row+i, c, length-i);
+}
+
+__attribute__((target("sse2")))
+static void scale_row_sse(float* row, float pivot, int length){
+  __m128 vp=_mm_set1_ps(pivot);
+  int i=0;
+  for (; i+4 <= length; i+=4) _mm_storeu_ps(row+i, _mm_div_ps(_mm_loadu_ps(row+i), vp));
+  scale_row_scalar(row+i, pivot, length-i);
+}
+
+__attribute__((target("sse2")))
+static void add_squares_sse(float* sums, const float* row, int length){
+  int i=0;
+  for (; i+4 <= length; i+=4){
+    __m128 r=_mm_loadu_ps(row+i);
+    _mm_storeu_ps(sums+i, _mm_add_ps(_mm_loadu_ps(sums+i), _mm_mul_ps(r, r)));
+  }
+  add_squares_scalar(sums+i, row+i, length-i);
+}
+
+__attribute__((target("sse2")))
+static int argmin_sse(const float* row, int length){
+  //find the minimum value with vector compares, then the first index holding it
+  __m128 vmin=_mm_set1_ps(FLT_MAX);
+  int i=0;
+  for (; i+4 <= length; i+=4) vmin=_mm_min_ps(vmin, _mm_loadu_ps(row+i));
+
+  float lanes[4];
+  _mm_storeu_ps(lanes, vmin);
+  float min=lanes[0];
+  for (int k = 1; k < 4; k++) if (lanes[k]<min) min=lanes[k];
+  for (; i < length; i++) if (row[i]<min) min=row[i];
+
+  for (i = 0; i < length; i++) if (row[i]==min) return i;
+  return 0;
+}
+
+__attribute__((target("sse2")))
+static void add_rows_sse(double* mutable_row, const double* pivot_row, double c, int length){
+  __m128d vc=_mm_set1_pd(c);
+  int i=0;
+  for (; i+2 <= length; i+=2){
+    __m128d r=_mm_loadu_pd(mutable_row+i);
+    _mm_storeu_pd(mutable_row+i, _mm_sub_pd(r, _mm_mul_pd(vc, _mm_loadu_pd(pivot_row+i))));
+  }
+  add_rows_scalar(mutable_row+i, pivot_row+i, c, length-i);
+}
+
+__attribute__((target("sse2")))
+static void scale_row_sse(double* row, double pivot, int length){
+  __m128d vp=_mm_set1_pd(pivot);
+  int i=0;
+  for (; i+2 <= length; i+=2) _mm_storeu_pd(row+i, _mm_div_pd(_mm_loadu_pd(row+i), vp));
+  scale_row_scalar(row+i, pivot, length-i);
+}
+
+__attribute__((target("sse2")))
+static void add_squares_sse(double* sums, const double* row, int length){
+  int i=0;
+  for (; i+2 <= length; i+=2){
+    __m128d r=_mm_loadu_pd(row+i);
+    _mm_storeu_pd(sums+i, _mm_add_pd(_mm_loadu_pd(sums+i), _mm_mul_pd(r, r)));
+  }
+  add_squares_scalar(sums+i, row+i, length-i);
+}
+
+__attribute__((target("sse2")))
+static int argmin_sse(const double* row, int length){
+  __m128d vmin=_mm_set1_pd(DBL_MAX);
+  int i=0;
+  for (; i+2 <= length; i+=2) vmin=_mm_min_pd(vmin, _mm_loadu_pd(row+i));
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, vmin);
+  double min = lanes[1]<lanes[0] ? lanes[1] : lanes[0];
+  for (; i < length; i++) if (row[i]<min) min=row[i];
+
+  for (i = 0; i < length; i++) if (row[i]==min) return i;
+  return 0;
+}
+
+//***************************************
+// AVX2 versions, 8 floats or 4 doubles
+// per operation
+//***************************************
+
+__attribute__((target("avx2")))
+static void add_rows_avx2(float* mutable_row, const float* pivot_row, float c, int length){
+  __m256 vc=_mm256_set1_ps(c);
+  int i=0;
+  for (; i+8 <= length; i+=8){
+    __m256 r=_mm256_loadu_ps(mutable_row+i);
+    _mm256_storeu_ps(mutable_row+i, _mm256_sub_ps(r, _mm256_mul_ps(vc, _mm256_loadu_ps(pivot_row+i))));
+  }
+  add_rows_scalar(mutable_row+i, pivot_row+i, c, length-i);
+}
+
+__attribute__((target("avx2")))
+static void scale_row_avx2(float* row, float pivot, int length){
+  __m256 vp=_mm256_set1_ps(pivot);
+  int i=0;
+  for (; i+8 <= length; i+=8) _mm256_storeu_ps(row+i, _mm256_div_ps(_mm256_loadu_ps(row+i), vp));
+  scale_row_scalar(row+i, pivot, length-i);
+}
+
+__attribute__((target("avx2")))
+static void add_squares_avx2(float* sums, const float* row, int length){
+  int i=0;
+  for (; i+8 <= length; i+=8){
+    __m256 r=_mm256_loadu_ps(row+i);
+    _mm256_storeu_ps(sums+i, _mm256_add_ps(_mm256_loadu_ps(sums+i), _mm256_mul_ps(r, r)));
+  }
+  add_squares_scalar(sums+i, row+i, length-i);
+}
+
+__attribute__((target("avx2")))
+static int argmin_avx2(const float* row, int length){
+  __m256 vmin=_mm256_set1_ps(FLT_MAX);
+  int i=0;
+  for (; i+8 <= length; i+=8) vmin=_mm256_min_ps(vmin, _mm256_loadu_ps(row+i));
+
+  float lanes[8];
+  _mm256_storeu_ps(lanes, vmin);
+  float min=lanes[0];
+  for (int k = 1; k < 8; k++) if (lanes[k]<min) min=lanes[k];
+  for (; i < length; i++) if (row[i]<min) min=row[i];
+
+  for (i = 0; i < length; i++) if (row[i]==min) return i;
+  return 0;
+}
+
+__attribute__((target("avx2")))
+static void add_rows_avx2(double* mutable_row, const double* pivot_row, double c, int length){
+  __m256d vc=_mm256_set1_pd(c);
+  int i=0;
+  for (; i+4 <= length; i+=4){
+    __m256d r=_mm256_loadu_pd(mutable_row+i);
+    _mm256_storeu_pd(mutable_row+i, _mm256_sub_pd(r, _mm256_mul_pd(vc, _mm256_loadu_pd(pivot_row+i))));
+  }
+  add_rows_scalar(mutable_row+i, pivot_row+i, c, length-i);
+}
+
+__attribute__((target("avx2")))
+static void scale_row_avx2(double* row, double pivot, int length){
+  __m256d vp=_mm256_set1_pd(pivot);
+  int i=0;
+  for (; i+4 <= length; i+=4) _mm256_storeu_pd(row+i, _mm256_div_pd(_mm256_loadu_pd(row+i), vp));
+  scale_row_scalar(row+i, pivot, length-i);
+}
+
+__attribute__((target("avx2")))
+static void add_squares_avx2(double* sums, const double* row, int length){
+  int i=0;
+  for (; i+4 <= length; i+=4){
+    __m256d r=_mm256_loadu_pd(row+i);
+    _mm256_storeu_pd(sums+i, _mm256_add_pd(_mm256_loadu_pd(sums+i), _mm256_mul_pd(r, r)));
+  }
+  add_squares_scalar(sums+i, row+i, length-i);
+}
+
+__attribute__((target("avx2")))
+static int argmin_avx2(const double* row, int length){
+  __m256d vmin=_mm256_set1_pd(DBL_MAX);
+  int i=0;
+  for (; i+4 <= length; i+=4) vmin=_mm256_min_pd(vmin, _mm256_loadu_pd(row+i));
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, vmin);
+  double min=lanes[0];
+  for (int k = 1; k < 4; k++) if (lanes[k]<min) min=lanes[k];
+  for (; i < length; i++) if (row[i]<min) min=row[i];
+
+  for (i = 0; i < length; i++) if (row[i]==min) return i;
+  return 0;
+}
+
+#endif
+
+//***************************************
+// Runtime dispatch, the table is filled
+// once, on the first call of any kernel
+//***************************************
+
+/*=============================================================================
+KernelTable - the kernels every public entry point forwards to
+===============================================================================*/
+struct KernelTable{
+  void (*add_rows)(float*, const float*, float, int);
+  void (*scale_row)(float*, float, int);
+  void (*add_squares)(float*, const float*, int);
+  int (*argmin)(const float*, int);
+  void (*add_rows_d)(double*, const double*, double, int);
+  void (*scale_row_d)(double*, double, int);
+  void (*add_squares_d)(double*, const double*, int);
+  int (*argmin_d)(const double*, int);
+  const char* isa;      // instruction set of the kernels
+};
+
+/*=============================================================================
+select_kernels - the widest kernels the CPU supports
+===============================================================================*/
+static KernelTable select_kernels(){
+
+  KernelTable table={add_rows_scalar<float>, scale_row_scalar<float>, add_squares_scalar<float>, argmin_scalar<float>,
+                     add_rows_scalar<double>, scale_row_scalar<double>, add_squares_scalar<double>, argmin_scalar<double>,
+                     "scalar"};
+
+#ifdef KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")){
+    table={add_rows_avx2, scale_row_avx2, add_squares_avx2, argmin_avx2,
+           add_rows_avx2, scale_row_avx2, add_squares_avx2, argmin_avx2, "avx2"};
+  }
+  else if (__builtin_cpu_supports("sse2")){
+    table={add_rows_sse, scale_row_sse, add_squares_sse, argmin_sse,
+           add_rows_sse, scale_row_sse, add_squares_sse, argmin_sse, "sse2"};
+  }
+#endif
+
+  return table;
+}
+
+/*=============================================================================
+kernels - the selected table, its initialization is thread safe so workers
+          calling their first kernel at once select it only once
+===============================================================================*/
+static const KernelTable& kernels(){
+  static const KernelTable table=select_kernels();
+  return table;
+}
+
+/*=============================================================================
+Public entry points - forward to the selected kernels
+===============================================================================*/
+void add_rows(float* mutable_row, const float* pivot_row, float c, int length){
+  kernels().add_rows(mutable_row, pivot_row, c, length);
+}
+
+void scale_row(float* row, float pivot, int length){
+  kernels().scale_row(row, pivot, length);
+}
+
+void add_squares(float* sums, const float* row, int length){
+  kernels().add_squares(sums, row, length);
+}
+
+int argmin(const float* row, int length){
+  return kernels().argmin(row, length);
+}
+
+void add_rows(double* mutable_row, const double* pivot_row, double c, int length){
+  kernels().add_rows_d(mutable_row, pivot_row, c, length);
+}
+
+void scale_row(double* row, double pivot, int length){
+  kernels().scale_row_d(row, pivot, length);
+}
+
+void add_squares(double* sums, const double* row, int length){
+  kernels().add_squares_d(sums, row, length);
+}
+
+int argmin(const double* row, int length){
+  return kernels().argmin_d(row, length);
+}
+
+void add_rows(long double* mutable_row, const long double* pivot_row, long double c, int length){
+  add_rows_scalar(mutable_row, pivot_row, c, length);
+}
+
+void scale_row(long double* row, long double pivot, int length){
+  scale_row_scalar(row, pivot, length);
+}
+
+void add_squares(long double* sums, const long double* row, int length){
+  add_squares_scalar(sums, row, length);
+}
+
+int argmin(const long double* row, int length){
+  return argmin_scalar(row, length);
+}
+
+const char* kernel_name(){
+  return kernels().isa;
+}
@@ -0,0 +1,60 @@
+#include <cstddef>
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+/*=============================================================================
+Row kernels - the inner loops of a simplex pivot over contiguous rows of
+              float, double or long double. The float and double kernels
+              have a scalar, SSE and AVX2 version, the widest one the CPU
+              supports is picked the first time any kernel is called. Long
+              double rows only have the scalar version.
+===============================================================================*/
+
+// bytes per cache line, tableau rows are padded to a multiple of this
+const int ROW_ALIGN=64;
+
+/*=============================================================================
+padded_stride - round a row length of entries of the given size up to a
+                whole number of cache lines
+===============================================================================*/
+inline int padded_stride(int length, size_t entry_bytes=sizeof(float)){
+  int per_line=ROW_ALIGN/entry_bytes;
+  return (length+per_line-1)/per_line*per_line;
+}
+
+/*=============================================================================
+add_rows - rank-1 row elimination, mutable_row -= c*pivot_row
+===============================================================================*/
+void add_rows(float* mutable_row, const float* pivot_row, float c, int length);
+void add_rows(double* mutable_row, const double* pivot_row, double c, int length);
+void add_rows(long double* mutable_row, const long double* pivot_row, long double c, int length);
+
+/*=============================================================================
+scale_row - divide every entry of a row by the pivot element
+===============================================================================*/
+void scale_row(float* row, float pivot, int length);
+void scale_row(double* row, double pivot, int length);
+void scale_row(long double* row, long double pivot, int length);
+
+/*=============================================================================
+add_squares - accumulate the square of every entry of a row, sums += row*row,
+              used for steepest edge column norms
+===============================================================================*/
+void add_squares(float* sums, const float* row, int length);
+void add_squares(double* sums, const double* row, int length);
+void add_squares(long double* sums, const long double* row, int length);
+
+/*=============================================================================
+argmin - index of the first most negative element of a row, used for pricing
+===============================================================================*/
+int argmin(const float* row, int length);
+int argmin(const double* row, int length);
+int argmin(const long double* row, int length);
+
+/*=============================================================================
+kernel_name - name of the instruction set the kernels dispatched to
+===============================================================================*/
+const char* kernel_name();
+
+#endif
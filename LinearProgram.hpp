@@ -0,0 +1,79 @@
+#include <cstddef>
+
+#ifndef LINEARPROGRAM_HPP
+#define LINEARPROGRAM_HPP
+
+/*=================================================
+OptimalSolution - structure holding the optimal objective
+                  function evaluation and it's corresponding
+                  decision variable arguments.
+====================================================*/
+struct OptimalSolution{
+  double eval=0;       // function evaluation of optimal value
+  double* args=NULL;   // returns optimal value of decision variables
+};
+
+/*=================================================
+BoundChange - one branching decision, tightening the
+              upper bound of x[var] to bound, or its
+              lower bound if geq
+====================================================*/
+struct BoundChange{
+  int var;
+  double bound;
+  bool geq;
+};
+
+/*=================================================
+Tolerances - thresholds an LP engine and the search
+             compare against instead of exact zero.
+             Each engine starts from the defaults
+             of its scalar type, and the LPs of
+             tree nodes inherit their root's.
+====================================================*/
+struct Tolerances{
+  double pivot;         // magnitude below which an entry is not pivoted on, relative to its row or column in the dense engine
+  double feasibility;   // amount by which a basic value may lie outside its bounds
+  double optimality;    // negative reduced cost above which a column no longer enters
+  double integrality;   // distance from the nearest integer within which a value counts as integral
+};
+
+/*=================================================
+scalar_tolerances - defaults for pivoting in a scalar
+                    type, loose enough for float to
+                    ride out round-off such as
+                    2.9999998 and tighter as the
+                    precision grows
+====================================================*/
+template<class T> inline Tolerances scalar_tolerances();
+template<> inline Tolerances scalar_tolerances<float>() { return Tolerances{1e-5, 1e-5, 1e-5, 1e-5}; }
+template<> inline Tolerances scalar_tolerances<double>() { return Tolerances{1e-9, 1e-7, 1e-7, 1e-6}; }
+template<> inline Tolerances scalar_tolerances<long double>() { return Tolerances{1e-11, 1e-9, 1e-9, 1e-6}; }
+
+/*=================================================
+LinearProgram - LP relaxation as seen by the tree
+                search. The root is solved in place,
+                every other node's LP is rebuilt from
+                it with the node's bound changes, so
+                the engine is chosen by the type of
+                the root handed to branch_and_bound.
+====================================================*/
+class LinearProgram{
+  public:
+    virtual ~LinearProgram() {}
+    virtual OptimalSolution* simplex()=0;               // solve the LP, NULL-free: check get_feasibility afterwards
+    virtual LinearProgram* rebuild(const BoundChange*, int, const unsigned*)=0; // pooled LP of a tree node, in a compressed basis or NULL
+    virtual int basis_words()=0;                        // length of a compressed basis in 32 bit words
+    virtual void compress_basis(unsigned*)=0;           // store the optimal basis for warm-starting children
+    virtual int get_vars()=0;                           // count of decision variables
+    virtual const float* get_cost()=0;                  // objective coefficients of the decision variables
+    virtual bool get_feasibility()=0;                   // false once simplex found no feasible point, or no optimal one
+    virtual bool get_unbounded()=0;                     // true once simplex found the objective unbounded, get_feasibility is then false
+    virtual bool get_status()=0;                        // true once simplex has run to an answer, false if it stopped at an iteration limit
+    virtual OptimalSolution* get_sol()=0;               // optimal solution, NULL until solved
+    virtual long get_pivots()=0;                        // basis changes made since construction
+    virtual const Tolerances& get_tolerances()=0;       // thresholds of this LP, integrality included
+    virtual void set_tolerances(const Tolerances&)=0;   // replace them, LPs rebuilt from this one inherit them
+};
+
+#endif
@@ -0,0 +1,886 @@
+#include "ModelReader.hpp"
+#include <cstring>
+#include <cfloat>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//***************************************
+// MPS and CPLEX LP readers, parsing a
+// memory-mapped file straight into the
+// CSC arrays a SparseLP adopts
+//***************************************
+
+// bound magnitude from which MPS and LP files mean infinity
+const double INFINITE_BOUND=1e30;
+
+// exactly representable powers of ten for parse_number
+static const double POWERS_OF_TEN[]={1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/*=============================================================================
+fail - throw a parse error for a line of the file
+==============================================================================*/
+[[noreturn]] static void fail(const std::string& what, int line){
+  throw std::runtime_error("line "+std::to_string(line)+": "+what);
+}
+
+/*=============================================================================
+MappedFile - read-only mapping of a whole file, parsed in place so names and
+            numbers are never copied out of it
+==============================================================================*/
+struct MappedFile{
+  const char* data;
+  size_t size;
+
+  MappedFile(const char* path): data(NULL), size(0){
+
+    int fd=open(path, O_RDONLY);
+    if (fd < 0) throw std::runtime_error(std::string("cannot open ")+path);
+
+    struct stat info;
+    if (fstat(fd, &info)!=0) {
+      close(fd);
+      throw std::runtime_error(std::string("cannot stat ")+path);
+    }
+
+    size=info.st_size;
+    if (size > 0) {
+      void* p=mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p==MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error(std::string("cannot map ")+path);
+      }
+      madvise(p, size, MADV_SEQUENTIAL);
+      data=(const char*)p;
+    }
+    close(fd);
+  }
+
+  ~MappedFile(){
+    if (data!=NULL) munmap((void*)data, size);
+  }
+};
+
+/*=============================================================================
+NameTable - open addressing hash table from names inside the mapped file to
+            row or column indices, the names themselves are not copied
+==============================================================================*/
+struct NameTable{
+  struct Slot{ const char* name; int length; int index; };
+
+  Slot* slots;
+  size_t capacity;      // a power of two, at most half full
+  size_t count;
+
+  NameTable(): capacity(1024), count(0) { slots=new Slot[capacity](); }
+  ~NameTable() { delete[] slots; }
+
+  static size_t hash(const char* name, int length){
+    size_t h=14695981039346656037ull;
+    for (int i = 0; i < length; i++) h=(h^(unsigned char)name[i])*1099511628211ull;
+    return h;
+  }
+
+  //index stored for a name, -1 if absent
+  int find(const char* name, int length){
+    for (size_t s = hash(name, length)&(capacity-1); slots[s].name!=NULL; s=(s+1)&(capacity-1)) {
+      if (slots[s].length==length && std::memcmp(slots[s].name, name, length)==0) return slots[s].index;
+    }
+    return -1;
+  }
+
+  //add a name known to be absent
+  void insert(const char* name, int length, int index){
+    if (2*(count+1) > capacity) grow();
+    size_t s=hash(name, length)&(capacity-1);
+    while (slots[s].name!=NULL) s=(s+1)&(capacity-1);
+    slots[s].name=name;
+    slots[s].length=length;
+    slots[s].index=index;
+    count++;
+  }
+
+  void grow(){
+    Slot* old=slots;
+    size_t old_capacity=capacity;
+    capacity*=2;
+    slots=new Slot[capacity]();
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old[i].name==NULL) continue;
+      size_t s=hash(old[i].name, old[i].length)&(capacity-1);
+      while (slots[s].name!=NULL) s=(s+1)&(capacity-1);
+      slots[s]=old[i];
+    }
+    delete[] old;
+  }
+};
+
+/*=============================================================================
+same_word - case-insensitive comparison of a token with a keyword
+==============================================================================*/
+static bool same_word(const char* token, int length, const char* word){
+  int n=std::strlen(word);
+  if (n!=length) return false;
+  for (int i = 0; i < n; i++) if (std::tolower((unsigned char)token[i])!=word[i]) return false;
+  return true;
+}
+
+/*=============================================================================
+parse_number - read a whole token as a decimal number or an infinity, without
+              needing the terminator strtod would. False if it is neither.
+==============================================================================*/
+static bool parse_number(const char* s, int length, double& out){
+
+  const char* end=s+length;
+  bool negative=false;
+  if (s < end && (*s=='+' || *s=='-')) negative=(*s++=='-');
+
+  if (same_word(s, end-s, "inf") || same_word(s, end-s, "infinity")) {
+    out = negative ? -HUGE_VAL : HUGE_VAL;
+    return true;
+  }
+
+  //up to 19 significant digits are kept exactly, later ones only scale
+  unsigned long long mantissa=0;
+  int digits=0, exponent=0;
+  bool any=false;
+
+  for (; s < end && std::isdigit((unsigned char)*s); s++, any=true) {
+    if (digits < 19) { mantissa=mantissa*10+(*s-'0'); if (mantissa!=0) digits++; }
+    else exponent++;
+  }
+  if (s < end && *s=='.') {
+    for (s++; s < end && std::isdigit((unsigned char)*s); s++, any=true) {
+      if (digits < 19) { mantissa=mantissa*10+(*s-'0'); if (mantissa!=0) digits++; exponent--; }
+    }
+  }
+  if (!any) return false;
+
+  if (s < end && (*s=='e' || *s=='E')) {
+    s++;
+    bool negative_exponent=false;
+    if (s < end && (*s=='+' || *s=='-')) negative_exponent=(*s++=='-');
+    if (s==end || !std::isdigit((unsigned char)*s)) return false;
+    int e=0;
+    for (; s < end && std::isdigit((unsigned char)*s); s++) if (e < 10000) e=e*10+(*s-'0');
+    exponent += negative_exponent ? -e : e;
+  }
+  if (s!=end) return false;
+
+  double value=(double)mantissa;
+  if (exponent >= 0 && exponent <= 22) value*=POWERS_OF_TEN[exponent];
+  else if (exponent < 0 && exponent >= -22) value/=POWERS_OF_TEN[-exponent];
+  else value*=std::pow(10.0, exponent);
+
+  out = negative ? -value : value;
+  return true;
+}
+
+/*=============================================================================
+bound_to_float - column bound for SparseLP::set_bounds, huge values are infinite
+==============================================================================*/
+static float bound_to_float(double bound){
+  if (bound >= INFINITE_BOUND) return FLT_MAX;
+  if (bound <= -INFINITE_BOUND) return -FLT_MAX;
+  return bound;
+}
+
+/*=============================================================================
+finish_model - build the SparseLP around the filled arrays and apply column
+              bounds and row senses. Senses are 'L' for <=, 'G' for >= and
+              'E' for =, each row optionally ranged.
+==============================================================================*/
+static Model finish_model(int vars, int rows, int* col_start, int* row_index, double* value, double* rhs,
+                          float* cost, bool minimize, double offset,
+                          const std::vector<double>& lower, const std::vector<double>& upper,
+                          const std::vector<char>& sense, const std::vector<double>& range,
+                          const std::vector<std::string>& column_names){
+
+  for (size_t j = 0; j < vars; j++) {
+    if (lower[j] <= -INFINITE_BOUND && upper[j] >= INFINITE_BOUND) {
+      delete[] col_start; delete[] row_index; delete[] value; delete[] rhs; delete[] cost;
+      throw std::runtime_error("free column "+column_names[j]+" is not supported");
+    }
+  }
+
+  if (minimize) for (size_t j = 0; j < vars; j++) cost[j]=-cost[j];
+
+  Model model;
+  model.lp=new SparseLP(vars, rows, col_start, row_index, value, rhs, cost);
+  model.minimize=minimize;
+  model.offset=offset;
+
+  for (size_t j = 0; j < vars; j++) {
+    if (lower[j]!=0 || upper[j] < INFINITE_BOUND) model.lp->set_bounds(j, bound_to_float(lower[j]), bound_to_float(upper[j]));
+  }
+
+  //row i reads a.x + s = rhs, so the slack's bounds carry the sense and range
+  for (size_t i = 0; i < rows; i++) {
+    double r=range[i];
+    double lo=0, up=HUGE_VAL;
+    if (sense[i]=='G') { lo=-HUGE_VAL; up=0; }
+    if (sense[i]=='E') up=0;
+    if (r==r) {
+      if (sense[i]=='L') up=std::fabs(r);
+      else if (sense[i]=='G') lo=-std::fabs(r);
+      else if (r > 0) lo=-r;
+      else up=-r;
+    }
+    if (lo!=0 || up < HUGE_VAL) model.lp->set_bounds(vars+i, bound_to_float(lo), bound_to_float(up));
+  }
+
+  return model;
+}
+
+/*=============================================================================
+MPS sections, in the order they appear
+==============================================================================*/
+enum MpsSection{ MPS_NONE, MPS_NAME, MPS_OBJSENSE, MPS_ROWS, MPS_COLUMNS, MPS_RHS, MPS_RANGES, MPS_BOUNDS, MPS_END };
+
+// row table indices of the objective and of further, ignored, N rows, find gives -1 for unknown rows
+const int OBJECTIVE_ROW=-2;
+const int FREE_ROW=-3;
+
+// most tokens on an MPS data line
+const int MPS_TOKENS=8;
+
+static MpsSection mps_section(const char* token, int length){
+  if (same_word(token, length, "name")) return MPS_NAME;
+  if (same_word(token, length, "objsense")) return MPS_OBJSENSE;
+  if (same_word(token, length, "rows")) return MPS_ROWS;
+  if (same_word(token, length, "columns")) return MPS_COLUMNS;
+  if (same_word(token, length, "rhs")) return MPS_RHS;
+  if (same_word(token, length, "ranges")) return MPS_RANGES;
+  if (same_word(token, length, "bounds")) return MPS_BOUNDS;
+  if (same_word(token, length, "endata")) return MPS_END;
+  return MPS_NONE;
+}
+
+/*=============================================================================
+MpsLines - walks the mapped file line by line, splitting each into tokens
+==============================================================================*/
+struct MpsLines{
+  const char* p;
+  const char* end;
+  int line;
+  bool header;                        // line starts in column one, a section name
+  const char* token[MPS_TOKENS];
+  int length[MPS_TOKENS];
+  int count;
+
+  MpsLines(const char* start, const char* stop, int first_line): p(start), end(stop), line(first_line-1) {}
+
+  //next line holding any token, false at the end of the file
+  bool next(){
+    while (p < end) {
+      const char* stop=(const char*)std::memchr(p, '\n', end-p);
+      if (stop==NULL) stop=end;
+      const char* s=p;
+      p = (stop < end) ? stop+1 : end;
+      line++;
+
+      if (*s=='*') continue;
+      header=!std::isspace((unsigned char)*s);
+
+      count=0;
+      while (s < stop && count < MPS_TOKENS) {
+        while (s < stop && std::isspace((unsigned char)*s)) s++;
+        if (s==stop) break;
+        token[count]=s;
+        while (s < stop && !std::isspace((unsigned char)*s)) s++;
+        length[count]=s-token[count];
+        count++;
+      }
+      if (count > 0) return true;
+    }
+    return false;
+  }
+
+  std::string text(int i) { return std::string(token[i], length[i]); }
+
+  double number(int i){
+    double value;
+    if (!parse_number(token[i], length[i], value)) fail("bad number "+text(i), line);
+    return value;
+  }
+};
+
+/*=============================================================================
+read_mps - two passes over the mapped file. The first reads ROWS and sizes
+          COLUMNS, counting columns and nonzeros, so the second can fill
+          exactly sized CSC arrays straight from the COLUMNS section, which
+          MPS already groups by column, and then read RHS, RANGES and BOUNDS.
+==============================================================================*/
+Model read_mps(const char* path){
+
+  MappedFile file(path);
+  const char* end=file.data+file.size;
+
+  NameTable rows, columns;
+  std::vector<char> sense;
+  std::vector<std::string> column_names;
+  const char* objective=NULL;
+  int objective_length=0;
+  bool minimize=true;
+
+  int vars=0;
+  long nonzeros=0;
+  const char* columns_start=NULL;
+  int columns_line=0;
+
+  //first pass: rows, column count and nonzero count
+  MpsLines in(file.data, end, 1);
+  MpsSection section=MPS_NONE;
+  const char* current=NULL;
+  int current_length=0;
+
+  while (in.next()) {
+
+    if (in.header) {
+      section=mps_section(in.token[0], in.length[0]);
+      if (section==MPS_NONE) fail("unknown section "+in.text(0), in.line);
+      if (section==MPS_OBJSENSE && in.count > 1) minimize=!same_word(in.token[1], in.length[1], "max") && !same_word(in.token[1], in.length[1], "maximize");
+      if (section==MPS_COLUMNS) { columns_start=in.p; columns_line=in.line+1; }
+      if (section > MPS_COLUMNS) break;
+      continue;
+    }
+
+    switch (section) {
+
+      case MPS_OBJSENSE:
+        minimize=!same_word(in.token[0], in.length[0], "max") && !same_word(in.token[0], in.length[0], "maximize");
+        break;
+
+      case MPS_ROWS: {
+        if (in.count < 2) fail("row needs a type and a name", in.line);
+        if (rows.find(in.token[1], in.length[1])!=-1 ||
+            (objective!=NULL && objective_length==in.length[1] && std::memcmp(objective, in.token[1], objective_length)==0)) fail("duplicate row "+in.text(1), in.line);
+
+        char type=std::toupper((unsigned char)in.token[0][0]);
+        if (type=='N') {
+          if (objective==NULL) { objective=in.token[1]; objective_length=in.length[1]; rows.insert(in.token[1], in.length[1], OBJECTIVE_ROW); }
+          else rows.insert(in.token[1], in.length[1], FREE_ROW);
+        }
+        else if (type=='L' || type=='G' || type=='E') {
+          rows.insert(in.token[1], in.length[1], sense.size());
+          sense.push_back(type);
+        }
+        else fail("unknown row type "+in.text(0), in.line);
+        break;
+      }
+
+      case MPS_COLUMNS: {
+        if (in.count >= 3 && same_word(in.token[1], in.length[1], "'marker'")) break;
+        if (in.count < 3 || in.count%2==0) fail("column entries come in row and value pairs", in.line);
+
+        if (current==NULL || current_length!=in.length[0] || std::memcmp(current, in.token[0], current_length)!=0) {
+          if (columns.find(in.token[0], in.length[0])!=-1) fail("column "+in.text(0)+" is not contiguous", in.line);
+          columns.insert(in.token[0], in.length[0], vars++);
+          column_names.push_back(in.text(0));
+          current=in.token[0];
+          current_length=in.length[0];
+        }
+
+        for (int t = 1; t < in.count; t+=2) {
+          if (objective==NULL || in.length[t]!=objective_length || std::memcmp(in.token[t], objective, objective_length)!=0) nonzeros++;
+        }
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  int m=sense.size();
+  int* col_start=new int[vars+1];
+  int* row_index=new int[nonzeros];
+  double* value=new double[nonzeros];
+  double* rhs=new double[m]();
+  float* cost=new float[vars]();
+
+  std::vector<double> lower(vars, 0), upper(vars, HUGE_VAL);
+  std::vector<double> range(m, NAN);
+  double offset=0;
+
+  //second pass: fill the matrix, then right hand sides, ranges and bounds
+  int j=-1;
+  int e=0;
+  current=NULL;
+
+  try {
+    MpsLines fill(columns_start!=NULL ? columns_start : end, end, columns_line);
+    section=MPS_COLUMNS;
+
+    while (section!=MPS_END && fill.next()) {
+
+      if (fill.header) {
+        section=mps_section(fill.token[0], fill.length[0]);
+        if (section==MPS_NONE) fail("unknown section "+fill.text(0), fill.line);
+        continue;
+      }
+
+      int first, t;
+      switch (section) {
+
+        case MPS_COLUMNS:
+          if (same_word(fill.token[1], fill.length[1], "'marker'")) break;
+
+          if (current==NULL || current_length!=fill.length[0] || std::memcmp(current, fill.token[0], current_length)!=0) {
+            col_start[++j]=e;
+            current=fill.token[0];
+            current_length=fill.length[0];
+          }
+
+          for (t = 1; t < fill.count; t+=2) {
+            int row=rows.find(fill.token[t], fill.length[t]);
+            if (row==-1) fail("unknown row "+fill.text(t), fill.line);
+            double a=fill.number(t+1);
+            if (row==OBJECTIVE_ROW) cost[j]+=a;
+            else if (row >= 0) { row_index[e]=row; value[e++]=a; }
+          }
+          break;
+
+        case MPS_RHS:
+        case MPS_RANGES:
+          //the set name is optional in free format
+          first = fill.count%2;
+          for (t = first; t+1 < fill.count; t+=2) {
+            int row=rows.find(fill.token[t], fill.length[t]);
+            if (row==-1) fail("unknown row "+fill.text(t), fill.line);
+            double v=fill.number(t+1);
+            if (section==MPS_RHS && row==OBJECTIVE_ROW) offset=-v;
+            else if (row >= 0) (section==MPS_RHS ? rhs[row] : range[row])=v;
+          }
+          break;
+
+        case MPS_BOUNDS: {
+          const char* type=fill.token[0];
+          bool valued=!same_word(type, 2, "fr") && !same_word(type, 2, "mi") && !same_word(type, 2, "pl") && !same_word(type, 2, "bv");
+          int name = (fill.count >= (valued ? 4 : 3)) ? 2 : 1;
+          if (fill.count < name+(valued ? 2 : 1) || fill.length[0]!=2) fail("malformed bound", fill.line);
+
+          int col=columns.find(fill.token[name], fill.length[name]);
+          if (col==-1) fail("unknown column "+fill.text(name), fill.line);
+          double v = valued ? fill.number(name+1) : 0;
+
+          if (same_word(type, 2, "up") || same_word(type, 2, "ui")) {
+            upper[col]=v;
+            if (v < 0 && lower[col]==0) lower[col]=-HUGE_VAL;
+          }
+          else if (same_word(type, 2, "lo") || same_word(type, 2, "li")) lower[col]=v;
+          else if (same_word(type, 2, "fx")) lower[col]=upper[col]=v;
+          else if (same_word(type, 2, "fr")) { lower[col]=-HUGE_VAL; upper[col]=HUGE_VAL; }
+          else if (same_word(type, 2, "mi")) lower[col]=-HUGE_VAL;
+          else if (same_word(type, 2, "pl")) upper[col]=HUGE_VAL;
+          else if (same_word(type, 2, "bv")) { lower[col]=0; upper[col]=1; }
+          else fail("unsupported bound type "+fill.text(0), fill.line);
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+  }
+  catch (...) {
+    delete[] col_start; delete[] row_index; delete[] value; delete[] rhs; delete[] cost;
+    throw;
+  }
+
+  col_start[vars]=e;
+
+  return finish_model(vars, m, col_start, row_index, value, rhs, cost, minimize, offset,
+                      lower, upper, sense, range, column_names);
+}
+
+/*=============================================================================
+LP format tokens and sections
+==============================================================================*/
+enum LpToken{ LP_END, LP_NAME, LP_NUMBER, LP_COLON, LP_PLUS, LP_MINUS, LP_LE, LP_GE, LP_EQ, LP_SECTION };
+enum LpSection{ LP_OBJECTIVE, LP_CONSTRAINTS, LP_BOUNDS, LP_GENERAL, LP_BINARY, LP_DONE };
+
+/*=============================================================================
+LpLexer - tokens of a CPLEX LP file. Section keywords are only recognized as
+          the first word of a line. Copying the lexer gives a lookahead.
+==============================================================================*/
+struct LpLexer{
+  const char* p;
+  const char* end;
+  int line;
+  bool line_start;
+
+  LpToken type;
+  const char* text;
+  int length;
+  double number;
+  LpSection section;
+  bool maximize;          // sense of an objective section keyword
+
+  LpLexer(const char* start, const char* stop): p(start), end(stop), line(1), line_start(true) { next(); }
+
+  static bool name_char(char c){
+    return std::isalnum((unsigned char)c) || (c!=0 && std::strchr("!\"#$%&()/,.;?@_`'{}|~[]^", c)!=NULL);
+  }
+
+  //section keyword starting at the current word, possibly two words long
+  bool keyword(){
+    const char* s=text;
+    int n=length;
+    if (same_word(s, n, "maximize") || same_word(s, n, "maximise") || same_word(s, n, "maximum") || same_word(s, n, "max")) { section=LP_OBJECTIVE; maximize=true; return true; }
+    if (same_word(s, n, "minimize") || same_word(s, n, "minimise") || same_word(s, n, "minimum") || same_word(s, n, "min")) { section=LP_OBJECTIVE; maximize=false; return true; }
+    if (same_word(s, n, "st") || same_word(s, n, "s.t.")) { section=LP_CONSTRAINTS; return true; }
+    if (same_word(s, n, "bounds") || same_word(s, n, "bound")) { section=LP_BOUNDS; return true; }
+    if (same_word(s, n, "general") || same_word(s, n, "generals") || same_word(s, n, "gen") ||
+        same_word(s, n, "integer") || same_word(s, n, "integers")) { section=LP_GENERAL; return true; }
+    if (same_word(s, n, "binary") || same_word(s, n, "binaries") || same_word(s, n, "bin")) { section=LP_BINARY; return true; }
+    if (same_word(s, n, "end")) { section=LP_DONE; return true; }
+
+    if (same_word(s, n, "subject") || same_word(s, n, "such")) {
+      const char* q=p;
+      while (q < end && (*q==' ' || *q=='\t')) q++;
+      const char* w=q;
+      while (q < end && name_char(*q)) q++;
+      if (same_word(w, q-w, same_word(s, n, "subject") ? "to" : "that")) {
+        p=q;
+        section=LP_CONSTRAINTS;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void next(){
+
+    //whitespace and \ comments
+    while (p < end) {
+      if (*p=='\n') { line++; line_start=true; p++; }
+      else if (std::isspace((unsigned char)*p)) p++;
+      else if (*p=='\\') { while (p < end && *p!='\n') p++; }
+      else break;
+    }
+
+    bool first=line_start;
+    line_start=false;
+    text=p;
+
+    if (p==end) { type=LP_END; length=0; return; }
+
+    char c=*p;
+
+    if (std::isdigit((unsigned char)c) || (c=='.' && p+1 < end && std::isdigit((unsigned char)p[1]))) {
+      while (p < end && (std::isdigit((unsigned char)*p) || *p=='.')) p++;
+      if (p < end && (*p=='e' || *p=='E')) {
+        const char* q=p+1;
+        if (q < end && (*q=='+' || *q=='-')) q++;
+        if (q < end && std::isdigit((unsigned char)*q)) {
+          p=q;
+          while (p < end && std::isdigit((unsigned char)*p)) p++;
+        }
+      }
+      length=p-text;
+      if (!parse_number(text, length, number)) fail("bad number "+std::string(text, length), line);
+      type=LP_NUMBER;
+      return;
+    }
+
+    p++;
+    length=1;
+    switch (c) {
+      case ':': type=LP_COLON; return;
+      case '+': type=LP_PLUS; return;
+      case '-': type=LP_MINUS; return;
+      case '<': if (p < end && *p=='=') { p++; length++; } type=LP_LE; return;
+      case '>': if (p < end && *p=='=') { p++; length++; } type=LP_GE; return;
+      case '=':
+        type=LP_EQ;
+        if (p < end && *p=='<') { p++; length++; type=LP_LE; }
+        else if (p < end && *p=='>') { p++; length++; type=LP_GE; }
+        return;
+    }
+
+    if (!name_char(c)) fail(std::string("unexpected character ")+c, line);
+    while (p < end && name_char(*p)) p++;
+    length=p-text;
+    type = (first && keyword()) ? LP_SECTION : LP_NAME;
+  }
+
+  bool is_infinity() { return type==LP_NAME && (same_word(text, length, "inf") || same_word(text, length, "infinity")); }
+  std::string word() { return std::string(text, length); }
+};
+
+/*=============================================================================
+LpReader - one pass over an LP file. The counting pass creates columns in
+          order of first appearance and counts each column's nonzeros, the
+          filling pass finds every column again and places its entries in
+          the exactly sized CSC arrays, row by row, so rows stay ordered.
+==============================================================================*/
+struct LpReader{
+  const char* data;
+  const char* end;
+  bool filling;
+
+  NameTable columns;
+  std::vector<std::string> column_names;
+  std::vector<int> counts;            // nonzeros of each column, then its next free entry
+  std::vector<double> lower, upper;
+  std::vector<char> sense;
+  std::vector<double> rhs_values;
+  int rows=0;
+  bool maximize=false;
+  double offset=0;
+
+  int* col_start=NULL;
+  int* row_index=NULL;
+  double* value=NULL;
+  float* cost=NULL;
+
+  LpReader(const char* data, const char* end): data(data), end(end), filling(false) {}
+
+  int column(LpLexer& lex){
+    int j=columns.find(lex.text, lex.length);
+    if (j!=-1) return j;
+    j=column_names.size();
+    columns.insert(lex.text, lex.length, j);
+    column_names.push_back(lex.word());
+    counts.push_back(0);
+    lower.push_back(0);
+    upper.push_back(HUGE_VAL);
+    return j;
+  }
+
+  //skip an optional "name:" label
+  void label(LpLexer& lex){
+    if (lex.type!=LP_NAME) return;
+    LpLexer ahead=lex;
+    ahead.next();
+    if (ahead.type==LP_COLON) { lex=ahead; lex.next(); }
+  }
+
+  //one signed term, col is -1 for a constant. False at anything else.
+  bool term(LpLexer& lex, double& coef, int& col){
+    double sign=1;
+    bool signed_term=false;
+    while (lex.type==LP_PLUS || lex.type==LP_MINUS) {
+      if (lex.type==LP_MINUS) sign=-sign;
+      signed_term=true;
+      lex.next();
+    }
+
+    coef=sign;
+    col=-1;
+    if (lex.type==LP_NUMBER) {
+      coef=sign*lex.number;
+      lex.next();
+      if (lex.type==LP_NAME && !lex.is_infinity()) { col=column(lex); lex.next(); }
+      return true;
+    }
+    if (lex.type==LP_NAME) {
+      col=column(lex);
+      lex.next();
+      return true;
+    }
+    if (signed_term) fail("expected a term after a sign", lex.line);
+    return false;
+  }
+
+  //signed number or infinity, for right hand sides and bounds
+  bool constant(LpLexer& lex, double& v){
+    LpLexer ahead=lex;
+    double sign=1;
+    while (ahead.type==LP_PLUS || ahead.type==LP_MINUS) {
+      if (ahead.type==LP_MINUS) sign=-sign;
+      ahead.next();
+    }
+    if (ahead.type==LP_NUMBER) v=sign*ahead.number;
+    else if (ahead.is_infinity()) v=sign*HUGE_VAL;
+    else return false;
+    ahead.next();
+    lex=ahead;
+    return true;
+  }
+
+  void objective(LpLexer& lex){
+    label(lex);
+    double coef;
+    int col;
+    while (lex.type!=LP_SECTION && lex.type!=LP_END) {
+      if (!term(lex, coef, col)) fail("unexpected "+lex.word()+" in objective", lex.line);
+      if (!filling) continue;
+      if (col==-1) offset+=coef;
+      else cost[col]+=coef;
+    }
+  }
+
+  void constraint(LpLexer& lex){
+    label(lex);
+    double coef, constant_part=0;
+    int col;
+    int row=rows++;
+
+    while (lex.type!=LP_LE && lex.type!=LP_GE && lex.type!=LP_EQ) {
+      if (!term(lex, coef, col)) fail("expected a term or a relation", lex.line);
+      if (col==-1) { constant_part+=coef; continue; }
+      if (!filling) counts[col]++;
+      else {
+        row_index[counts[col]]=row;
+        value[counts[col]++]=coef;
+      }
+    }
+
+    char relation = (lex.type==LP_LE) ? 'L' : (lex.type==LP_GE) ? 'G' : 'E';
+    lex.next();
+
+    double b;
+    if (!constant(lex, b)) fail("expected a right hand side", lex.line);
+    if (filling) {
+      sense[row]=relation;
+      rhs_values[row]=b-constant_part;
+    }
+  }
+
+  void bound(LpLexer& lex){
+    double v, v2;
+    int line=lex.line;
+
+    //value relation name [relation value]
+    if (constant(lex, v)) {
+      LpToken relation=lex.type;
+      if (relation!=LP_LE && relation!=LP_GE && relation!=LP_EQ) fail("expected a relation in bound", line);
+      lex.next();
+      if (lex.type!=LP_NAME) fail("expected a column in bound", line);
+      int col=column(lex);
+      lex.next();
+      set_bound(col, relation==LP_LE ? LP_GE : relation==LP_GE ? LP_LE : LP_EQ, v);
+
+      if (lex.type==LP_LE || lex.type==LP_GE) {
+        LpToken second=lex.type;
+        lex.next();
+        if (!constant(lex, v2)) fail("expected a value in bound", line);
+        set_bound(col, second, v2);
+      }
+      return;
+    }
+
+    //name relation value, or name free
+    if (lex.type!=LP_NAME) fail("expected a bound", line);
+    int col=column(lex);
+    lex.next();
+
+    if (lex.type==LP_NAME && same_word(lex.text, lex.length, "free")) {
+      lex.next();
+      if (filling) { lower[col]=-HUGE_VAL; upper[col]=HUGE_VAL; }
+      return;
+    }
+
+    LpToken relation=lex.type;
+    if (relation!=LP_LE && relation!=LP_GE && relation!=LP_EQ) fail("expected a relation in bound", line);
+    lex.next();
+    if (!constant(lex, v)) fail("expected a value in bound", line);
+    set_bound(col, relation, v);
+  }
+
+  //column relation v
+  void set_bound(int col, LpToken relation, double v){
+    if (!filling) return;
+    if (relation==LP_LE || relation==LP_EQ) upper[col]=v;
+    if (relation==LP_GE || relation==LP_EQ) lower[col]=v;
+  }
+
+  void run(){
+
+    LpLexer lex(data, end);
+    LpSection section=LP_OBJECTIVE;
+    bool started=false;
+    rows=0;
+
+    while (lex.type!=LP_END) {
+
+      if (lex.type==LP_SECTION) {
+        section=lex.section;
+        if (section==LP_OBJECTIVE) maximize=lex.maximize;
+        if (section==LP_DONE) break;
+        started=true;
+        lex.next();
+        continue;
+      }
+      if (!started) fail("expected Maximize or Minimize", lex.line);
+
+      switch (section) {
+        case LP_OBJECTIVE: objective(lex); break;
+        case LP_CONSTRAINTS: constraint(lex); break;
+        case LP_BOUNDS: bound(lex); break;
+        case LP_GENERAL:
+        case LP_BINARY:
+          if (lex.type!=LP_NAME) fail("expected a column name", lex.line);
+          {
+            int col=column(lex);
+            if (filling && section==LP_BINARY) { lower[col]=0; upper[col]=1; }
+          }
+          lex.next();
+          break;
+        default:
+          break;
+      }
+    }
+  }
+};
+
+/*=============================================================================
+read_lp - a counting pass and a filling pass over the mapped file
+==============================================================================*/
+Model read_lp(const char* path){
+
+  MappedFile file(path);
+  LpReader reader(file.data, file.data+file.size);
+
+  reader.run();
+
+  int vars=reader.column_names.size();
+  int m=reader.rows;
+
+  int* col_start=new int[vars+1];
+  col_start[0]=0;
+  for (size_t j = 0; j < vars; j++) {
+    col_start[j+1]=col_start[j]+reader.counts[j];
+    reader.counts[j]=col_start[j];
+  }
+
+  reader.col_start=col_start;
+  reader.row_index=new int[col_start[vars]];
+  reader.value=new double[col_start[vars]];
+  reader.cost=new float[vars]();
+  reader.sense.assign(m, 'L');
+  reader.rhs_values.assign(m, 0);
+  reader.filling=true;
+
+  try {
+    reader.run();
+  }
+  catch (...) {
+    delete[] reader.col_start; delete[] reader.row_index; delete[] reader.value; delete[] reader.cost;
+    throw;
+  }
+
+  double* rhs=new double[m];
+  for (size_t i = 0; i < m; i++) rhs[i]=reader.rhs_values[i];
+
+  return finish_model(vars, m, col_start, reader.row_index, reader.value, rhs, reader.cost,
+                      !reader.maximize, reader.offset, reader.lower, reader.upper,
+                      reader.sense, std::vector<double>(m, NAN), reader.column_names);
+}
+
+/*=============================================================================
+read_model - pick the reader from the file name
+==============================================================================*/
+Model read_model(const char* path){
+
+  size_t n=std::strlen(path);
+  if (n >= 3 && same_word(path+n-3, 3, ".lp")) return read_lp(path);
+  return read_mps(path);
+}
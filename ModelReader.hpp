@@ -0,0 +1,42 @@
+#include <stdexcept>
+#include "SparseLP.hpp"
+
+#ifndef MODELREADER_HPP
+#define MODELREADER_HPP
+
+/*=============================================================================
+Model - an integer program read from a file. The solver maximizes, so the
+        objective of a minimization model is negated in lp, and constant
+        objective terms are kept aside; objective() maps a solution value
+        of lp back onto the model's own objective.
+===============================================================================*/
+struct Model{
+  SparseLP* lp=NULL;      // LP relaxation, every column integer, owned by the caller
+  bool minimize=false;    // the model minimizes, lp maximizes its negation
+  double offset=0;        // constant term of the model's objective
+
+  double objective(float eval) { return (minimize ? -eval : eval)+offset; }
+};
+
+/*=============================================================================
+read_mps - read a free or fixed format MPS file. Fixed format is read by
+          whitespace, so names must not contain spaces. Supports the ROWS,
+          COLUMNS, RHS, RANGES and BOUNDS sections and OBJSENSE, integer
+          markers are accepted and ignored since every column is integer.
+          Throws std::runtime_error naming the line of a malformed entry.
+===============================================================================*/
+Model read_mps(const char* path);
+
+/*=============================================================================
+read_lp - read a CPLEX LP file: objective, Subject To, Bounds, General and
+          Binary sections. Throws std::runtime_error naming the line of a
+          malformed or unsupported entry.
+===============================================================================*/
+Model read_lp(const char* path);
+
+/*=============================================================================
+read_model - read_lp for files ending in .lp, read_mps otherwise
+===============================================================================*/
+Model read_model(const char* path);
+
+#endif
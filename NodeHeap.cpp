@@ -0,0 +1,119 @@
+#include "NodeHeap.hpp"
+
+/*==============================================================
+ NodeHeap Constructor - start with room for a few levels, the
+                       array comes from the node pool
+================================================================*/
+NodeHeap::NodeHeap(bool by_estimate): count(0), capacity(64), by_estimate(by_estimate){
+  nodes=(Node**)node_pool().acquire(capacity*sizeof(Node*));
+}
+
+/*==============================================================
+ NodeHeap Destructor - free the pointer array, nodes are owned
+                       by the search
+================================================================*/
+NodeHeap::~NodeHeap(){
+  node_pool().release(nodes, capacity*sizeof(Node*));
+}
+
+/*===============================================================
+ NodeHeap::sift_up - swap entry with its parent while it has the
+                     larger key
+================================================================*/
+void NodeHeap::sift_up(int i){
+
+  Node* moving=nodes[i];
+  double k=key(moving);
+
+  while (i>0){
+    int parent=(i-1)/HEAP_ARITY;
+    if (key(nodes[parent]) >= k) break;
+    nodes[i]=nodes[parent];
+    i=parent;
+  }
+  nodes[i]=moving;
+}
+
+/*===============================================================
+ NodeHeap::sift_down - swap entry with its largest child while
+                       that child has the larger key
+================================================================*/
+void NodeHeap::sift_down(int i){
+
+  Node* moving=nodes[i];
+  double k=key(moving);
+
+  while (true){
+    int first=i*HEAP_ARITY+1;
+    if (first>=count) break;
+
+    //find largest of up to HEAP_ARITY children
+    int best=first;
+    int last=(first+HEAP_ARITY < count) ? first+HEAP_ARITY : count;
+    for (int c = first+1; c < last; c++) if (key(nodes[c]) > key(nodes[best])) best=c;
+
+    if (key(nodes[best]) <= k) break;
+    nodes[i]=nodes[best];
+    i=best;
+  }
+  nodes[i]=moving;
+}
+
+/*===============================================================
+ NodeHeap::insert - append node and restore heap order, doubling
+                    the array when full
+================================================================*/
+void NodeHeap::insert(Node* n){
+
+  if (count==capacity){
+    Node** grown=(Node**)node_pool().acquire(2*capacity*sizeof(Node*));
+    for (int i = 0; i < count; i++) grown[i]=nodes[i];
+    node_pool().release(nodes, capacity*sizeof(Node*));
+    nodes=grown;
+    capacity*=2;
+  }
+
+  nodes[count]=n;
+  sift_up(count++);
+}
+
+/*===============================================================
+ NodeHeap::top - return pointer to the node with the largest key
+================================================================*/
+Node* NodeHeap::top(){
+  return nodes[0];
+}
+
+/*===============================================================
+ NodeHeap::pop - remove node with the largest key, moving the
+                 last entry into its place
+================================================================*/
+void NodeHeap::pop(){
+  nodes[0]=nodes[--count];
+  if (count>0) sift_down(0);
+}
+
+/*===============================================================
+ NodeHeap::max_weight - largest bound among the open nodes, the
+                        root entry when keyed on bound, otherwise
+                        a scan of the array
+================================================================*/
+double NodeHeap::max_weight(){
+
+  if (count==0) return -FLT_MAX;
+  if (!by_estimate) return nodes[0]->weight;
+
+  double max=-FLT_MAX;
+  for (int i = 0; i < count; i++) if (nodes[i]->weight>max) max=nodes[i]->weight;
+  return max;
+}
+
+/*===============================================================
+ NodeHeap::print - print keys in array order
+================================================================*/
+void NodeHeap::print(){
+
+  std::cout<<std::endl;
+  for (int i = 0; i < count; i++) std::cout<<key(nodes[i])<<", ";
+  std::cout<<std::endl;
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <cfloat>
+#include "Stack.hpp"
+
+#ifndef NODEHEAP_HPP
+#define NODEHEAP_HPP
+
+// children per heap entry, 4 keeps a level within one cache line of pointers
+const int HEAP_ARITY=4;
+
+/*=====================================================================
+NodeHeap - array-backed d-ary max heap of open nodes, keyed either on
+          the node's bound (weight) or on its estimate. Insert and
+          removal are O(log n), the best node is at index 0.
+=======================================================================*/
+class NodeHeap{
+  private:
+    Node** nodes;                 // heap-ordered array of node pointers
+    int count;                    // number of nodes in the heap
+    int capacity;                 // allocated length of nodes
+    bool by_estimate;             // key on Node::estimate instead of Node::weight
+
+    double key(Node* n) { return by_estimate ? n->estimate : n->weight; }
+    void sift_up(int);            // move entry towards the root until ordered
+    void sift_down(int);          // move entry towards the leaves until ordered
+
+  public:
+    NodeHeap(bool by_estimate=false); // Constructor, empty heap with the chosen key
+    ~NodeHeap();                  // Destructor, frees the array but not the nodes
+    void insert(Node*);           // add node, keeping heap order
+    Node* top();                  // pointer to the node with the largest key
+    double top_key() { return key(nodes[0]); } // largest key, the heap must not be empty
+    Node* at(int i) { return nodes[i]; }      // entry i in array order, for walking every node
+    void pop();                   // remove the node with the largest key
+    bool is_empty() { return count==0; }
+    int size() { return count; }
+    double max_weight();          // largest bound in the heap, -FLT_MAX if empty
+    void print();                 // print keys in array order for debugging
+};
+
+#endif
@@ -0,0 +1,311 @@
+#include "NodeStore.hpp"
+#include "BranchAndBound.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*=============================================================================
+SpillRecord - fixed part of a spilled node, followed by its depth branch
+              constraints from the root down, as PackedChange, and the
+              basis_words words of its parent's compressed basis
+===============================================================================*/
+struct SpillRecord{
+  double weight;        // bound inherited from the parent
+  double estimate;      // estimated best integer value below the node
+  float distance;       // how far its branch moves its variable
+  int depth;            // branch constraints from the root
+  long id;              // the node's id
+  long parent_id;       // its parent's id, for traces
+  int basis_words;      // length of the parent's basis, 0 without warm starts
+};
+
+/*=============================================================================
+PackedChange - BoundChange in 16 bytes, the variable complemented for a lower
+               bound
+===============================================================================*/
+struct PackedChange{
+  int var;
+  double bound;
+};
+
+/*=============================================================================
+record_bytes - length of a node's record
+===============================================================================*/
+size_t record_bytes(const Node* n){
+  return sizeof(SpillRecord)+n->depth*sizeof(PackedChange)+n->parent->basis_words*sizeof(unsigned);
+}
+
+/*=============================================================================
+record_length - length of the record at p, 0 if it runs past end
+===============================================================================*/
+size_t record_length(const char* p, const char* end){
+
+  SpillRecord record;
+  if (end-p < (long)sizeof(record)) return 0;
+  memcpy(&record, p, sizeof(record));
+  if (record.depth < 1 || record.basis_words < 0) return 0;
+
+  size_t bytes=sizeof(record)+record.depth*sizeof(PackedChange)+record.basis_words*sizeof(unsigned);
+  return (size_t)(end-p) < bytes ? 0 : bytes;
+}
+
+/*=============================================================================
+write_record - serialize an open node at p, return the end of its record
+===============================================================================*/
+char* write_record(char* p, const Node* n){
+
+  SpillRecord record{n->weight, n->estimate, n->distance, n->depth, n->id, n->parent->id, n->parent->basis_words};
+  memcpy(p, &record, sizeof(record));
+  p+=sizeof(record);
+
+  //constraints up to the first ancestor holding the rest of the path, as in node_lp
+  PackedChange* changes=(PackedChange*)p;
+  const Node* a=n;
+  for (; a->parent!=NULL; a=a->parent) {
+    PackedChange packed{a->change.geq ? ~a->change.var : a->change.var, a->change.bound};
+    memcpy(changes+a->depth-1, &packed, sizeof(packed));
+  }
+  for (int i = 0; i < a->depth && a->path!=NULL; i++) {
+    PackedChange packed{a->path[i].geq ? ~a->path[i].var : a->path[i].var, a->path[i].bound};
+    memcpy(changes+i, &packed, sizeof(packed));
+  }
+  p+=n->depth*sizeof(PackedChange);
+
+  memcpy(p, n->parent->basis_bits, n->parent->basis_words*sizeof(unsigned));
+  return p+n->parent->basis_words*sizeof(unsigned);
+}
+
+/*=============================================================================
+read_record - open node of the record at p, below a stand-in parent that
+              holds the rest of its path and the basis it warm-starts
+              from, and the end of the record. Without keep_basis the
+              node is rebuilt in the root's basis.
+===============================================================================*/
+const char* read_record(const char* p, Node** node, bool keep_basis){
+
+  SpillRecord record;
+  memcpy(&record, p, sizeof(record));
+  p+=sizeof(record);
+
+  BoundChange* path=(BoundChange*)node_pool().acquire(record.depth*sizeof(BoundChange));
+  for (int i = 0; i < record.depth; i++) {
+    PackedChange packed;
+    memcpy(&packed, p+i*sizeof(PackedChange), sizeof(packed));
+    path[i].var = packed.var < 0 ? ~packed.var : packed.var;
+    path[i].bound=packed.bound;
+    path[i].geq = packed.var < 0;
+  }
+  p+=record.depth*sizeof(PackedChange);
+
+  //the stand-in is only referenced by its child
+  Node* parent=new Node{'S', NULL, NULL, record.weight, record.estimate};
+  parent->owns_problem=false;
+  parent->depth=record.depth-1;
+  parent->id=record.parent_id;
+  if (keep_basis && record.basis_words > 0) {
+    parent->basis_words=record.basis_words;
+    parent->basis_bits=(unsigned*)node_pool().acquire(record.basis_words*sizeof(unsigned));
+    memcpy(parent->basis_bits, p, record.basis_words*sizeof(unsigned));
+  }
+  p+=record.basis_words*sizeof(unsigned);
+
+  Node* n=new Node;
+  n->weight=record.weight;
+  n->estimate=record.estimate;
+  n->parent=parent;
+  n->change=path[record.depth-1];
+  n->distance=record.distance;
+  n->depth=record.depth;
+  n->id=record.id;
+
+  //the path above the stand-in stays with it, its own constraint moved to the node
+  if (record.depth > 1) {
+    parent->path=(BoundChange*)node_pool().acquire((record.depth-1)*sizeof(BoundChange));
+    for (int i = 0; i < record.depth-1; i++) parent->path[i]=path[i];
+  }
+  node_pool().release(path, record.depth*sizeof(BoundChange));
+
+  *node=n;
+  return p;
+}
+
+/*=============================================================================
+NodeStore Constructor - create the spill file and unlink it at once, so the
+                        system reclaims it however the process ends. With
+                        no file the store never spills.
+===============================================================================*/
+NodeStore::NodeStore(const char* directory, bool by_estimate): end(0), by_estimate(by_estimate),
+                                                               stored(0), spilled(0), restored(0){
+
+  if (directory==NULL) directory=getenv("TMPDIR");
+  if (directory==NULL) directory="/tmp";
+
+  std::string name=std::string(directory)+"/bbnodes.XXXXXX";
+  fd=mkstemp(&name[0]);
+  if (fd >= 0) unlink(name.c_str());
+  writable = fd >= 0;
+}
+
+NodeStore::~NodeStore(){
+  if (fd >= 0) close(fd);
+}
+
+/*=============================================================================
+NodeStore::best_run - run whose next batch has the largest key
+===============================================================================*/
+int NodeStore::best_run(){
+
+  int best=-1;
+  for (size_t r = 0; r < runs.size(); r++) {
+    if (best==-1 || runs[r].batches[runs[r].next].key > runs[best].batches[runs[best].next].key) best=r;
+  }
+  return best;
+}
+
+double NodeStore::max_key(){
+  int r=best_run();
+  return r==-1 ? -FLT_MAX : runs[r].batches[runs[r].next].key;
+}
+
+double NodeStore::max_weight(){
+
+  double max=-FLT_MAX;
+  for (size_t r = 0; r < runs.size(); r++) max=std::fmax(max, runs[r].batches[runs[r].next].weight);
+  return max;
+}
+
+/*=============================================================================
+NodeStore::spill - empty the heap in key order, put back the best keep nodes
+                   and the root, and append the others to the file as one
+                   run of batches. The written nodes are released, and their
+                   ancestors with them once no other open node needs them.
+                   If a write fails the nodes all go back into the heap and
+                   the store stops spilling, the runs already written are
+                   still read back.
+===============================================================================*/
+bool NodeStore::spill(NodeHeap& heap, int keep){
+
+  if (!writable) return false;
+
+  std::vector<Node*> cold;
+  std::vector<Node*> sorted;
+  while (!heap.is_empty()) { sorted.push_back(heap.top()); heap.pop(); }
+  for (size_t i = 0; i < sorted.size(); i++) {
+    if (i < keep || sorted[i]->parent==NULL) heap.insert(sorted[i]);
+    else cold.push_back(sorted[i]);
+  }
+  if (cold.empty()) return true;
+
+  //largest bound from each node to the end of the run
+  std::vector<double> weight_after(cold.size()+1, -FLT_MAX);
+  for (size_t i = cold.size(); i-- > 0;) weight_after[i]=std::fmax(weight_after[i+1], cold[i]->weight);
+
+  Run run;
+  long offset=end;
+  for (size_t first = 0; first < cold.size(); first+=SPILL_BATCH) {
+    size_t last=std::min(first+SPILL_BATCH, cold.size());
+
+    size_t bytes=0;
+    for (size_t i = first; i < last; i++) bytes+=record_bytes(cold[i]);
+    char* buffer=(char*)node_pool().acquire(bytes);
+    char* p=buffer;
+    for (size_t i = first; i < last; i++) p=write_record(p, cold[i]);
+
+    size_t written=0;
+    while (written < bytes) {
+      ssize_t w=pwrite(fd, buffer+written, bytes-written, offset+written);
+      if (w <= 0) break;
+      written+=w;
+    }
+    node_pool().release(buffer, bytes);
+
+    if (written < bytes) {
+      for (size_t i = 0; i < cold.size(); i++) heap.insert(cold[i]);
+      writable=false;
+      return false;
+    }
+
+    Node* head=cold[first];
+    run.batches.push_back(Batch{offset, bytes, (int)(last-first), by_estimate ? head->estimate : head->weight, weight_after[first]});
+    offset+=bytes;
+  }
+
+  end=offset;
+  runs.push_back(run);
+  stored+=cold.size();
+  spilled+=cold.size();
+  for (size_t i = 0; i < cold.size(); i++) release_node(cold[i]);
+  return true;
+}
+
+/*=============================================================================
+NodeStore::read_bytes - the records of a batch, false if the file fails
+===============================================================================*/
+bool NodeStore::read_bytes(const Batch& batch, char* buffer){
+
+  size_t done=0;
+  while (done < batch.bytes) {
+    ssize_t got=pread(fd, buffer+done, batch.bytes-done, batch.offset+done);
+    if (got <= 0) return false;
+    done+=got;
+  }
+  return true;
+}
+
+/*=============================================================================
+NodeStore::restore - read the best run's next batch back into the heap,
+                     dropping the run once it is read and truncating the
+                     file once every run is
+===============================================================================*/
+void NodeStore::restore(NodeHeap& heap){
+
+  int r=best_run();
+  if (r==-1) return;
+  Batch batch=runs[r].batches[runs[r].next++];
+  if (runs[r].next==runs[r].batches.size()) runs.erase(runs.begin()+r);
+
+  char* buffer=(char*)node_pool().acquire(batch.bytes);
+  if (!read_bytes(batch, buffer)) {
+    node_pool().release(buffer, batch.bytes);
+    throw std::runtime_error("cannot read back spilled nodes");
+  }
+
+  const char* p=buffer;
+  for (int i = 0; i < batch.count; i++) {
+    Node* n;
+    p=read_record(p, &n, true);
+    heap.insert(n);
+  }
+  node_pool().release(buffer, batch.bytes);
+
+  stored-=batch.count;
+  restored+=batch.count;
+  if (runs.empty() && fd >= 0 && ftruncate(fd, 0)==0) end=0;
+}
+
+/*=============================================================================
+NodeStore::copy_records - append the unread records of every run to a buffer
+===============================================================================*/
+void NodeStore::copy_records(std::vector<char>& out){
+
+  for (size_t r = 0; r < runs.size(); r++) {
+    for (size_t b = runs[r].next; b < runs[r].batches.size(); b++) {
+      const Batch& batch=runs[r].batches[b];
+      size_t at=out.size();
+      out.resize(at+batch.bytes);
+      if (!read_bytes(batch, &out[at])) throw std::runtime_error("cannot read back spilled nodes");
+    }
+  }
+}
+
+/*=============================================================================
+NodeStore::clear - forget every run, the stored nodes hold no memory
+===============================================================================*/
+void NodeStore::clear(){
+  runs.clear();
+  stored=0;
+  if (fd >= 0 && ftruncate(fd, 0)==0) end=0;
+}
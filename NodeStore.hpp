@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <vector>
+#include "NodeHeap.hpp"
+
+#ifndef NODESTORE_HPP
+#define NODESTORE_HPP
+
+// nodes read back from the spill file at a time
+const int SPILL_BATCH=256;
+
+/*=====================================================================
+NodeStore - open nodes spilled out of memory into an unlinked file on
+           local disk. Each spill writes the coldest nodes of the heap
+           as one run, sorted by the heap's key, in self-contained
+           records holding the node's bound, estimate and id, every
+           branch constraint from the root and its parent's compressed
+           basis, so the spilled nodes release their ancestors. Runs are
+           indexed in memory in batches of SPILL_BATCH records, and the
+           best run's next batch is read back into the heap as soon as
+           its key beats the heap's. Restored nodes hang off a stand-in
+           parent holding the path and basis. The file only grows and
+           is truncated once every run has been read back.
+=======================================================================*/
+class NodeStore{
+  private:
+    struct Batch{
+      long offset;        // byte offset of its first record
+      size_t bytes;       // length of its records
+      int count;          // records in the batch
+      double key;         // key of its first record, the largest of the rest of the run
+      double weight;      // largest bound of this batch and every later one
+    };
+    struct Run{
+      std::vector<Batch> batches;
+      size_t next=0;      // first batch not yet read back
+    };
+
+    int fd;               // spill file, -1 if it could not be created
+    bool writable;        // false once a write to the file failed
+    long end;             // bytes written since the last truncation
+    bool by_estimate;     // runs are sorted on Node::estimate instead of Node::weight
+    std::vector<Run> runs;  // runs with batches left to read
+    long stored;          // nodes in the file, not yet read back
+    long spilled;         // nodes written over the store's life
+    long restored;        // nodes read back over the store's life
+
+    int best_run();       // run whose next batch has the largest key, -1 if none
+    bool read_bytes(const Batch&, char*);  // the batch's records, false if the file fails
+
+  public:
+    NodeStore(const char* directory, bool by_estimate);  // Constructor, creates the file in directory, $TMPDIR or /tmp if NULL
+    ~NodeStore();         // Destructor, closes the file, returning its space
+    bool is_empty() { return stored==0; }
+    long size() { return stored; }
+    long get_spilled() { return spilled; }
+    long get_restored() { return restored; }
+    double max_key();     // key of the best stored node, -FLT_MAX if empty
+    double max_weight();  // largest bound of the stored nodes, -FLT_MAX if empty
+    bool spill(NodeHeap&, int keep);  // write all but the best keep nodes as a new run, false if the file failed
+    void restore(NodeHeap&);          // read the best run's next batch into the heap
+    void clear();         // drop every stored node unread
+    void copy_records(std::vector<char>&);  // append the records of every stored node
+};
+
+/*=============================================================================
+record_bytes, write_record, read_record - the self-contained record of an
+              open node below the root, as spilled and checkpointed
+===============================================================================*/
+size_t record_bytes(const Node*);
+size_t record_length(const char*, const char* end);      // length of a written record, 0 if it runs past end
+char* write_record(char*, const Node*);                   // returns the end of the record
+const char* read_record(const char*, Node**, bool keep_basis);  // new open node, returns the end of the record
+
+#endif
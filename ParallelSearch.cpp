@@ -0,0 +1,370 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include "BranchAndBound.hpp"
+#include "WorkStealingDeque.hpp"
+#include "Checkpoint.hpp"
+
+//***************************************
+// Parallel tree search, either free-running
+// workers on work-stealing deques or
+// reproducible synchronized rounds
+//***************************************
+
+/*=============================================================================
+SharedIncumbent - best integer node found by any worker. Workers read the
+                  value lock-free for pruning, improvements are published
+                  under the lock so value, node and the heuristics' guide
+                  stay consistent.
+===============================================================================*/
+struct SharedIncumbent{
+  std::atomic<bool> found{false};
+  std::atomic<double> value{-FLT_MAX};
+  std::mutex lock;
+  Node* best=NULL;
+
+  //keep the node if it improves on the current incumbent, recycling whichever loses
+  void offer(Node* n, SearchContext& ctx){
+    Node* loser=n;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!found.load(std::memory_order_relaxed) || n->weight > value.load(std::memory_order_relaxed)){
+        loser=best;
+        best=n;
+        value.store(n->weight, std::memory_order_relaxed);
+        found.store(true, std::memory_order_release);
+        ctx.set_guide(n->problem->get_sol());
+      }
+    }
+    if (loser!=NULL) release_node(loser);
+  }
+};
+
+/*=============================================================================
+work_stealing_search - each worker searches its own deque depth first and
+                      steals from a random victim when it runs dry. A node is
+                      outstanding from the moment it is pushed until it has
+                      been expanded, once nothing is outstanding every deque
+                      is empty and every worker is idle, and the search ends.
+                      A limit stops every worker after its current node, the
+                      nodes left in the deques give the bound.
+===============================================================================*/
+static Node* work_stealing_search(LinearProgram* root_tab, SearchContext& ctx){
+
+  int threads=ctx.settings.threads;
+  WorkStealingDeque* deques=new WorkStealingDeque[threads];
+  std::atomic<long> outstanding(1);
+  SharedIncumbent incumbent;
+
+  deques[0].push(root_node(root_tab));
+  ctx.note_open(1);
+
+  auto worker=[&](int id){
+
+    unsigned int seed=2654435761u*(id+1);
+    Node* children[2];
+    Node* found;
+
+    while (outstanding.load(std::memory_order_acquire) > 0 && !ctx.over_limit()){
+
+      //own work first, newest node, then steal the oldest node of another worker
+      Node* curr;
+      {
+        PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+        curr=deques[id].pop();
+        if (curr==NULL && threads > 1){
+          seed^=seed<<13; seed^=seed>>17; seed^=seed<<5;
+          int start=seed%threads;
+          for (int k = 0; k < threads && curr==NULL; k++){
+            int victim=(start+k)%threads;
+            if (victim!=id) curr=deques[victim].steal();
+          }
+        }
+      }
+      if (curr==NULL){
+        std::this_thread::yield();
+        continue;
+      }
+
+      bool has_incumbent=incumbent.found.load(std::memory_order_acquire);
+      double value=incumbent.value.load(std::memory_order_relaxed);
+
+      NodeStatus status=expand_node(curr, has_incumbent, value, ctx, children, &found);
+      if (found!=NULL) incumbent.offer(found, ctx);
+
+      switch (status){
+
+        case NODE_INTEGRAL:
+          incumbent.offer(curr, ctx);
+          break;
+
+        // children become outstanding before this node stops being outstanding
+        case NODE_BRANCHED:
+          ctx.note_open(outstanding.fetch_add(2, std::memory_order_relaxed)+2);
+          {
+            PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+            deques[id].push(children[0]);
+            deques[id].push(children[1]);
+          }
+          release_node(curr);
+          break;
+
+        default:
+          release_node(curr);
+          break;
+      }
+
+      outstanding.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int id = 1; id < threads; id++) pool.emplace_back(worker, id);
+  worker(0);
+  for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+
+  //the workers are gone, what a limit left open is drained from any deque
+  double open_bound=-FLT_MAX;
+  for (int id = 0; id < threads; id++) {
+    for (Node* n = deques[id].pop(); n!=NULL; n=deques[id].pop()) {
+      open_bound=std::fmax(open_bound, n->weight);
+      release_node(n);
+    }
+  }
+  ctx.set_bound(open_bound, incumbent.found.load(), incumbent.value.load());
+
+  delete[] deques;
+  return incumbent.best;
+}
+
+/*=============================================================================
+RoundPool - fixed set of threads that run one job per round, the calling
+            thread takes part as worker 0 and returns when all are done
+===============================================================================*/
+class RoundPool{
+  private:
+    int threads;
+    std::vector<std::thread> pool;
+    std::mutex lock;
+    std::condition_variable start, done;
+    long generation=0;
+    int remaining=0;
+    bool stopping=false;
+    std::function<void(int)> job;
+
+    void serve(int id){
+      long seen=0;
+      while (true){
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          start.wait(guard, [&]{ return stopping || generation!=seen; });
+          if (stopping) return;
+          seen=generation;
+        }
+        job(id);
+        std::lock_guard<std::mutex> guard(lock);
+        if (--remaining==0) done.notify_one();
+      }
+    }
+
+  public:
+    RoundPool(int threads): threads(threads){
+      for (int id = 1; id < threads; id++) pool.emplace_back(&RoundPool::serve, this, id);
+    }
+
+    ~RoundPool(){
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping=true;
+      }
+      start.notify_all();
+      for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+    }
+
+    //run job(id) for every worker id and wait for all of them
+    void run(std::function<void(int)> round_job){
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        job=round_job;
+        remaining=threads-1;
+        generation++;
+      }
+      start.notify_all();
+      job(0);
+      std::unique_lock<std::mutex> guard(lock);
+      done.wait(guard, [&]{ return remaining==0; });
+    }
+};
+
+/*=============================================================================
+BatchSolver Constructor - start the workers, the caller's thread is the first
+===============================================================================*/
+BatchSolver::BatchSolver(int threads): threads(threads){
+  if (this->threads <= 0) this->threads=std::max(1u, std::thread::hardware_concurrency());
+  pool=new RoundPool(this->threads);
+}
+
+BatchSolver::~BatchSolver(){
+  delete pool;
+}
+
+/*=============================================================================
+BatchSolver::solve - every worker claims the next problem off a shared index
+                     and solves it serially, writing its own result slot
+===============================================================================*/
+std::vector<OptimalSolution*> BatchSolver::solve(const std::vector<LinearProgram*>& problems, SearchSettings settings){
+
+  settings.threads=1;
+  settings.stats=NULL;
+  settings.trace=NULL;
+
+  std::vector<OptimalSolution*> results(problems.size(), NULL);
+  std::atomic<size_t> next(0);
+
+  pool->run([&](int){
+    for (size_t i = next.fetch_add(1); i < problems.size(); i = next.fetch_add(1)){
+      results[i]=branch_and_bound(problems[i], settings);
+    }
+  });
+
+  return results;
+}
+
+/*=============================================================================
+solve_batch - one batch on a BatchSolver of the given number of threads
+===============================================================================*/
+std::vector<OptimalSolution*> solve_batch(const std::vector<LinearProgram*>& problems, int threads, SearchSettings settings){
+  BatchSolver solver(threads);
+  return solver.solve(problems, settings);
+}
+
+/*=============================================================================
+deterministic_search - each round pops up to one node per thread in the
+                      order of the serial search, expands them in parallel
+                      against the incumbent from the start of the round, then
+                      applies the results in pop order. Thread timing never
+                      affects which nodes are expanded, so runs repeat exactly.
+                      Checkpoints are taken and limits checked between
+                      rounds. Node limits keep runs repeatable, time and
+                      memory limits do not.
+===============================================================================*/
+static Node* deterministic_search(LinearProgram* root_tab, SearchContext& ctx){
+
+  int threads=ctx.settings.threads;
+  Node** batch=new Node*[threads];
+  Node** children=new Node*[2*threads];
+  Node** found=new Node*[threads];
+  NodeStatus* status=new NodeStatus[threads];
+
+  CheckpointWriter checkpoints(ctx.settings);
+  OpenNodes next_up(ctx.settings);
+  Node* best=NULL;
+  if (!resume_search(next_up, ctx, &best)) {
+    next_up.push(root_node(root_tab));
+    ctx.note_open(1);
+  }
+  long next_id=ctx.next_id.load();
+
+  RoundPool pool(threads);
+  bool has_incumbent = best!=NULL;
+  double incumbent = best!=NULL ? best->weight : -FLT_MAX;
+
+  while (!next_up.is_empty()){
+
+    //stop once no open node can improve on the incumbent by more than the gap
+    if (has_incumbent && ctx.within_gap(next_up.max_weight(), incumbent)) break;
+    if (ctx.over_limit()) break;
+
+    int count=0;
+    {
+      PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+      while (count < threads && !next_up.is_empty()) batch[count++]=next_up.pop();
+    }
+
+    pool.run([&](int id){
+      for (int i = id; i < count; i+=threads){
+        status[i]=expand_node(batch[i], has_incumbent, incumbent, ctx, children+2*i, found+i);
+      }
+    });
+
+    //pseudocosts learnt this round only steer the next one
+    ctx.pseudocosts.commit();
+
+    for (int i = 0; i < count; i++){
+      if (found[i]!=NULL){
+        if (!has_incumbent || found[i]->weight > incumbent){
+          if (best!=NULL) release_node(best);
+          best=found[i];
+          incumbent=best->weight;
+          has_incumbent=true;
+          next_up.incumbent_found();
+          ctx.set_guide(best->problem->get_sol());
+        }
+        else release_node(found[i]);
+      }
+      if (status[i]==NODE_INTEGRAL && (!has_incumbent || batch[i]->weight > incumbent)){
+        if (best!=NULL) release_node(best);
+        best=batch[i];
+        incumbent=best->weight;
+        has_incumbent=true;
+        next_up.incumbent_found();
+        ctx.set_guide(best->problem->get_sol());
+        continue;
+      }
+      if (status[i]==NODE_BRANCHED){
+        //renumber the children in pop order so traces repeat too
+        children[2*i]->id=next_id++;
+        children[2*i+1]->id=next_id++;
+        {
+          PROFILE_SCOPE(ctx.phase_ns, PHASE_QUEUE);
+          next_up.push(children[2*i]);
+          next_up.push(children[2*i+1]);
+        }
+        ctx.note_open(next_up.size);
+      }
+      release_node(batch[i]);
+    }
+
+    if (checkpoints.due()) checkpoints.write(snapshot_search(next_up, ctx, best, next_id));
+  }
+
+  if (ctx.stopped() && !ctx.unbounded() && checkpoints.enabled()) checkpoints.finish(snapshot_search(next_up, ctx, best, next_id));
+  else checkpoints.finish();
+  ctx.set_bound(next_up.max_weight(), has_incumbent, incumbent);
+  next_up.clear();
+  next_up.report(ctx);
+
+  delete[] batch;
+  delete[] children;
+  delete[] found;
+  delete[] status;
+  return best;
+}
+
+/*=============================================================================
+parallel_branch_and_bound - branch_and_bound on settings.threads workers,
+                            called by branch_and_bound when threads > 1
+===============================================================================*/
+OptimalSolution* parallel_branch_and_bound(LinearProgram* root_tab, const SearchSettings& settings){
+
+  SearchContext ctx(root_tab, settings);
+
+  Node* best = settings.deterministic ? deterministic_search(root_tab, ctx)
+                                      : work_stealing_search(root_tab, ctx);
+  ctx.report_stats();
+
+  //If there are no integer-feasible solutions to the problem, or no optimal one, return NULL for UI-level handling
+  if (best==NULL) return NULL;
+  if (ctx.unbounded()) {
+    release_node(best);
+    return NULL;
+  }
+
+  //the incumbent's LP goes back to the pool, the caller owns a copy of its solution
+  OptimalSolution* result=copy_solution(best->problem->get_sol(), root_tab->get_vars());
+  release_node(best);
+  return result;
+}
@@ -0,0 +1,199 @@
+#include "Pool.hpp"
+#include <cstdlib>
+#include <new>
+
+/*=============================================================================
+size_class - smallest class whose blocks hold the requested bytes
+==============================================================================*/
+static int size_class(size_t bytes){
+  int k=0;
+  while ((POOL_MIN_BLOCK<<k) < bytes) k++;
+  if (k>=POOL_CLASSES) throw std::bad_alloc();
+  return k;
+}
+
+/*==============================================================
+ SlabPool Constructor - no slabs until the first request
+================================================================*/
+SlabPool::SlabPool(): slabs(NULL), in_use(0), reserved(0) {}
+
+/*==============================================================
+ SlabPool Destructor - return every slab to the system
+================================================================*/
+SlabPool::~SlabPool(){
+  while (slabs!=NULL){
+    Slab* next=slabs->next;
+    std::free(slabs);
+    slabs=next;
+  }
+}
+
+/*===============================================================
+ SlabPool::refill - request a slab, at least one block plus its
+                    header line, and push its blocks on the
+                    class's free list. Called with the class lock.
+================================================================*/
+void SlabPool::refill(int k){
+
+  size_t block=POOL_MIN_BLOCK<<k;
+  size_t bytes=(block+POOL_MIN_BLOCK > POOL_SLAB_BYTES) ? block+POOL_MIN_BLOCK : POOL_SLAB_BYTES;
+
+  char* slab=(char*)std::aligned_alloc(POOL_MIN_BLOCK, bytes);
+  if (slab==NULL) throw std::bad_alloc();
+  reserved.fetch_add(bytes, std::memory_order_relaxed);
+
+  {
+    std::lock_guard<std::mutex> guard(slab_lock);
+    ((Slab*)slab)->next=slabs;
+    slabs=(Slab*)slab;
+  }
+
+  //first line holds the slab header, the rest is carved into blocks
+  for (size_t offset = POOL_MIN_BLOCK; offset+block <= bytes; offset+=block){
+    FreeBlock* b=(FreeBlock*)(slab+offset);
+    b->next=classes[k].free;
+    classes[k].free=b;
+  }
+}
+
+/*=============================================================================
+cache_limit - blocks of a class a thread cache holds before spilling, at
+              least two so a block released and acquired in turn stays local
+==============================================================================*/
+static int cache_limit(int k){
+  size_t blocks=POOL_CACHE_BYTES/(POOL_MIN_BLOCK<<k);
+  return blocks < 2 ? 2 : (int)blocks;
+}
+
+/*==============================================================
+ ThreadCache - free blocks one thread has taken from a pool,
+               handed back when the thread exits
+================================================================*/
+struct SlabPool::ThreadCache{
+  SlabPool* owner=NULL;               // pool the blocks belong to, the first one used
+  FreeBlock* free[POOL_CLASSES]={};   // cached blocks per class
+  int count[POOL_CLASSES]={};         // length of each list
+
+  ~ThreadCache(){
+    if (owner==NULL) return;
+    for (int k = 0; k < POOL_CLASSES; k++) owner->spill(*this, k, 0);
+  }
+};
+
+static thread_local SlabPool::ThreadCache thread_cache;
+
+/*===============================================================
+ SlabPool::local_cache - the calling thread's cache, claimed by
+                         the first pool it is used with
+================================================================*/
+SlabPool::ThreadCache* SlabPool::local_cache(){
+  if (thread_cache.owner==NULL) thread_cache.owner=this;
+  return thread_cache.owner==this ? &thread_cache : NULL;
+}
+
+/*===============================================================
+ SlabPool::fetch - move half a cache of blocks of one class from
+                   the shared list, refilling it if empty
+================================================================*/
+void SlabPool::fetch(ThreadCache& cache, int k){
+
+  std::lock_guard<std::mutex> guard(classes[k].lock);
+
+  int wanted=cache_limit(k)/2;
+  int moved=0;
+  while (moved < wanted){
+    if (classes[k].free==NULL){
+      if (moved > 0) break;
+      refill(k);
+    }
+    FreeBlock* b=classes[k].free;
+    classes[k].free=b->next;
+    b->next=cache.free[k];
+    cache.free[k]=b;
+    moved++;
+  }
+  cache.count[k]+=moved;
+  in_use.fetch_add(moved*(POOL_MIN_BLOCK<<k), std::memory_order_relaxed);
+}
+
+/*===============================================================
+ SlabPool::spill - move cached blocks of one class back to the
+                   shared list until keep remain
+================================================================*/
+void SlabPool::spill(ThreadCache& cache, int k, int keep){
+
+  if (cache.count[k] <= keep) return;
+
+  std::lock_guard<std::mutex> guard(classes[k].lock);
+
+  int moved=0;
+  while (cache.count[k] > keep){
+    FreeBlock* b=cache.free[k];
+    cache.free[k]=b->next;
+    b->next=classes[k].free;
+    classes[k].free=b;
+    cache.count[k]--;
+    moved++;
+  }
+  in_use.fetch_sub(moved*(POOL_MIN_BLOCK<<k), std::memory_order_relaxed);
+}
+
+/*===============================================================
+ SlabPool::acquire - pop a block of the matching size class from
+                     the thread's cache, or the shared list when
+                     the thread caches another pool
+================================================================*/
+void* SlabPool::acquire(size_t bytes){
+
+  int k=size_class(bytes);
+  ThreadCache* cache=local_cache();
+
+  if (cache==NULL){
+    std::lock_guard<std::mutex> guard(classes[k].lock);
+    if (classes[k].free==NULL) refill(k);
+    FreeBlock* b=classes[k].free;
+    classes[k].free=b->next;
+    in_use.fetch_add(POOL_MIN_BLOCK<<k, std::memory_order_relaxed);
+    return b;
+  }
+
+  if (cache->free[k]==NULL) fetch(*cache, k);
+
+  FreeBlock* b=cache->free[k];
+  cache->free[k]=b->next;
+  cache->count[k]--;
+  return b;
+}
+
+/*===============================================================
+ SlabPool::release - push a block on the thread's cache, handing
+                     half of it back once it is full
+================================================================*/
+void SlabPool::release(void* p, size_t bytes){
+
+  if (p==NULL) return;
+
+  int k=size_class(bytes);
+  FreeBlock* b=(FreeBlock*)p;
+  ThreadCache* cache=local_cache();
+
+  if (cache==NULL){
+    std::lock_guard<std::mutex> guard(classes[k].lock);
+    b->next=classes[k].free;
+    classes[k].free=b;
+    in_use.fetch_sub(POOL_MIN_BLOCK<<k, std::memory_order_relaxed);
+    return;
+  }
+
+  b->next=cache->free[k];
+  cache->free[k]=b;
+  if (++cache->count[k] > cache_limit(k)) spill(*cache, k, cache_limit(k)/2);
+}
+
+/*===============================================================
+ node_pool - the process-wide pool, built on first use
+================================================================*/
+SlabPool& node_pool(){
+  static SlabPool pool;
+  return pool;
+}
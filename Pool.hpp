@@ -0,0 +1,70 @@
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+// smallest block handed out, one cache line
+const size_t POOL_MIN_BLOCK=64;
+
+// size classes, block sizes POOL_MIN_BLOCK<<0 up to POOL_MIN_BLOCK<<(POOL_CLASSES-1)
+const int POOL_CLASSES=40;
+
+// bytes requested from the system at a time for small blocks
+const size_t POOL_SLAB_BYTES=1<<16;
+
+// bytes of free blocks each thread keeps per size class before handing half back
+const size_t POOL_CACHE_BYTES=1<<16;
+
+/*=====================================================================
+SlabPool - recycling allocator for nodes and tableaus. Blocks are
+          rounded up to power-of-two size classes, carved out of large
+          cache-line aligned slabs and kept on a free list per class
+          once released, so a search in steady state never calls the
+          system allocator. Slabs are only returned at destruction.
+          Each thread keeps a small cache of free blocks per class in
+          front of the shared lists and only takes a class's lock to
+          move half a cache at a time, so threads recycling their own
+          blocks do not contend. Cached blocks count as in use.
+=======================================================================*/
+class SlabPool{
+  private:
+    struct FreeBlock{ FreeBlock* next; };
+    struct SizeClass{
+      std::mutex lock;            // guards free
+      FreeBlock* free=NULL;       // released blocks of this class
+    };
+    struct Slab{ Slab* next; };   // header at the start of each slab
+
+    SizeClass classes[POOL_CLASSES];
+    std::mutex slab_lock;         // guards slabs
+    Slab* slabs;                  // every slab requested from the system
+    std::atomic<size_t> in_use;   // bytes of blocks handed out or in thread caches
+    std::atomic<size_t> reserved; // bytes of slabs requested from the system
+
+    void refill(int size_class);  // carve a new slab into blocks of a class
+
+  public:
+    struct ThreadCache;           // one thread's free blocks, defined in Pool.cpp
+
+  private:
+    ThreadCache* local_cache();   // this thread's cache, NULL if it belongs to another pool
+    void fetch(ThreadCache&, int size_class);   // move free blocks from the shared list into the cache
+    void spill(ThreadCache&, int size_class, int keep); // move cached blocks back until keep remain
+
+  public:
+    SlabPool();                   // Constructor, empty pool
+    ~SlabPool();                  // Destructor, returns every slab
+    void* acquire(size_t);        // block of at least the given bytes, 64 byte aligned
+    void release(void*, size_t);  // return a block, with the size it was acquired with
+    size_t bytes_in_use() { return in_use.load(std::memory_order_relaxed); }
+    size_t bytes_reserved() { return reserved.load(std::memory_order_relaxed); }
+};
+
+/*=====================================================================
+node_pool - the process-wide pool shared by every search and thread
+=======================================================================*/
+SlabPool& node_pool();
+
+#endif
@@ -0,0 +1,525 @@
+#include "Presolve.hpp"
+#include <cfloat>
+
+// feasibility slack of row sides and of bounds before rounding, relative to magnitude
+const double PRESOLVE_TOL=1e-6;
+
+// rounds of reductions before presolve stops, each one only runs if the last changed something
+const int PRESOLVE_PASSES=20;
+
+// implied bounds beyond this are left alone, they would not survive the float LP
+const double PRESOLVE_MAX_BOUND=1e7;
+
+/*=============================================================================
+tolerance - PRESOLVE_TOL scaled to a value's magnitude
+==============================================================================*/
+static double tolerance(double value){
+  return PRESOLVE_TOL*std::fmax(1.0, std::fabs(value));
+}
+
+/*=============================================================================
+round_down, round_up - integer bound from an implied real one, forgiving
+                      round-off just past an integer
+==============================================================================*/
+static double round_down(double value){ return std::floor(value+tolerance(value)); }
+static double round_up(double value){ return std::ceil(value-tolerance(value)); }
+
+/*=============================================================================
+to_float - bound for the LP engines, which mark infinite ones with FLT_MAX
+==============================================================================*/
+static float to_float(double bound){
+  if (bound >= HUGE_VAL) return FLT_MAX;
+  if (bound <= -HUGE_VAL) return -FLT_MAX;
+  return bound;
+}
+
+/*=============================================================================
+Presolver Constructor - rows a.x <= rhs, columns in [0, inf), nothing reduced
+==============================================================================*/
+Presolver::Presolver( float* obj,             // coefficients of objective function
+                      int var_count,          // number of decision variables in LP
+                      float** constraints,    // 2-D array of constraint arrays, each of length var_count+1
+                      int constraint_count):  // number of independent constraints
+                      vars(var_count), rows(constraint_count), offset(0), infeasible(false){
+
+  cost.assign(obj, obj+vars);
+  lower.assign(vars, 0);
+  upper.assign(vars, HUGE_VAL);
+  fixed.assign(vars, false);
+  col_rows.resize(vars);
+
+  row_cols.resize(rows);
+  row_coefs.resize(rows);
+  rhs.resize(rows);
+  row_lower.assign(rows, -HUGE_VAL);
+  row_upper.resize(rows);
+  row_removed.assign(rows, false);
+
+  for (size_t i = 0; i < rows; i++) {
+    for (size_t j = 0; j < vars; j++) {
+      if (constraints[i][j]==0) continue;
+      row_cols[i].push_back(j);
+      row_coefs[i].push_back(constraints[i][j]);
+      col_rows[j].push_back(i);
+    }
+    rhs[i]=constraints[i][vars];
+    row_upper[i]=rhs[i];
+  }
+
+  for (size_t j = 0; j < vars; j++) kept_cols.push_back(j);
+  for (size_t i = 0; i < rows; i++) kept_rows.push_back(i);
+}
+
+/*=============================================================================
+Presolver::set_bounds - bounds of a column, or of the slack of row j-vars,
+                        which reads a.x + s = rhs so bounds its activity
+==============================================================================*/
+void Presolver::set_bounds(int j, float new_lower, float new_upper){
+
+  double lo = new_lower <= -FLT_MAX ? -HUGE_VAL : new_lower;
+  double up = new_upper >= FLT_MAX ? HUGE_VAL : new_upper;
+
+  if (j < vars) {
+    lower[j]=lo;
+    upper[j]=up;
+    return;
+  }
+
+  int i=j-vars;
+  row_lower[i]=rhs[i]-up;
+  row_upper[i]=rhs[i]-lo;
+}
+
+/*=============================================================================
+Presolver::activity - smallest and largest activity of a row over the column
+                      bounds, as the sum of the finite terms and the count of
+                      terms that are infinite
+==============================================================================*/
+void Presolver::activity(int i, double& min_sum, int& min_inf, double& max_sum, int& max_inf){
+
+  min_sum=max_sum=0;
+  min_inf=max_inf=0;
+
+  for (size_t k = 0; k < row_cols[i].size(); k++) {
+    int j=row_cols[i][k];
+    double a=row_coefs[i][k];
+    double low = a > 0 ? a*lower[j] : a*upper[j];
+    double high = a > 0 ? a*upper[j] : a*lower[j];
+    if (std::isinf(low)) min_inf++; else min_sum+=low;
+    if (std::isinf(high)) max_inf++; else max_sum+=high;
+  }
+}
+
+/*=============================================================================
+Presolver::fix - hold a column at a value, moving its terms into the row
+                 sides and its objective term into the offset
+==============================================================================*/
+void Presolver::fix(int j, double value){
+
+  lower[j]=upper[j]=value;
+  fixed[j]=true;
+  offset+=cost[j]*value;
+  stats.columns_fixed++;
+
+  for (size_t r = 0; r < col_rows[j].size(); r++) {
+    int i=col_rows[j][r];
+    for (size_t k = 0; k < row_cols[i].size(); k++) {
+      if (row_cols[i][k]!=j) continue;
+      double shift=row_coefs[i][k]*value;
+      row_lower[i]-=shift;
+      row_upper[i]-=shift;
+      row_cols[i].erase(row_cols[i].begin()+k);
+      row_coefs[i].erase(row_coefs[i].begin()+k);
+      break;
+    }
+  }
+}
+
+/*=============================================================================
+Presolver::remove_row - drop a row whose sides can no longer be violated
+==============================================================================*/
+void Presolver::remove_row(int i){
+  row_removed[i]=true;
+  row_cols[i].clear();
+  row_coefs[i].clear();
+  stats.rows_removed++;
+}
+
+/*=============================================================================
+Presolver::drop_rows - rows without columns must hold on their own, singleton
+                       rows become bounds of their column, and sides the
+                       activity range cannot reach are dropped, along with
+                       the row once both are gone. A range entirely outside
+                       the sides proves the problem infeasible.
+==============================================================================*/
+bool Presolver::drop_rows(){
+
+  bool changed=false;
+
+  for (size_t i = 0; i < rows && !infeasible; i++) {
+    if (row_removed[i]) continue;
+
+    double min_sum, max_sum;
+    int min_inf, max_inf;
+    activity(i, min_sum, min_inf, max_sum, max_inf);
+    double min_act = min_inf ? -HUGE_VAL : min_sum;
+    double max_act = max_inf ? HUGE_VAL : max_sum;
+
+    if (min_act > row_upper[i]+tolerance(row_upper[i]) || max_act < row_lower[i]-tolerance(row_lower[i])) {
+      infeasible=true;
+      break;
+    }
+
+    //a single column: a*x within the sides bounds x itself
+    if (row_cols[i].size()==1) {
+      int j=row_cols[i][0];
+      double a=row_coefs[i][0];
+      double lo = a > 0 ? row_lower[i]/a : row_upper[i]/a;
+      double up = a > 0 ? row_upper[i]/a : row_lower[i]/a;
+      if (!std::isinf(lo) && round_up(lo) > lower[j]) lower[j]=round_up(lo);
+      if (!std::isinf(up) && round_down(up) < upper[j]) upper[j]=round_down(up);
+      if (lower[j] > upper[j]) {
+        infeasible=true;
+        break;
+      }
+      remove_row(i);
+      changed=true;
+      continue;
+    }
+
+    //sides the activity can never reach are dropped
+    if (!std::isinf(row_lower[i]) && min_act >= row_lower[i]-tolerance(row_lower[i])) {
+      row_lower[i]=-HUGE_VAL;
+      changed=true;
+    }
+    if (!std::isinf(row_upper[i]) && max_act <= row_upper[i]+tolerance(row_upper[i])) {
+      row_upper[i]=HUGE_VAL;
+      changed=true;
+    }
+    if (std::isinf(row_lower[i]) && std::isinf(row_upper[i])) remove_row(i);
+  }
+
+  return changed;
+}
+
+/*=============================================================================
+Presolver::tighten_bounds - each side of a row bounds every one of its
+                            columns by what the other columns leave over,
+                            rounded inwards to integers. The row's
+                            activity is refreshed after every tightening.
+==============================================================================*/
+bool Presolver::tighten_bounds(){
+
+  bool changed=false;
+
+  for (size_t i = 0; i < rows && !infeasible; i++) {
+    if (row_removed[i]) continue;
+
+    double min_sum, max_sum;
+    int min_inf, max_inf;
+    activity(i, min_sum, min_inf, max_sum, max_inf);
+
+    for (size_t k = 0; k < row_cols[i].size(); k++) {
+      int j=row_cols[i][k];
+      double a=row_coefs[i][k];
+      double low = a > 0 ? a*lower[j] : a*upper[j];
+      double high = a > 0 ? a*upper[j] : a*lower[j];
+
+      //least and most the other columns can contribute, infinite if another term is
+      double others_min = std::isinf(low) ? (min_inf==1 ? min_sum : -HUGE_VAL) : (min_inf ? -HUGE_VAL : min_sum-low);
+      double others_max = std::isinf(high) ? (max_inf==1 ? max_sum : HUGE_VAL) : (max_inf ? HUGE_VAL : max_sum-high);
+
+      //a*x <= row_upper-others_min and a*x >= row_lower-others_max
+      double from_upper=(row_upper[i]-others_min)/a;
+      double from_lower=(row_lower[i]-others_max)/a;
+      double lo = a > 0 ? from_lower : from_upper;
+      double up = a > 0 ? from_upper : from_lower;
+
+      bool tightened=false;
+      if (!std::isnan(lo) && std::fabs(lo) < PRESOLVE_MAX_BOUND && round_up(lo) > lower[j]) {
+        lower[j]=round_up(lo);
+        tightened=true;
+      }
+      if (!std::isnan(up) && std::fabs(up) < PRESOLVE_MAX_BOUND && round_down(up) < upper[j]) {
+        upper[j]=round_down(up);
+        tightened=true;
+      }
+      if (!tightened) continue;
+
+      if (lower[j] > upper[j]) {
+        infeasible=true;
+        break;
+      }
+      stats.bounds_tightened++;
+      changed=true;
+      activity(i, min_sum, min_inf, max_sum, max_inf);
+    }
+  }
+
+  return changed;
+}
+
+/*=============================================================================
+Presolver::tighten_coefficients - in a row with one side, written as
+                                  a.x <= b, a column of width one whose
+                                  smaller contribution already satisfies
+                                  the row gets its coefficient and b
+                                  reduced by the slack d that leaves, which
+                                  cuts off fractional points without losing
+                                  integer ones:
+                                    a_j > 0: a_j -= d, b -= d*upper_j
+                                    a_j < 0: a_j += d, b += d*lower_j
+                                  Rows of integer coefficients also get b
+                                  rounded down to a multiple of their gcd.
+==============================================================================*/
+bool Presolver::tighten_coefficients(){
+
+  bool changed=false;
+
+  for (size_t i = 0; i < rows; i++) {
+    if (row_removed[i] || row_cols[i].empty()) continue;
+    if (std::isinf(row_lower[i])==std::isinf(row_upper[i])) continue;
+
+    //the >= side is handled as the <= side of the negated row
+    double sign = std::isinf(row_lower[i]) ? 1 : -1;
+    double b = sign > 0 ? row_upper[i] : -row_lower[i];
+
+    double min_sum, max_sum;
+    int min_inf, max_inf;
+
+    for (size_t k = 0; k < row_cols[i].size(); k++) {
+      int j=row_cols[i][k];
+      double a=sign*row_coefs[i][k];
+      if (upper[j]-lower[j]!=1) continue;
+
+      activity(i, min_sum, min_inf, max_sum, max_inf);
+      if ((sign > 0 ? max_inf : min_inf)!=0) break;
+      double max_act = sign > 0 ? max_sum : -min_sum;
+
+      //with the column at its other bound the row's largest activity is max_act-|a|
+      double rest=max_act-std::fabs(a);
+      if (max_act <= b+tolerance(b) || rest >= b-tolerance(b)) continue;
+
+      double d=b-rest;
+      if (a > 0) {
+        a-=d;
+        b-=d*upper[j];
+      }
+      else {
+        a+=d;
+        b+=d*lower[j];
+      }
+      row_coefs[i][k]=sign*a;
+      if (sign > 0) row_upper[i]=b;
+      else row_lower[i]=-b;
+      stats.coefficients_tightened++;
+      changed=true;
+    }
+
+    //integer coefficients with gcd g only reach multiples of g
+    long g=0;
+    for (size_t k = 0; k < row_coefs[i].size(); k++) {
+      double a=std::fabs(row_coefs[i][k]);
+      if (a!=std::round(a) || a > PRESOLVE_MAX_BOUND) {
+        g=0;
+        break;
+      }
+      long x=(long)a;
+      while (x!=0) { long t=g%x; g=x; x=t; }
+    }
+    if (g==0 || std::fabs(b) > PRESOLVE_MAX_BOUND) continue;
+
+    double rounded=g*round_down(b/g);
+    if (rounded < b) {
+      if (sign > 0) row_upper[i]=rounded;
+      else row_lower[i]=-rounded;
+      stats.coefficients_tightened++;
+      changed=true;
+    }
+  }
+
+  return changed;
+}
+
+/*=============================================================================
+Presolver::fix_columns - columns with equal bounds are substituted out. A
+                         column no row stops from moving down (no row
+                         side it pushes towards as it decreases) and
+                         whose cost does not reward it is fixed at its
+                         lower bound, and the mirror case at its upper
+                         bound; empty columns are the simplest case.
+==============================================================================*/
+bool Presolver::fix_columns(){
+
+  std::vector<int> down_locks(vars, 0), up_locks(vars, 0);
+
+  for (size_t i = 0; i < rows; i++) {
+    if (row_removed[i]) continue;
+    bool has_lower=!std::isinf(row_lower[i]);
+    bool has_upper=!std::isinf(row_upper[i]);
+    for (size_t k = 0; k < row_cols[i].size(); k++) {
+      int j=row_cols[i][k];
+      bool positive = row_coefs[i][k] > 0;
+      if (positive ? has_lower : has_upper) down_locks[j]++;
+      if (positive ? has_upper : has_lower) up_locks[j]++;
+    }
+  }
+
+  bool changed=false;
+
+  for (size_t j = 0; j < vars; j++) {
+    if (fixed[j]) continue;
+
+    if (lower[j]==upper[j]) fix(j, lower[j]);
+    else if (down_locks[j]==0 && cost[j] <= 0 && !std::isinf(lower[j])) fix(j, lower[j]);
+    else if (up_locks[j]==0 && cost[j] >= 0 && !std::isinf(upper[j])) fix(j, upper[j]);
+    else continue;
+
+    changed=true;
+  }
+
+  return changed;
+}
+
+/*=============================================================================
+Presolver::presolve - round the column bounds onto the integers and run the
+                      reductions until a pass changes nothing, then number
+                      the columns and rows that are left
+==============================================================================*/
+bool Presolver::presolve(){
+
+  for (size_t j = 0; j < vars; j++) {
+    if (!std::isinf(lower[j])) lower[j]=round_up(lower[j]);
+    if (!std::isinf(upper[j])) upper[j]=round_down(upper[j]);
+    if (lower[j] > upper[j]) infeasible=true;
+  }
+
+  for (int pass = 0; pass < PRESOLVE_PASSES && !infeasible; pass++) {
+    bool changed=drop_rows();
+    if (!infeasible) changed|=tighten_bounds();
+    if (!infeasible) changed|=tighten_coefficients();
+    if (!infeasible) changed|=fix_columns();
+    if (!changed) break;
+  }
+
+  //rows left without columns by the last fixes must still hold
+  if (!infeasible) drop_rows();
+
+  kept_cols.clear();
+  kept_rows.clear();
+  for (size_t j = 0; j < vars; j++) if (!fixed[j]) kept_cols.push_back(j);
+  for (size_t i = 0; i < rows; i++) if (!row_removed[i]) kept_rows.push_back(i);
+
+  return !infeasible;
+}
+
+/*=============================================================================
+Presolver::build - root LP of the reduced problem, NULL if every column was
+                   fixed. Rows with an upper side are written a.x <= upper,
+                   rows with only a lower side are negated, and a row's
+                   range becomes the width of its slack.
+==============================================================================*/
+LinearProgram* Presolver::build(bool sparse){
+
+  int n=kept_cols.size();
+  int m=kept_rows.size();
+  if (n==0) return NULL;
+
+  std::vector<int> reduced_index(vars, -1);
+  for (size_t k = 0; k < n; k++) reduced_index[kept_cols[k]]=k;
+
+  float* obj=new float[n];
+  for (size_t k = 0; k < n; k++) obj[k]=cost[kept_cols[k]];
+
+  float* b=new float[m];
+  std::vector<double> sign(m), width(m);
+  for (size_t r = 0; r < m; r++) {
+    int i=kept_rows[r];
+    sign[r] = std::isinf(row_upper[i]) ? -1 : 1;
+    b[r] = sign[r] > 0 ? row_upper[i] : -row_lower[i];
+    width[r]=row_upper[i]-row_lower[i];
+  }
+
+  LinearProgram* lp;
+  if (sparse) {
+    //CSC by reduced column
+    int* starts=new int[n+1]();
+    for (size_t r = 0; r < m; r++) {
+      int i=kept_rows[r];
+      for (size_t k = 0; k < row_cols[i].size(); k++) starts[reduced_index[row_cols[i][k]]+1]++;
+    }
+    for (size_t k = 0; k < n; k++) starts[k+1]+=starts[k];
+
+    int* rows_of=new int[starts[n]];
+    float* values=new float[starts[n]];
+    int* fill=new int[n];
+    for (size_t k = 0; k < n; k++) fill[k]=starts[k];
+    for (size_t r = 0; r < m; r++) {
+      int i=kept_rows[r];
+      for (size_t k = 0; k < row_cols[i].size(); k++) {
+        int c=reduced_index[row_cols[i][k]];
+        rows_of[fill[c]]=r;
+        values[fill[c]++]=sign[r]*row_coefs[i][k];
+      }
+    }
+
+    SparseLP* sparse_lp=new SparseLP(obj, n, m, starts, rows_of, values, b);
+    for (size_t k = 0; k < n; k++) {
+      int j=kept_cols[k];
+      if (lower[j]!=0 || !std::isinf(upper[j])) sparse_lp->set_bounds(k, to_float(lower[j]), to_float(upper[j]));
+    }
+    for (size_t r = 0; r < m; r++) if (!std::isinf(width[r])) sparse_lp->set_bounds(n+r, 0, width[r]);
+    lp=sparse_lp;
+
+    delete[] starts;
+    delete[] rows_of;
+    delete[] values;
+    delete[] fill;
+  }
+  else {
+    float** cons=new float*[m];
+    for (size_t r = 0; r < m; r++) {
+      int i=kept_rows[r];
+      cons[r]=new float[n+1]();
+      for (size_t k = 0; k < row_cols[i].size(); k++) cons[r][reduced_index[row_cols[i][k]]]=sign[r]*row_coefs[i][k];
+      cons[r][n]=b[r];
+    }
+
+    Tableau* tab=new Tableau(obj, n, cons, m);
+    for (size_t k = 0; k < n; k++) {
+      int j=kept_cols[k];
+      if (lower[j]!=0 || !std::isinf(upper[j])) tab->set_bounds(k, to_float(lower[j]), to_float(upper[j]));
+    }
+    for (size_t r = 0; r < m; r++) if (!std::isinf(width[r])) tab->set_bounds(n+r, 0, width[r]);
+    lp=tab;
+
+    for (size_t r = 0; r < m; r++) delete[] cons[r];
+    delete[] cons;
+  }
+
+  delete[] obj;
+  delete[] b;
+  return lp;
+}
+
+/*=============================================================================
+Presolver::postsolve - solution in the original columns: the reduced
+                       solution's values for the columns that were kept and
+                       the fixed values for the others, evaluated on the
+                       original objective. reduced may be NULL when every
+                       column was fixed.
+==============================================================================*/
+OptimalSolution* Presolver::postsolve(OptimalSolution* reduced){
+
+  OptimalSolution* result=new OptimalSolution;
+  result->args=new double[vars];
+
+  for (size_t j = 0; j < vars; j++) result->args[j]=lower[j];
+  if (reduced!=NULL) for (size_t k = 0; k < kept_cols.size(); k++) result->args[kept_cols[k]]=reduced->args[k];
+
+  double eval=0;
+  for (size_t j = 0; j < vars; j++) eval+=cost[j]*result->args[j];
+  result->eval=eval;
+
+  return result;
+}
@@ -0,0 +1,77 @@
+#include <vector>
+#include "Tableau.hpp"
+#include "SparseLP.hpp"
+
+#ifndef PRESOLVE_HPP
+#define PRESOLVE_HPP
+
+/*=============================================================================
+PresolveStats - reductions made by Presolver::presolve
+===============================================================================*/
+struct PresolveStats{
+  int rows_removed=0;         // empty, singleton and redundant rows dropped
+  int columns_fixed=0;        // columns fixed at a bound and substituted out
+  int bounds_tightened=0;     // column bounds tightened from row activities
+  int coefficients_tightened=0; // row coefficients and sides tightened
+};
+
+/*=============================================================================
+Presolver - reduces a pure integer program before its root LP is built.
+            Takes the same arrays as the Tableau constructor, every row
+            a.x <= rhs and every column in [0, inf) unless set_bounds
+            changes it, columns from var_count on being the slacks of the
+            rows. presolve() works on row activity ranges: it drops empty
+            and redundant rows, turns singleton rows into bounds, tightens
+            bounds from row activities rounded to integers, tightens
+            coefficients and sides of one-sided rows, and fixes empty and
+            dominated columns at the bound the objective prefers. Removed
+            columns are only ever fixed, so postsolve() fills them back in
+            at their values.
+===============================================================================*/
+class Presolver{
+  private:
+    int vars, rows;                         // original dimensions
+    std::vector<double> cost;               // objective coefficient of each column
+    std::vector<double> lower, upper;       // bounds of each column, +-HUGE_VAL if none
+    std::vector<bool> fixed;                // column substituted out at lower==upper
+    std::vector<std::vector<int> > row_cols;      // columns of each row's nonzeros
+    std::vector<std::vector<double> > row_coefs;  // each row's nonzeros
+    std::vector<double> rhs;                // right hand side each row was given with
+    std::vector<double> row_lower, row_upper;     // range of each row's activity
+    std::vector<bool> row_removed;          // row dropped as redundant
+    std::vector<std::vector<int> > col_rows;      // rows each column started out in
+    std::vector<int> kept_cols, kept_rows;  // original index of each reduced column and row
+    double offset;                          // objective value of the fixed columns
+    bool infeasible;                        // a reduction proved there is no integer solution
+    PresolveStats stats;
+
+    void activity(int, double&, int&, double&, int&); // finite parts and infinite term counts of a row's activity range
+    void fix(int, double);                  // fix a column and move it into the row sides
+    void remove_row(int);
+    bool drop_rows();                       // empty, singleton and redundant rows
+    bool tighten_bounds();                  // implied column bounds
+    bool tighten_coefficients();            // one-sided rows with bounded integer columns
+    bool fix_columns();                     // fixed, empty and dominated columns
+
+  public:
+    Presolver(float*, int, float**, int);   // Constructor, same arguments as the Tableau constructor
+
+    /*          args:   float* obj,               // coefficients of objective function
+                        int var_count,            // number of decision variables in LP
+                        float** constraints,      // 2-D array of constraint arrays, each of length var_count+1
+                        int constraint_count):    // number of independent constraints
+    */
+
+    void set_bounds(int, float, float);     // bounds of a column or, from var_count on, a row's slack
+    bool presolve();                        // reduce until nothing changes, false if infeasible
+    LinearProgram* build(bool sparse=false);  // reduced root LP, a Tableau or a SparseLP, owned by the caller
+    OptimalSolution* postsolve(OptimalSolution*); // caller-owned solution of the original problem
+
+    // Accessors
+    int get_vars() { return kept_cols.size(); } // reduced count of columns
+    int get_rows() { return kept_rows.size(); } // reduced count of rows
+    double get_offset() { return offset; }      // objective value of the fixed columns
+    const PresolveStats& get_stats() { return stats; }
+};
+
+#endif
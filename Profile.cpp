@@ -0,0 +1,61 @@
+#include "Profile.hpp"
+
+/*=============================================================================
+phase_name - lower case name of a phase, for reports
+===============================================================================*/
+const char* phase_name(ProfilePhase phase){
+
+  switch (phase){
+    case PHASE_BUILD:      return "build";
+    case PHASE_SIMPLEX:    return "simplex";
+    case PHASE_FIND_FLOAT: return "find_float";
+    case PHASE_QUEUE:      return "queue";
+    case PHASE_CUTS:       return "cuts";
+    case PHASE_HEURISTICS: return "heuristics";
+    default:               return "unknown";
+  }
+}
+
+/*=============================================================================
+Histogram::quantile - walk the buckets until q of the samples are covered
+                      and return the upper end of that bucket
+===============================================================================*/
+long Histogram::quantile(double q) const{
+
+  if (count==0) return 0;
+
+  long wanted=(long)(q*count);
+  if (wanted < 1) wanted=1;
+
+  long seen=0;
+  for (int b = 0; b < HISTOGRAM_BUCKETS; b++){
+    seen+=buckets[b];
+    if (seen >= wanted) return b==0 ? 0 : (1L<<b)-1;
+  }
+  return (1L<<(HISTOGRAM_BUCKETS-1))-1;
+}
+
+/*=============================================================================
+SharedHistogram::add - record one sample in the bucket of its highest bit
+===============================================================================*/
+void SharedHistogram::add(long sample){
+
+  if (sample < 0) sample=0;
+
+  int b = sample==0 ? 0 : 64-__builtin_clzl((unsigned long)sample);
+  if (b >= HISTOGRAM_BUCKETS) b=HISTOGRAM_BUCKETS-1;
+
+  count.fetch_add(1, std::memory_order_relaxed);
+  total.fetch_add(sample, std::memory_order_relaxed);
+  buckets[b].fetch_add(1, std::memory_order_relaxed);
+}
+
+/*=============================================================================
+SharedHistogram::copy_to - snapshot of the counts, once the workers are done
+===============================================================================*/
+void SharedHistogram::copy_to(Histogram& out) const{
+
+  out.count=count.load();
+  out.total=total.load();
+  for (int b = 0; b < HISTOGRAM_BUCKETS; b++) out.buckets[b]=buckets[b].load();
+}
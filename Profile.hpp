@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+// phase timers and histograms are on unless built with -DBB_NO_PROFILE
+#ifndef BB_NO_PROFILE
+#define BB_PROFILE
+#endif
+
+// power-of-two buckets, enough for nanosecond latencies of several minutes
+const int HISTOGRAM_BUCKETS=48;
+
+/*=============================================================================
+ProfilePhase - parts of a node's processing that are timed separately
+===============================================================================*/
+enum ProfilePhase{
+  PHASE_BUILD,        // rebuilding the node's LP from the root
+  PHASE_SIMPLEX,      // simplex() on the node's LP
+  PHASE_FIND_FLOAT,   // picking the branching variable
+  PHASE_QUEUE,        // pushing and popping open nodes
+  PHASE_CUTS,         // cut rounds at the root and at shallow nodes
+  PHASE_HEURISTICS,   // primal heuristics at the root and in the tree
+  PHASE_COUNT
+};
+
+/*=============================================================================
+phase_name - lower case name of a phase, for reports
+===============================================================================*/
+const char* phase_name(ProfilePhase);
+
+/*=============================================================================
+Histogram - counts of non-negative samples in power-of-two buckets, bucket b
+            holding the samples in [2^(b-1), 2^b), bucket 0 the zeros.
+            Quantiles are only resolved to the upper end of their bucket.
+===============================================================================*/
+struct Histogram{
+  long count=0;                       // samples recorded
+  long total=0;                       // sum of the samples
+  long buckets[HISTOGRAM_BUCKETS]={}; // samples per bucket
+
+  double mean() const { return count==0 ? 0 : (double)total/count; }
+  long quantile(double q) const;      // upper end of the bucket holding the q-th sample
+};
+
+/*=============================================================================
+SharedHistogram - Histogram that any number of workers add to at once
+===============================================================================*/
+struct SharedHistogram{
+  std::atomic<long> count{0}, total{0};
+  std::atomic<long> buckets[HISTOGRAM_BUCKETS]{};
+
+  void add(long sample);
+  void copy_to(Histogram&) const;
+};
+
+/*=============================================================================
+PhaseTimer - adds the nanoseconds between its construction and destruction
+             to a histogram, for timing one scope
+===============================================================================*/
+struct PhaseTimer{
+  SharedHistogram& histogram;
+  std::chrono::steady_clock::time_point start;
+
+  PhaseTimer(SharedHistogram& histogram): histogram(histogram), start(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer() {
+    histogram.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
+  }
+};
+
+/*=============================================================================
+PROFILE_SCOPE, PROFILE_SAMPLE - time the rest of the enclosing scope into
+                                 histograms[phase], or record one sample.
+                                 Both vanish when built with BB_NO_PROFILE.
+===============================================================================*/
+#ifdef BB_PROFILE
+#define PROFILE_SCOPE(histograms, phase) PhaseTimer phase_timer_##phase((histograms)[phase])
+#define PROFILE_SAMPLE(histogram, sample) (histogram).add(sample)
+#else
+#define PROFILE_SCOPE(histograms, phase) ((void)0)
+#define PROFILE_SAMPLE(histogram, sample) ((void)0)
+#endif
+
+#endif
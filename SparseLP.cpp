@@ -0,0 +1,690 @@
+#include "SparseLP.hpp"
+#include <cstring>
+#include <cfloat>
+
+//***************************************
+// Bounded revised simplex on a sparse
+// matrix, maximizing obj.x by minimizing
+// -obj.x over the columns [A I]
+//***************************************
+
+// smallest reduced cost the dual phase starts each column with, scaled per column
+const double DUAL_PERTURBATION=1e-6;
+
+// product-form updates between refactorizations of the basis
+const int REFACTOR_INTERVAL=64;
+
+// primal iterations in a row leaving the objective unchanged before Bland's rule takes over
+const int DEGENERATE_LIMIT=50;
+
+// primal iterations per column of [A I] after which a solve is given up
+const int PRIMAL_ITERATIONS_PER_COLUMN=50;
+
+/*=============================================================================
+SparseLP::allocate - take one pooled block for the per-LP arrays: solution
+                    arguments, bounds, values, reduced costs and scratch by
+                    column and by row, basis positions and bound flags
+==============================================================================*/
+void SparseLP::allocate(){
+
+  size_t args_at=0;
+  size_t lower_at=args_at+vars*sizeof(double);
+  size_t upper_at=lower_at+cols*sizeof(double);
+  size_t x_at=upper_at+cols*sizeof(double);
+  size_t d_at=x_at+cols*sizeof(double);
+  size_t shift_at=d_at+cols*sizeof(double);
+  size_t alpha_at=shift_at+cols*sizeof(double);
+  size_t column_at=alpha_at+cols*sizeof(double);
+  size_t duals_at=column_at+m*sizeof(double);
+  size_t work_at=duals_at+m*sizeof(double);
+  size_t head_at=work_at+m*sizeof(double);
+  size_t position_at=head_at+m*sizeof(int);
+  size_t upper_flag_at=position_at+cols*sizeof(int);
+  block_bytes=upper_flag_at+cols*sizeof(bool);
+
+  char* block=(char*)node_pool().acquire(block_bytes);
+
+  solution.args=(double*)(block+args_at);
+  lower=(double*)(block+lower_at);
+  upper=(double*)(block+upper_at);
+  x=(double*)(block+x_at);
+  d=(double*)(block+d_at);
+  shift=(double*)(block+shift_at);
+  row_alpha=(double*)(block+alpha_at);
+  column=(double*)(block+column_at);
+  duals=(double*)(block+duals_at);
+  work=(double*)(block+work_at);
+  head=(int*)(block+head_at);
+  position=(int*)(block+position_at);
+  at_upper=(bool*)(block+upper_flag_at);
+
+  for (size_t j = 0; j < cols; j++) {
+    shift[j]=0;
+    x[j]=0;
+  }
+
+  feasible=true;
+  unbounded=false;
+  status=false;
+  factored=false;
+  sol=NULL;
+}
+
+/*=============================================================================
+SparseLP::new/delete - SparseLP objects come from the pool like Tableaus
+==============================================================================*/
+void* SparseLP::operator new(size_t bytes){
+  return node_pool().acquire(bytes);
+}
+
+void SparseLP::operator delete(void* p, size_t bytes){
+  node_pool().release(p, bytes);
+}
+
+/*=============================================================================
+SparseLP::load_csc - own a copy of the matrix and right hand side
+==============================================================================*/
+void SparseLP::load_csc(const int* starts, const int* rows, const float* values, const float* b){
+
+  int nonzeros=starts[vars];
+
+  col_start=new int[vars+1];
+  row_index=new int[nonzeros];
+  value=new double[nonzeros];
+  rhs=new double[m];
+
+  for (size_t j = 0; j <= vars; j++) col_start[j]=starts[j];
+  for (size_t e = 0; e < nonzeros; e++) {
+    row_index[e]=rows[e];
+    value[e]=values[e];
+  }
+  for (size_t i = 0; i < m; i++) rhs[i]=b[i];
+
+  start();
+}
+
+/*=============================================================================
+SparseLP::start - own the matrix, every column starts with bounds [0, inf)
+                  in the slack basis
+==============================================================================*/
+void SparseLP::start(){
+
+  owns_matrix=true;
+  allocate();
+
+  for (size_t j = 0; j < cols; j++) {
+    lower[j]=0;
+    upper[j]=HUGE_VAL;
+  }
+
+  slack_basis();
+}
+
+/*================================================================
+SparseLP::Constructor - LP of the dense Tableau arrays, keeping only
+                        their nonzeros
+================================================================*/
+SparseLP::SparseLP( float* obj,             // coefficients of objective function
+                    int var_count,          // number of decision variables in LP
+                    float** constraints,    // 2-D array of constraint arrays, each of length var_count+1
+                    int constraint_count):  // number of independent constraints
+                    m(constraint_count), vars(var_count), cols(var_count+constraint_count){
+
+  cost=new float[vars];
+  for (size_t j = 0; j < vars; j++) cost[j]=obj[j];
+
+  int* starts=new int[vars+1];
+  starts[0]=0;
+  for (size_t j = 0; j < vars; j++) {
+    starts[j+1]=starts[j];
+    for (size_t i = 0; i < m; i++) if (constraints[i][j]!=0) starts[j+1]++;
+  }
+
+  int* rows=new int[starts[vars]];
+  float* values=new float[starts[vars]];
+  float* b=new float[m];
+  for (size_t j = 0; j < vars; j++) {
+    int e=starts[j];
+    for (size_t i = 0; i < m; i++) {
+      if (constraints[i][j]==0) continue;
+      rows[e]=i;
+      values[e++]=constraints[i][j];
+    }
+  }
+  for (size_t i = 0; i < m; i++) b[i]=constraints[i][vars];
+
+  load_csc(starts, rows, values, b);
+
+  delete[] starts;
+  delete[] rows;
+  delete[] values;
+  delete[] b;
+}
+
+/*================================================================
+SparseLP::Constructor - LP of a compressed sparse column matrix
+================================================================*/
+SparseLP::SparseLP( float* obj,             // coefficients of objective function
+                    int var_count,          // number of decision variables in LP
+                    int constraint_count,   // number of rows
+                    const int* starts,      // var_count+1 offsets into rows and values
+                    const int* rows,        // row of each nonzero, by column
+                    const float* values,    // each nonzero
+                    const float* b):        // right hand side of each row
+                    m(constraint_count), vars(var_count), cols(var_count+constraint_count){
+
+  cost=new float[vars];
+  for (size_t j = 0; j < vars; j++) cost[j]=obj[j];
+
+  load_csc(starts, rows, values, b);
+}
+
+/*================================================================
+SparseLP::Constructor - LP adopting arrays built by a model reader,
+                        which were allocated with new[] and are
+                        freed with this LP
+================================================================*/
+SparseLP::SparseLP( int var_count,          // number of decision variables in LP
+                    int constraint_count,   // number of rows
+                    int* starts,            // var_count+1 offsets into rows and values
+                    int* rows,              // row of each nonzero, by column
+                    double* values,         // each nonzero
+                    double* b,              // right hand side of each row
+                    float* obj):            // coefficients of objective function
+                    m(constraint_count), vars(var_count), cols(var_count+constraint_count),
+                    col_start(starts), row_index(rows), value(values), rhs(b), cost(obj){
+  start();
+}
+
+/*=========================================================================
+SparseLP::Constructor - LP of a tree node, sharing the root's matrix. The
+                        root's bounds are tightened by the node's branch
+                        constraints and the node starts from the parent's
+                        compressed basis when given, or the root's optimal
+                        basis if that one cannot be factored.
+==========================================================================*/
+SparseLP::SparseLP( SparseLP& root,                // solved root LP
+                    const BoundChange* changes,    // branch constraints from the root down to this node
+                    int count,                     // number of branch constraints
+                    const unsigned* basis_bits ):  // parent's optimal basis from compress_basis, or NULL
+                    m(root.m), vars(root.vars), cols(root.cols){
+
+  col_start=root.col_start;
+  row_index=root.row_index;
+  value=root.value;
+  rhs=root.rhs;
+  cost=root.cost;
+  owns_matrix=false;
+  tolerances=root.tolerances;
+
+  allocate();
+
+  std::memcpy(lower, root.lower, cols*sizeof(double));
+  std::memcpy(upper, root.upper, cols*sizeof(double));
+  std::memcpy(head, root.head, m*sizeof(int));
+  std::memcpy(position, root.position, cols*sizeof(int));
+  std::memcpy(at_upper, root.at_upper, cols*sizeof(bool));
+
+  //Apply branch constraints as bound changes
+  for (size_t k = 0; k < count; k++) {
+    int var=changes[k].var;
+    if (changes[k].geq) set_bounds(var, std::fmax(lower[var], changes[k].bound), upper[var]);
+    else set_bounds(var, lower[var], std::fmin(upper[var], changes[k].bound));
+  }
+
+  if (basis_bits==NULL) return;
+
+  int words=basis_words()/2;
+  auto bit=[&](int word_offset, int col){
+    return (basis_bits[word_offset+col/32]>>(col%32))&1u;
+  };
+
+  int basic=0;
+  for (size_t j = 0; j < cols; j++) basic+=bit(0, j);
+  if (basic!=m) return;
+
+  //parent's basis, nonbasic columns at the parent's bound wherever it is finite
+  int p=0;
+  for (size_t j = 0; j < cols; j++) {
+    if (bit(0, j)) {
+      head[p]=j;
+      position[j]=p++;
+      continue;
+    }
+    position[j]=-1;
+    at_upper[j]=bit(words, j) ? upper[j] < HUGE_VAL : lower[j] <= -HUGE_VAL;
+  }
+
+  if (refactor()) return;
+
+  //fall back to the root basis
+  std::memcpy(head, root.head, m*sizeof(int));
+  std::memcpy(position, root.position, cols*sizeof(int));
+  for (size_t j = 0; j < cols; j++) {
+    at_upper[j]=root.at_upper[j];
+    if (at_upper[j] && upper[j] >= HUGE_VAL) at_upper[j]=false;
+    if (!at_upper[j] && lower[j] <= -HUGE_VAL) at_upper[j]=true;
+  }
+  factored=false;
+}
+
+/*=========================================================================
+SparseLP::Destructor - return the arrays to the pool, and free the matrix
+                      if this LP owns it
+=========================================================================*/
+SparseLP::~SparseLP(){
+
+  node_pool().release(solution.args, block_bytes);
+
+  if (owns_matrix) {
+    delete[] col_start;
+    delete[] row_index;
+    delete[] value;
+    delete[] rhs;
+    delete[] cost;
+  }
+}
+
+/*=========================================================================
+SparseLP::rebuild - LP of a tree node below this root
+==========================================================================*/
+LinearProgram* SparseLP::rebuild(const BoundChange* changes, int count, const unsigned* basis_bits){
+  return new SparseLP(*this, changes, count, basis_bits);
+}
+
+/*=========================================================================
+SparseLP::slack_basis - every slack basic and every other column at its
+                        lower bound, or its upper bound if it has no lower
+==========================================================================*/
+void SparseLP::slack_basis(){
+
+  for (size_t j = 0; j < cols; j++) {
+    position[j]=-1;
+    at_upper[j]=lower[j] <= -HUGE_VAL;
+    shift[j]=0;
+  }
+
+  for (size_t i = 0; i < m; i++) {
+    head[i]=vars+i;
+    position[vars+i]=i;
+  }
+
+  factored=false;
+}
+
+/*=========================================================================
+SparseLP::set_bounds - change the bounds of a column, a nonbasic column
+                      keeps its side when that bound is finite. Basic
+                      values that leave their bounds, and a lower bound
+                      above the upper one, are found by simplex.
+==========================================================================*/
+void SparseLP::set_bounds(int j, float new_lower, float new_upper){
+
+  if (new_lower <= -FLT_MAX && new_upper >= FLT_MAX) throw std::invalid_argument("free columns are not supported");
+
+  lower[j] = (new_lower <= -FLT_MAX) ? -HUGE_VAL : new_lower;
+  upper[j] = (new_upper >= FLT_MAX) ? HUGE_VAL : new_upper;
+
+  if (at_upper[j] && upper[j] >= HUGE_VAL) at_upper[j]=false;
+  if (!at_upper[j] && lower[j] <= -HUGE_VAL) at_upper[j]=true;
+
+  if (lower[j] > upper[j]) feasible=false;
+  factored=false;
+}
+
+/*=========================================================================
+SparseLP::basis_words - words needed by compress_basis
+==========================================================================*/
+int SparseLP::basis_words(){
+  return 2*((cols+31)/32);
+}
+
+/*=========================================================================
+SparseLP::compress_basis - store the set of basic columns, then the set of
+                          nonbasic columns at their upper bound, one bit
+                          per column each
+==========================================================================*/
+void SparseLP::compress_basis(unsigned* bits){
+
+  int words=basis_words()/2;
+  for (size_t w = 0; w < 2*words; w++) bits[w]=0;
+
+  for (size_t j = 0; j < cols; j++) {
+    if (position[j]!=-1) bits[j/32] |= 1u<<(j%32);
+    else if (at_upper[j]) bits[words+j/32] |= 1u<<(j%32);
+  }
+}
+
+/*=========================================================================
+SparseLP::column_cost - minimized cost of a column, the negated objective
+                        for decision variables and 0 for slacks, plus any
+                        shift of the dual phase
+==========================================================================*/
+double SparseLP::column_cost(int j){
+  return (j < vars ? -(double)cost[j] : 0)+shift[j];
+}
+
+/*=========================================================================
+SparseLP::dot_column - product of a vector by row with column j of [A I]
+==========================================================================*/
+double SparseLP::dot_column(const double* y, int j){
+
+  if (j >= vars) return y[j-vars];
+
+  double sum=0;
+  for (int e = col_start[j]; e < col_start[j+1]; e++) sum+=y[row_index[e]]*value[e];
+  return sum;
+}
+
+/*=========================================================================
+SparseLP::compute_values - put nonbasic columns on their bounds and solve
+                          B x_B = rhs - N x_N for the basic ones
+==========================================================================*/
+void SparseLP::compute_values(){
+
+  for (size_t i = 0; i < m; i++) work[i]=rhs[i];
+
+  for (size_t j = 0; j < cols; j++) {
+    if (position[j]!=-1) continue;
+    x[j] = at_upper[j] ? upper[j] : lower[j];
+    if (x[j]==0) continue;
+    if (j >= vars) work[j-vars]-=x[j];
+    else for (int e = col_start[j]; e < col_start[j+1]; e++) work[row_index[e]]-=value[e]*x[j];
+  }
+
+  lu.ftran(work, column);
+  for (size_t p = 0; p < m; p++) x[head[p]]=column[p];
+}
+
+/*=========================================================================
+SparseLP::compute_duals - solve B^T y = c_B and price every nonbasic column
+==========================================================================*/
+void SparseLP::compute_duals(){
+
+  for (size_t p = 0; p < m; p++) work[p]=column_cost(head[p]);
+  lu.btran(work, duals);
+
+  for (size_t j = 0; j < cols; j++) d[j] = (position[j]==-1) ? column_cost(j)-dot_column(duals, j) : 0;
+}
+
+/*=========================================================================
+SparseLP::refactor - factor the current basis and recompute values and
+                    reduced costs from scratch, dropping accumulated
+                    round-off. Returns false if the basis is singular.
+==========================================================================*/
+bool SparseLP::refactor(){
+
+  if (!lu.factor(m, head, vars, col_start, row_index, value)) return false;
+
+  compute_values();
+  compute_duals();
+  factored=true;
+  return true;
+}
+
+/*=========================================================================
+SparseLP::pivot_row - row of B^-1 [A I] for a basis position, over the
+                      nonbasic columns
+==========================================================================*/
+void SparseLP::pivot_row(int r){
+
+  for (size_t p = 0; p < m; p++) work[p]=0;
+  work[r]=1;
+  lu.btran(work, duals);
+
+  for (size_t j = 0; j < cols; j++) row_alpha[j] = (position[j]==-1) ? dot_column(duals, j) : 0;
+}
+
+/*=========================================================================
+SparseLP::pivot - the entering column, FTRAN'd into column, moves by theta
+                  and replaces the basic column at position r, which lands
+                  on its upper bound if to_upper, else its lower bound.
+                  Needs pivot_row(r) for the reduced cost update. Returns
+                  false if a due refactorization found the basis singular
+                  and the slack basis was restored instead.
+==========================================================================*/
+bool SparseLP::pivot(int r, int entering, double theta, bool to_upper){
+
+  int leaving=head[r];
+  pivots++;
+
+  for (size_t p = 0; p < m; p++) x[head[p]]-=theta*column[p];
+  x[entering]+=theta;
+
+  double theta_d=d[entering]/row_alpha[entering];
+  for (size_t j = 0; j < cols; j++) if (position[j]==-1) d[j]-=theta_d*row_alpha[j];
+
+  lu.update(r, column);
+  head[r]=entering;
+  position[entering]=r;
+  position[leaving]=-1;
+  d[entering]=0;
+  d[leaving]=-theta_d;
+  at_upper[leaving]=to_upper;
+  x[leaving] = to_upper ? upper[leaving] : lower[leaving];
+
+  //drop accumulated round-off, or restart from the slacks if the basis degenerated
+  if (lu.updates() >= REFACTOR_INTERVAL && !refactor()) {
+    slack_basis();
+    refactor();
+    return false;
+  }
+
+  return true;
+}
+
+/*=========================================================================================
+SparseLP::dual_phase - bounded dual simplex, leave on the largest bound violation until
+                      the basis is primal feasible. Whenever the basis is freshly factored,
+                      boxed columns with the wrong reduced cost sign move to their other
+                      bound and the costs of the rest are shifted to a small perturbed
+                      margin, so every ratio test starts dual feasible and without ties;
+                      shifts are removed at the end. Returns false if a row
+                      cannot be repaired, meaning the LP is infeasible.
+===========================================================================================*/
+bool SparseLP::dual_phase(){
+
+  bool shifted=false;
+
+  while (true) {
+
+    int r=-1;
+    double worst=tolerances.feasibility;
+    for (size_t p = 0; p < m; p++) {
+      int j=head[p];
+      double violation=std::fmax(lower[j]-x[j], x[j]-upper[j]);
+      if (violation > worst) { worst=violation; r=p; }
+    }
+    if (r==-1) break;
+
+    if (lu.updates()==0) {
+      bool moved=false;
+      for (size_t j = 0; j < cols; j++) {
+        if (position[j]!=-1 || lower[j]==upper[j]) continue;
+
+        //reduced cost measured towards the feasible side of the column's bound
+        double slack = at_upper[j] ? -d[j] : d[j];
+        if (slack < -tolerances.optimality && (at_upper[j] ? lower[j] > -HUGE_VAL : upper[j] < HUGE_VAL)) {
+          at_upper[j]=!at_upper[j];
+          slack=-slack;
+          moved=true;
+        }
+
+        //a distinct small margin per column keeps the ratio tests from stalling on ties
+        double margin=DUAL_PERTURBATION*(1+(j*7919%97)/97.0);
+        if (slack < margin) {
+          double target = at_upper[j] ? -margin : margin;
+          shift[j]+=target-d[j];
+          d[j]=target;
+          shifted=true;
+        }
+      }
+      if (moved) {
+        compute_values();
+        continue;
+      }
+    }
+
+    int leaving=head[r];
+    bool below = x[leaving] < lower[leaving];
+    double delta = below ? x[leaving]-lower[leaving] : x[leaving]-upper[leaving];
+
+    pivot_row(r);
+
+    //entering column keeps every reduced cost on its dual feasible side
+    int entering=-1;
+    double best=0;
+    for (size_t j = 0; j < cols; j++) {
+      if (position[j]!=-1 || lower[j]==upper[j]) continue;
+      double a = at_upper[j] ? -row_alpha[j] : row_alpha[j];
+      if (below ? a >= -tolerances.pivot : a <= tolerances.pivot) continue;
+      double ratio=std::fmax(at_upper[j] ? -d[j] : d[j], 0)/std::fabs(a);
+      if (entering==-1 || ratio < best || (ratio==best && std::fabs(row_alpha[j]) > std::fabs(row_alpha[entering]))) {
+        entering=j;
+        best=ratio;
+      }
+    }
+
+    //No column can repair the row, so the bounds cut off every feasible point
+    if (entering==-1) {
+      feasible=false;
+      return false;
+    }
+
+    for (size_t i = 0; i < m; i++) work[i]=0;
+    if (entering >= vars) work[entering-vars]=1;
+    else for (int e = col_start[entering]; e < col_start[entering+1]; e++) work[row_index[e]]+=value[e];
+    lu.ftran(work, column);
+
+    pivot(r, entering, delta/column[r], !below);
+  }
+
+  if (shifted) {
+    for (size_t j = 0; j < cols; j++) shift[j]=0;
+    compute_duals();
+  }
+
+  return true;
+}
+
+/*=========================================================================================
+SparseLP::primal_phase - bounded primal simplex from a primal feasible basis. The entering
+                        column has the largest improving reduced cost; the ratio test stops
+                        at the first basic column to reach either of its bounds, or at the
+                        entering column's own other bound, which flips it without a pivot.
+                        After DEGENERATE_LIMIT iterations in a row that leave the objective
+                        unchanged, Bland's rule takes the lowest improving column and the
+                        lowest basic column among tied rows, until the objective moves again.
+                        An entering column nothing limits marks the LP unbounded. Returns
+                        false, with no answer, once the iteration limit is reached.
+===========================================================================================*/
+bool SparseLP::primal_phase(){
+
+  long limit=(long)PRIMAL_ITERATIONS_PER_COLUMN*cols;
+  int degenerate=0;
+
+  for (long iteration = 0; ; iteration++) {
+
+    if (iteration >= limit) return false;
+    bool bland = degenerate >= DEGENERATE_LIMIT;
+
+    int entering=-1;
+    double best=tolerances.optimality;
+    for (size_t j = 0; j < cols; j++) {
+      if (position[j]!=-1 || lower[j]==upper[j]) continue;
+      double gain = at_upper[j] ? d[j] : -d[j];
+      if (gain > best) {
+        best=gain;
+        entering=j;
+        if (bland) break;
+      }
+    }
+    if (entering==-1) break;
+
+    double dir = at_upper[entering] ? -1 : 1;
+
+    for (size_t i = 0; i < m; i++) work[i]=0;
+    if (entering >= vars) work[entering-vars]=1;
+    else for (int e = col_start[entering]; e < col_start[entering+1]; e++) work[row_index[e]]+=value[e];
+    lu.ftran(work, column);
+
+    double step=upper[entering]-lower[entering];
+    int r=-1;
+    bool to_upper=false;
+
+    for (size_t p = 0; p < m; p++) {
+      int j=head[p];
+      double a=dir*column[p];
+      double ratio;
+      bool upper_side;
+
+      //basic column decreases to its lower bound, or increases to its upper bound
+      if (a > tolerances.pivot && lower[j] > -HUGE_VAL) { ratio=(x[j]-lower[j])/a; upper_side=false; }
+      else if (a < -tolerances.pivot && upper[j] < HUGE_VAL) { ratio=(upper[j]-x[j])/-a; upper_side=true; }
+      else continue;
+
+      ratio=std::fmax(ratio, 0);
+      if (ratio < step || (bland && r!=-1 && ratio==step && j < head[r])) {
+        step=ratio;
+        r=p;
+        to_upper=upper_side;
+      }
+    }
+
+    //unbounded in the entering direction, there is no optimal vertex to report
+    if (step >= HUGE_VAL) {
+      unbounded=true;
+      feasible=false;
+      return true;
+    }
+
+    //iterations that leave the objective in place count towards Bland's rule
+    if (best*step <= tolerances.feasibility) degenerate++;
+    else degenerate=0;
+
+    //entering column reaches its own other bound first, flip it without a pivot
+    if (r==-1) {
+      for (size_t p = 0; p < m; p++) x[head[p]]-=dir*step*column[p];
+      at_upper[entering]=!at_upper[entering];
+      x[entering] = at_upper[entering] ? upper[entering] : lower[entering];
+      continue;
+    }
+
+    pivot_row(r);
+
+    //the slack basis restored after a singular refactorization may be infeasible
+    if (!pivot(r, entering, dir*step, to_upper) && !dual_phase()) return true;
+  }
+  return true;
+}
+
+/*=========================================================================================
+SparseLP::simplex - factor the starting basis, falling back to the slack basis if it is
+                    singular, then run the dual phase to reach a feasible basis and the
+                    primal phase to reach an optimal one. The basis is kept for warm-starting
+                    children. A primal phase stopped at its iteration limit leaves the LP
+                    neither feasible nor solved, as get_status reports.
+===========================================================================================*/
+OptimalSolution* SparseLP::simplex(){
+
+  if (feasible && !factored && !refactor()) {
+    slack_basis();
+    refactor();
+  }
+
+  status=true;
+  if (feasible && dual_phase() && !primal_phase()) {
+    feasible=false;
+    status=false;
+  }
+
+  //Store optimal arguments in the preallocated solution
+  solution.eval=0;
+  for (size_t j = 0; j < vars; j++) {
+    solution.args[j]=x[j];
+    solution.eval+=cost[j]*x[j];
+  }
+
+  this->sol=&solution;
+  return sol;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include "LinearProgram.hpp"
+#include "SparseLU.hpp"
+#include "Pool.hpp"
+
+#ifndef SPARSELP_HPP
+#define SPARSELP_HPP
+
+/*=================================================
+SparseLP - LP solved by the bounded revised simplex
+  on a compressed sparse column matrix, for problems
+  too large or too sparse for a dense Tableau. Only
+  the basis is factored, as a SparseLU, and every
+  iteration works on the nonzeros of the matrix and
+  the factors, so pivots no longer cost m*n.
+
+  Same model as Tableau: maximize obj.x subject to
+  rows A x <= rhs, each decision variable and row
+  slack within its column bounds, [0, inf) unless
+  changed. Arithmetic is in double. Node LPs built
+  by rebuild() share the root's matrix and only own
+  their bounds, basis and factors.
+====================================================*/
+class SparseLP: public LinearProgram{
+  private:
+    int m;                // constraint rows
+    int vars;             // decision variables, column vars+i is the slack of row i
+    int cols;             // vars+m
+    int* col_start;       // CSC matrix of the decision variables, shared with rebuilt nodes
+    int* row_index;
+    double* value;
+    double* rhs;          // right hand side of each row
+    float* cost;          // objective coefficients
+    bool owns_matrix;     // true for the LP the matrix was built for
+
+    double* lower;        // lower bound of each column, -HUGE_VAL if none
+    double* upper;        // upper bound of each column, HUGE_VAL if none
+    bool* at_upper;       // nonbasic column sits at its upper bound
+    int* head;            // column basic at each basis position
+    int* position;        // basis position of each column, -1 if nonbasic
+    double* x;            // value of every column
+    double* d;            // reduced cost of every column, for minimizing -obj
+    double* shift;        // cost shifts keeping the dual phase dual feasible
+    double* row_alpha;    // pivot row of the current iteration, by column
+    double* column;       // FTRAN'd entering column, by basis position
+    double* duals;        // BTRAN'd vector of row duals, by row
+    double* work;         // length m scratch
+    size_t block_bytes;   // size of the pooled block holding the arrays above
+    long pivots=0;        // basis changes made
+    Tolerances tolerances=scalar_tolerances<double>(); // pivot, feasibility, optimality and integrality thresholds
+    SparseLU lu;          // factors of the basis
+
+    bool feasible;        // set to true if there is a feasible solution
+    bool unbounded;       // set to true if the objective increases without limit
+    bool status;          // set to true if simplex has been run to an answer, false at its iteration limit
+    bool factored;        // lu, x and d match the current basis and bounds
+    OptimalSolution* sol; // stores solution to LP, NULL until solved
+    OptimalSolution solution; // storage sol points to, its args live in the pooled block
+
+    void allocate();                  // take the pooled block for m and cols
+    void slack_basis();               // every slack basic, every variable at its lower bound
+    void load_csc(const int*, const int*, const float*, const float*); // own a copy of the matrix
+    void start();                     // take ownership of the matrix, default bounds and slack basis
+    double column_cost(int);          // minimized cost of a column, shift included
+    double dot_column(const double*, int); // row vector times a column of [A I]
+    bool refactor();                  // factor the basis, recompute values and reduced costs
+    void compute_values();            // basic values from the nonbasic ones
+    void compute_duals();             // reduced costs of every column
+    void pivot_row(int);              // row_alpha for the basis position
+    bool pivot(int, int, double, bool); // column enters at position, leaving one goes to a bound
+    bool dual_phase();                // restore primal feasibility, false if infeasible
+    bool primal_phase();              // remove improving columns, false at the iteration limit
+
+  public:
+    SparseLP(float*, int, float**, int); // Constructor from the same dense arrays as Tableau
+
+    /*          args:   float* obj,               // coefficients of objective function
+                        int var_count,            // number of decision variables in LP
+                        float** constraints,      // 2-D array of constraint arrays, each of length var_count+1
+                        int constraint_count):    // number of independent constraints
+    */
+
+    SparseLP(float*, int, int, const int*, const int*, const float*, const float*); // Constructor from a CSC matrix
+
+    /*          args:   float* obj,               // coefficients of objective function
+                        int var_count,            // number of decision variables in LP
+                        int constraint_count,     // number of rows
+                        const int* col_start,     // var_count+1 offsets into row_index and values
+                        const int* row_index,     // row of each nonzero, by column
+                        const float* values,      // each nonzero
+                        const float* rhs          // right hand side of each row
+    */
+
+    SparseLP(int, int, int*, int*, double*, double*, float*); // Constructor adopting new[] arrays, for model readers
+
+    /*          args:   int var_count,            // number of decision variables in LP
+                        int constraint_count,     // number of rows
+                        int* col_start,           // var_count+1 offsets into row_index and values
+                        int* row_index,           // row of each nonzero, by column
+                        double* values,           // each nonzero
+                        double* rhs,              // right hand side of each row
+                        float* obj                // coefficients of objective function
+    */
+
+    SparseLP(SparseLP&, const BoundChange*, int, const unsigned* basis_bits=NULL); // Constructor for a tree node below
+                                            // a solved root, in the parent's basis if given, else the root's
+
+    ~SparseLP();                               // Destructor - return arrays to the pool, and the matrix if owned
+    static void* operator new(size_t);         // SparseLP objects are pooled
+    static void operator delete(void*, size_t);
+    OptimalSolution* simplex();                // Find optimal solution, bounded dual then primal revised simplex
+    void set_bounds(int, float, float);        // set lower and upper bound of a column, slacks follow the variables
+    LinearProgram* rebuild(const BoundChange*, int, const unsigned*); // new SparseLP for a tree node
+    int basis_words();                         // length of a compressed basis in 32 bit words
+    void compress_basis(unsigned*);            // store the basic and at-upper columns as bitsets
+
+    // Accessors
+    int get_rows() { return m;}                // return count of constraint rows
+    int get_vars() { return vars;}             // return count of decision variables
+    const float* get_cost() { return cost;}    // return objective coefficients
+    bool get_feasibility() { return feasible;} // return if the LP has a feasible solution
+    bool get_unbounded() { return unbounded;}  // return if the objective is unbounded
+    bool get_status() { return status;}        // return if simplex has been run to an answer
+    OptimalSolution* get_sol() { return sol;}  // optimal solution to the LP
+    long get_pivots() { return pivots;}        // return basis changes made since construction
+    const Tolerances& get_tolerances() { return tolerances;} // return the thresholds in use
+    void set_tolerances(const Tolerances& t) { tolerances=t;} // replace the thresholds, rebuilt nodes inherit them
+};
+
+#endif
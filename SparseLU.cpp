@@ -0,0 +1,215 @@
+#include "SparseLU.hpp"
+#include <cmath>
+#include <algorithm>
+
+// magnitude below which a pivot is taken as singular
+const double SINGULAR_TOL=1e-9;
+
+// magnitude below which computed factor entries are dropped
+const double DROP_TOL=1e-14;
+
+// fraction of a column's largest entry a pivot must reach, trading stability for sparsity
+const double PIVOT_THRESHOLD=0.1;
+
+/*=============================================================================
+SparseLU::factor - LU factors of the basis whose position p holds column
+                  head[p]: columns below structurals come from the CSC
+                  matrix, column structurals+i is the slack of row i.
+                  Each column is solved against the L columns found so far,
+                  the entries in pivoted rows form its U column and the
+                  largest remaining entry becomes its pivot. Returns false,
+                  leaving the factors unusable, if a column has no pivot.
+==============================================================================*/
+bool SparseLU::factor(int rows, const int* head, int structurals,
+                      const int* col_start, const int* row_index, const double* value){
+
+  m=rows;
+  pivot_row.assign(m, -1);
+  pivot_pos.assign(m, -1);
+  diag.assign(m, 0);
+  l_start.assign(1, 0); l_index.clear(); l_value.clear();
+  u_start.assign(1, 0); u_index.clear(); u_value.clear();
+  eta_start.assign(1, 0); eta_pos.clear(); eta_pivot.clear(); eta_index.clear(); eta_value.clear();
+  work.assign(m, 0);
+  order.assign(m, -1);
+  eliminating.clear();
+  touched.clear();
+  marked.assign(m, false);
+
+  auto touch=[&](int i){
+    if (!marked[i]) { marked[i]=true; touched.push_back(i); }
+  };
+
+  int k=0;
+
+  //slacks first, each pivots on its own row with empty L and U columns
+  for (int p = 0; p < m; p++) {
+
+    int col=head[p];
+    if (col < structurals) continue;
+
+    int row=col-structurals;
+    if (order[row]!=-1) return false;
+
+    diag[k]=1;
+    order[row]=k;
+    pivot_row[k]=row;
+    pivot_pos[k]=p;
+    l_start.push_back((int)l_index.size());
+    u_start.push_back((int)u_index.size());
+    k++;
+  }
+
+  //then structurals, sparsest first
+  row_count.assign(m, 0);
+  columns.clear();
+  for (int p = 0; p < m; p++) {
+    int col=head[p];
+    if (col >= structurals) continue;
+    columns.push_back(p);
+    for (int e = col_start[col]; e < col_start[col+1]; e++) row_count[row_index[e]]++;
+  }
+  std::sort(columns.begin(), columns.end(), [&](int a, int b){
+    return col_start[head[a]+1]-col_start[head[a]] < col_start[head[b]+1]-col_start[head[b]];
+  });
+
+  for (size_t c = 0; c < columns.size(); c++) {
+
+    int p=columns[c];
+    int col=head[p];
+
+    //scatter the basis column, summing any repeated rows
+    for (int e = col_start[col]; e < col_start[col+1]; e++) {
+      work[row_index[e]]+=value[e];
+      touch(row_index[e]);
+    }
+
+    //solve against L, in pivot order, slack pivots have nothing to eliminate
+    for (size_t t = 0; t < eliminating.size(); t++) {
+      int j=eliminating[t];
+      double w=work[pivot_row[j]];
+      if (w==0) continue;
+      for (int e = l_start[j]; e < l_start[j+1]; e++) {
+        work[l_index[e]]-=l_value[e]*w;
+        touch(l_index[e]);
+      }
+    }
+
+    //U column from pivoted rows
+    double largest=0;
+    for (size_t t = 0; t < touched.size(); t++) {
+      int i=touched[t];
+      double w=work[i];
+      if (std::fabs(w) <= DROP_TOL) continue;
+      if (order[i]!=-1) { u_index.push_back(order[i]); u_value.push_back(w); }
+      else largest=std::fmax(largest, std::fabs(w));
+    }
+
+    if (largest < SINGULAR_TOL) return false;
+
+    //pivot on the shortest remaining row within the threshold
+    int row=-1;
+    for (size_t t = 0; t < touched.size(); t++) {
+      int i=touched[t];
+      if (order[i]!=-1 || std::fabs(work[i]) < PIVOT_THRESHOLD*largest) continue;
+      if (row==-1 || row_count[i] < row_count[row] ||
+          (row_count[i]==row_count[row] && std::fabs(work[i]) > std::fabs(work[row]))) row=i;
+    }
+
+    diag[k]=work[row];
+    for (size_t t = 0; t < touched.size(); t++) {
+      int i=touched[t];
+      if (order[i]==-1 && i!=row && std::fabs(work[i]) > DROP_TOL) {
+        l_index.push_back(i);
+        l_value.push_back(work[i]/diag[k]);
+      }
+      work[i]=0;
+      marked[i]=false;
+    }
+    touched.clear();
+
+    if ((int)l_index.size() > l_start.back()) eliminating.push_back(k);
+    order[row]=k;
+    pivot_row[k]=row;
+    pivot_pos[k]=p;
+    l_start.push_back((int)l_index.size());
+    u_start.push_back((int)u_index.size());
+    k++;
+  }
+
+  return true;
+}
+
+/*=============================================================================
+SparseLU::update - product-form update after the entering column, already
+                  through ftran, replaced the basic column at position
+==============================================================================*/
+void SparseLU::update(int position, const double* column){
+
+  eta_pos.push_back(position);
+  eta_pivot.push_back(column[position]);
+
+  for (int p = 0; p < m; p++) {
+    if (p!=position && std::fabs(column[p]) > DROP_TOL) {
+      eta_index.push_back(p);
+      eta_value.push_back(column[p]);
+    }
+  }
+
+  eta_start.push_back((int)eta_index.size());
+}
+
+/*=============================================================================
+SparseLU::ftran - solve B out = rhs: forward through L, back through U,
+                  then through each eta in the order they were added
+==============================================================================*/
+void SparseLU::ftran(double* rhs, double* out){
+
+  for (int j = 0; j < m; j++) {
+    double w=rhs[pivot_row[j]];
+    work[j]=w;
+    if (w==0) continue;
+    for (int e = l_start[j]; e < l_start[j+1]; e++) rhs[l_index[e]]-=l_value[e]*w;
+  }
+
+  for (int k = m-1; k >= 0; k--) {
+    double z=work[k]/diag[k];
+    work[k]=0;
+    out[pivot_pos[k]]=z;
+    if (z==0) continue;
+    for (int e = u_start[k]; e < u_start[k+1]; e++) work[u_index[e]]-=u_value[e]*z;
+  }
+
+  for (size_t t = 0; t < eta_pos.size(); t++) {
+    double z=out[eta_pos[t]]/eta_pivot[t];
+    out[eta_pos[t]]=z;
+    if (z==0) continue;
+    for (int e = eta_start[t]; e < eta_start[t+1]; e++) out[eta_index[e]]-=eta_value[e]*z;
+  }
+}
+
+/*=============================================================================
+SparseLU::btran - solve B^T out = rhs: back through the etas, newest
+                  first, then forward through U^T and back through L^T
+==============================================================================*/
+void SparseLU::btran(double* rhs, double* out){
+
+  for (int t = (int)eta_pos.size()-1; t >= 0; t--) {
+    double s=rhs[eta_pos[t]];
+    for (int e = eta_start[t]; e < eta_start[t+1]; e++) s-=eta_value[e]*rhs[eta_index[e]];
+    rhs[eta_pos[t]]=s/eta_pivot[t];
+  }
+
+  for (int k = 0; k < m; k++) {
+    double t=rhs[pivot_pos[k]];
+    for (int e = u_start[k]; e < u_start[k+1]; e++) t-=u_value[e]*work[u_index[e]];
+    work[k]=t/diag[k];
+  }
+
+  for (int k = m-1; k >= 0; k--) {
+    double y=work[k];
+    work[k]=0;
+    for (int e = l_start[k]; e < l_start[k+1]; e++) y-=l_value[e]*out[l_index[e]];
+    out[pivot_row[k]]=y;
+  }
+}
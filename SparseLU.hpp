@@ -0,0 +1,59 @@
+#include <vector>
+
+#ifndef SPARSELU_HPP
+#define SPARSELU_HPP
+
+/*=====================================================================
+SparseLU - LU factors of a simplex basis B, held column by column with
+          only their nonzeros. Basis columns are either structural
+          columns of a compressed sparse column matrix or unit slack
+          columns. factor() eliminates them left-looking with partial
+          pivoting, slacks first since they pivot on their own row
+          without any work or fill. Structural columns follow from
+          the sparsest, each pivoting on the shortest row among those
+          within a threshold of its largest entry, which keeps fill
+          low, and only the rows a column reaches are visited. Each
+          basis change afterwards appends one product-form eta column
+          instead of refactoring, solves run through the LU factors
+          and then the etas, and the caller refactors once updates()
+          reaches its interval.
+
+          Vectors passed to ftran and btran are dense; rows are the
+          constraint rows, positions are the basis positions of head.
+=======================================================================*/
+class SparseLU{
+  private:
+    int m;                          // rows of the basis
+    std::vector<int> pivot_row;     // row of the k-th pivot
+    std::vector<int> pivot_pos;     // basis position eliminated k-th
+    std::vector<double> diag;       // U(k,k)
+    std::vector<int> l_start;       // start of column k of L in l_index, l_value
+    std::vector<int> l_index;       // rows below the pivot, unit diagonal not stored
+    std::vector<double> l_value;
+    std::vector<int> u_start;       // start of column k of U in u_index, u_value
+    std::vector<int> u_index;       // pivot order j < k
+    std::vector<double> u_value;
+    std::vector<int> eta_start;     // start of each eta column in eta_index, eta_value
+    std::vector<int> eta_pos;       // basis position replaced by each eta
+    std::vector<double> eta_pivot;  // FTRAN'd entering column at that position
+    std::vector<int> eta_index;     // its other nonzero positions
+    std::vector<double> eta_value;
+    std::vector<double> work;       // length m scratch
+    std::vector<int> order;         // pivot order of each row, -1 until pivoted
+    std::vector<int> eliminating;   // pivots with a nonempty L column, in order
+    std::vector<int> touched;       // rows of work written while factoring one column
+    std::vector<bool> marked;       // row is in touched
+    std::vector<int> row_count;     // structural basis nonzeros in each row
+    std::vector<int> columns;       // structural basis positions, sparsest column first
+
+  public:
+    SparseLU(): m(0) {}
+    bool factor(int rows, const int* head, int structurals,
+                const int* col_start, const int* row_index, const double* value); // factor the basis, false if singular
+    void update(int position, const double* column);  // the FTRAN'd column entered at position
+    void ftran(double* rhs, double* out);              // out = B^-1 rhs, rhs by row is destroyed, out by position
+    void btran(double* rhs, double* out);              // out = B^-T rhs, rhs by position is destroyed, out by row
+    int updates() { return (int)eta_pos.size(); }      // eta columns since the last factor
+};
+
+#endif
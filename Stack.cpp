@@ -1,4 +1,5 @@
 #include "Stack.hpp"
+#include <cmath>
 
 /*============================================================
  Stack Constructor - intializes sentinels that mark the top and
@@ -17,6 +18,7 @@ Stack::Stack(){
 void Stack::push(Node* n){
   n->next=top_sentinel.next;
   top_sentinel.next=n;
+  below_max.push_back(below_max.empty() ? n->weight : std::fmax(n->weight, below_max.back()));
 }
 
 /*============================================================
@@ -26,6 +28,7 @@ void Stack::pop(){
   Node* curr_top=top_sentinel.next;
   top_sentinel.next=top_sentinel.next->next;
   curr_top->next=NULL;
+  below_max.pop_back();
 }
 
 /*============================================================
@@ -43,6 +46,15 @@ bool Stack::is_empty(){
   return (top_sentinel.next==&bottom_sentinel);
 }
 
+/*=============================================================
+ Stack::max_weight - return the largest weight of the nodes on
+                    the stack, the one kept with the top node,
+                    -FLT_MAX if it is empty
+==============================================================*/
+double Stack::max_weight(){
+  return below_max.empty() ? -FLT_MAX : below_max.back();
+}
+
 /*================================================================
  Stack::print - print out current nodes in stack, in most recently
                 added order descending
@@ -1,29 +1,53 @@
 #include <iostream>
-#include "Tableau.hpp"
+#include <cfloat>
+#include <atomic>
+#include <vector>
+#include "LinearProgram.hpp"
+#include "Pool.hpp"
 
 #ifndef STACK_HPP
 #define STACK_HPP
 
 /*=====================================================================
-Node - Each tree node has an associated LP Tableau object and up to
-        two children nodes, also can be inserted in PriorityQueue
+Node - Each tree node has an associated LinearProgram and up to
+        two children nodes, also can be inserted in PriorityQueue.
+        Open nodes are stored as a delta from their parent, the one
+        branch constraint they add, and their LP is only rebuilt
+        from the root while the node is being processed.
 =======================================================================*/
 struct Node{
   char  tag;            //tag for identifying Node
   Node* next;           // pointer for implementing queue with linked list
-  Tableau* problem;     // corresponding LP problem for this node
-  float weight;         // weight for maintaining queue priority
+  LinearProgram* problem=NULL; // corresponding LP problem for this node, only while it is processed
+  double weight;        // weight for maintaining queue priority, the bound inherited from the parent's LP
+  double estimate;      // estimated best integer value below this node, used by best-estimate search
   Node* l_child=NULL;   // left child pointer for tree
   Node* r_child=NULL;   // right child pointer for tree
+  bool owns_problem=true; // false for the root, whose LP belongs to the caller
+  Node* parent=NULL;    // node this one branched from, kept alive while it has live descendants
+  BoundChange change={}; // branch constraint this node adds to its parent's LP
+  BoundChange* path=NULL; // every branch constraint from the root, on stand-ins for the parents of nodes read back from disk
+  float distance=0;     // how far the branch moves its variable from the parent's LP value
+  int depth=0;          // count of branch constraints between the root and this node
+  long id=0;            // order of creation within its search, the root is 0
+  unsigned* basis_bits=NULL; // compressed optimal basis once branched, warm-starts the children
+  int basis_words=0;    // length of basis_bits
+  std::atomic<int> refs{1}; // one for the node itself until fathomed, one per live child
 
+  // nodes are allocated from the shared pool and recycled once fathomed
+  static void* operator new(size_t bytes) { return node_pool().acquire(bytes); }
+  static void operator delete(void* p, size_t bytes) { node_pool().release(p, bytes); }
 };
 
 /*=================================================
-  Stack - stack implemented with singly linked list
+  Stack - stack implemented with singly linked list,
+          with the largest weight at or below each
+          entry kept alongside it
 ==================================================*/
 class Stack{
   private:
     Node top_sentinel, bottom_sentinel;
+    std::vector<double> below_max;  // largest weight of each node and those under it, bottom first
 
   public:
     Stack();                    // Constructor, initializes sentinels
@@ -31,6 +55,7 @@ class Stack{
     void pop();                 // Remove top node from stack
     Node* top();                // Return pointer to top node
     bool is_empty();            // Return if only the sentinels are in the stack
+    double max_weight();        // Return the largest weight of the nodes on the stack, in constant time
     void print();               // Print current stack order for debugging
 };
 
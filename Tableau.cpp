@@ -1,37 +1,40 @@
 #include "Tableau.hpp"
+#include <cstring>
+#include <cfloat>
 
 //***************************************
 // Simplex implemented with Tableau class,
 // accepts standardized maximization form
+// with bounds on every column
 //***************************************
 
-/*=============================================================================
-argmin - helper function for returning most negative element index in objective
-        function row
-==============================================================================*/
-int argmin(float* row, int length){
-
-  float min=INT_MAX;
-  int argmin;
-  for (size_t i = 0; i < length; i++){
-    if (row[i]<min){
-      min=row[i];
-      argmin=i;
-    }
-  }
+// share of the feasibility and optimality tolerances the Harris ratio tests
+// give bounds and reduced costs as slack, well inside them so the dual phase
+// never mistakes it for an infeasibility
+const double HARRIS_FRACTION=0.1;
 
-  return argmin;
-}
+// consecutive primal pivots that leave the objective where it was before
+// pricing falls back on Bland's rule, which cannot cycle, until one moves it
+const int DEGENERATE_LIMIT=50;
+
+// Devex weight beyond which the reference framework is reset to all ones
+const double DEVEX_RESET=1e6;
+
+// columns below which partial pricing scans the whole row, and the number
+// of blocks it splits wider rows into
+const int PARTIAL_MIN_COLUMNS=256;
+const int PARTIAL_BLOCKS=8;
 
 /*=============================================================================
 find_float - Helper to determine which index of the current optimal arguments
             is a non-integer in order to branch on the lower and upper integer
-            values of that float. Return -1 if they're all integers.
+            values of that float. Return -1 if they're all integers, up to
+            the integrality tolerance.
 ===============================================================================*/
-int find_float(double* arr, int num_vars){
+int find_float(double* arr, int num_vars, double integrality){
 
   for (size_t i = 0; i < num_vars; i++) {
-    if (arr[i]-(int)arr[i] != 0) return i;
+    if (std::fabs(arr[i]-std::round(arr[i])) > integrality) return i;
   }
   return -1;
 }
@@ -57,164 +60,501 @@ void print_solution(OptimalSolution* sol, int num_args){
 }
 
 /*=============================================================================
-add_rows - performs basic row reduction operation of mutablerow-scale*R2
+copy_solution - caller-owned copy of an OptimalSolution, for results that have
+               to outlive the pooled Tableau they were found in
 ==============================================================================*/
-void add_rows(float* mutable_row, const float* pivot_row, float c, int length){
-  for (size_t i = 0; i < length; i++) mutable_row[i]-=c*pivot_row[i];
-}
+OptimalSolution* copy_solution(OptimalSolution* sol, int num_args){
 
-/*================================================================================
-create_backup - helper to perform shallow copy of underlying 2-D array for tableau
-==================================================================================*/
-float** create_backup(float** arr,int m, int n){
+  OptimalSolution* copy=new OptimalSolution;
+  copy->eval=sol->eval;
+  copy->args=new double[num_args];
+  for (size_t i = 0; i < num_args; i++) copy->args[i]=sol->args[i];
 
-  float** backup = new float*[m];
-
-  for (size_t i = 0; i < m; i++) {
-    backup[i]=new float[n];
-    for (size_t j = 0; j < n; j++) backup[i][j]=arr[i][j];
-    }
+  return copy;
+}
 
-    return backup;
-  }
+/*=============================================================================
+Tableau::allocate - take one pooled block for all per-tableau storage: the
+                    zeroed, cache-line aligned rows of stride scalars, padding
+                    included so kernels can run over whole rows, followed by
+                    the column bounds, solution arguments, objective, model
+                    RHS, basis and flip flags, each at its own alignment
+==============================================================================*/
+template<class T>
+void BasicTableau<T>::allocate(){
+
+  int cols=n-1;
+  size_t row_bytes=(size_t)m*stride*sizeof(T);
+  size_t lower_at=row_bytes;
+  size_t upper_at=lower_at+cols*sizeof(T);
+  size_t args_at=(upper_at+cols*sizeof(T)+sizeof(double)-1)/sizeof(double)*sizeof(double);
+  size_t cost_at=args_at+vars*sizeof(double);
+  size_t rhs_at=cost_at+vars*sizeof(float);
+  size_t basis_at=rhs_at+(cols-vars)*sizeof(float);
+  size_t flipped_at=basis_at+(m-1)*sizeof(int);
+  block_bytes=flipped_at+cols*sizeof(bool);
+
+  char* block=(char*)node_pool().acquire(block_bytes);
+  std::memset(block, 0, row_bytes);
+
+  arr=(T*)block;
+  solution.args=(double*)(block+args_at);
+  lower=(T*)(block+lower_at);
+  upper=(T*)(block+upper_at);
+  cost=(float*)(block+cost_at);
+  model_rhs=(float*)(block+rhs_at);
+  basis=(int*)(block+basis_at);
+  flipped=(bool*)(block+flipped_at);
+}
 
+/*=============================================================================
+Tableau::new/delete - Tableau objects themselves also come from the pool
+==============================================================================*/
+template<class T>
+void* BasicTableau<T>::operator new(size_t bytes){
+  return node_pool().acquire(bytes);
+}
 
+template<class T>
+void BasicTableau<T>::operator delete(void* p, size_t bytes){
+  node_pool().release(p, bytes);
+}
 
 /*================================================================
-Tableau::Constructor - Creates simplex tableau for linear program
+Tableau::Constructor - Creates simplex tableau for linear program,
+                       every column starts with bounds [0, inf)
 ================================================================*/
-Tableau::Tableau(   float* obj,             // coefficients of objective function
+template<class T>
+BasicTableau<T>::BasicTableau(   float* obj,             // coefficients of objective function
                     int var_count,          // number of decision variables in LP
                     float** constraints,    // 2-D array of constraint arrays, each of length var_count+1
                     int constraint_count):  // number of independent constraints
-                    vars(var_count), m(constraint_count+1), n(var_count+constraint_count+1){
+                    vars(var_count), m(constraint_count+1), n(var_count+constraint_count+1),
+                    tolerances(scalar_tolerances<T>()){
 
   //allocate space for mxn Tableau matrix
-  arr = new float*[m];
-  signs = new short[constraint_count];
+  stride = padded_stride(n, sizeof(T));
+  allocate();
 
   //Fill out constraint rows
   for (size_t i = 0; i < m-1; i++) {
 
-    arr[i] = new float[n];
-    signs[i] = 1;
+    //Slack variable of each row starts out basic
+    basis[i] = var_count+i;
 
     //Store coefficients of LHS of constraints
-    for(size_t j = 0; j<var_count; j++) arr[i][j] = constraints[i][j];
+    for(size_t j = 0; j<var_count; j++) (*this)[i][j] = constraints[i][j];
 
     //Store slack variables
-    for(size_t j = var_count; j<n-1; j++) arr[i][j] = (j-var_count==i) ? 1 : 0;
+    for(size_t j = var_count; j<n-1; j++) (*this)[i][j] = (j-var_count==i) ? 1 : 0;
 
     //Store RHS of constraints
-    arr[i][n-1]=constraints[i][var_count];
+    (*this)[i][n-1]=constraints[i][var_count];
+    model_rhs[i]=constraints[i][var_count];
   }
 
-  arr[m-1] = new float[n];
   //Store objective function coefficients
-  for (size_t j = 0; j<n; j++) arr[m-1][j] = (j<var_count) ? -1*obj[j] : 0;
+  for (size_t j = 0; j<n; j++) (*this)[m-1][j] = (j<var_count) ? -1*obj[j] : 0;
+  for (size_t j = 0; j<var_count; j++) cost[j] = obj[j];
+
+  //Every column is non-negative and unbounded above, measured from its lower bound
+  for (size_t j = 0; j<n-1; j++) {
+    lower[j]=0;
+    upper[j]=FLT_MAX;
+    flipped[j]=false;
+  }
 
   status=false;
   feasible=true;
+  unbounded=false;
+  sol=NULL;
 
 }
 
 
 /*=========================================================================
-Tableau:: Constructor - Creates simplex tableau from existing Tableau
-                        by adding new branch constraint row for child node
+Tableau:: Constructor - Rebuilds the LP of a tree node from the root Tableau
+                        and the node's branch constraints. The root's current
+                        rows, basis and bounds are kept, so once the root has
+                        been solved the node starts from its optimal basis and
+                        each branch only tightens one variable bound. When the
+                        parent's compressed basis is given the rows are pivoted
+                        into it first, leaving only the node's own bound change
+                        for the dual simplex.
 ==========================================================================*/
-Tableau::Tableau(   Tableau& parent_tab,   // Original Tableau we are expanding
-                    size_t decision_var,   // Variable to add branch constraint
-                    float new_rhs,         // RHS of new branch constraint
-                    bool geq ){            // If the new row is given in >= form
+template<class T>
+BasicTableau<T>::BasicTableau(   BasicTableau& root_tab,        // Root Tableau every node is rebuilt from
+                    const BoundChange* changes,    // branch constraints from the root down to this node
+                    int count,                     // number of branch constraints
+                    const unsigned* basis_bits ){  // parent's optimal basis from compress_basis, or NULL
 
-    //Determine if constraint has to be modified into standard form
-    short sign = geq ? -1 : 1;
+    m=root_tab.get_rows();
+    n=root_tab.get_columns();
+    vars=root_tab.get_vars();
+    tolerances=root_tab.get_tolerances();
+    pricing=root_tab.pricing;
 
-    m=parent_tab.get_rows()+1;
-    n=parent_tab.get_columns()+1;
-    vars=parent_tab.get_vars();
+    stride = padded_stride(n, sizeof(T));
+    allocate();
 
-    arr = new float*[m];
-    signs = new short[m-1];
+    load(root_tab, changes, count);
 
-    //copy first m-2 rows of parent_tab
-    for (size_t i = 0; i < m-2; i++) {
+    //fall back to the root basis if the parent's basis cannot be restored
+    if (basis_bits!=NULL && !reinvert(basis_bits)) load(root_tab, changes, count);
+}
 
-      arr[i] = new float[n];
-      signs[i] = parent_tab.get_signs()[i];
+/*=========================================================================
+Tableau::rebuild - LP of a tree node below this root Tableau
+==========================================================================*/
+template<class T>
+LinearProgram* BasicTableau<T>::rebuild(const BoundChange* changes, int count, const unsigned* basis_bits){
+  return new BasicTableau(*this, changes, count, basis_bits);
+}
 
-      //Copy parent_tab's coefficients of LHS of constraints and add new row LHS coefficients
-      for(size_t j = 0; j<vars; j++) arr[i][j] = parent_tab[i][j];
+/*=========================================================================
+Tableau::load - copy the root's rows, basis and bounds and tighten the
+                bound of each branch variable
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::load(BasicTableau& root_tab, const BoundChange* changes, int count){
+
+    //same dimensions and stride as the root, so the whole block copies at once
+    std::memcpy(arr, root_tab.arr, (size_t)m*stride*sizeof(T));
+    std::memcpy(basis, root_tab.get_basis(), (m-1)*sizeof(int));
+    std::memcpy(cost, root_tab.cost, vars*sizeof(float));
+    std::memcpy(model_rhs, root_tab.model_rhs, (n-1-vars)*sizeof(float));
+
+    for (size_t j = 0; j < n-1; j++) {
+      lower[j]=root_tab.get_lower()[j];
+      upper[j]=root_tab.get_upper()[j];
+      flipped[j]=root_tab.flipped[j];
+    }
 
-      //Store slack variables
-      for(size_t j = vars; j<n-1; j++) arr[i][j] = (j-vars==i) ? 1 : 0;
+    status=false;
+    feasible=true;
+    unbounded=false;
+    sol=NULL;
+
+    //Apply branch constraints as bound changes
+    for (size_t k = 0; k < count; k++) {
+      int var=changes[k].var;
+      if (changes[k].geq) set_bounds(var, std::fmax(lower[var], changes[k].bound), upper[var]);
+      else set_bounds(var, lower[var], std::fmin(upper[var], changes[k].bound));
+    }
+}
+
+/*=========================================================================
+Tableau::width - distance between a column's bounds, FLT_MAX if either
+                is infinite
+==========================================================================*/
+template<class T>
+T BasicTableau<T>::width(int j){
+  if (lower[j] <= -FLT_MAX || upper[j] >= FLT_MAX) return FLT_MAX;
+  return upper[j]-lower[j];
+}
+
+/*=========================================================================
+Tableau::move_origin - re-express column j as measured from new_origin,
+                      upwards, or downwards if flip. Every row and the
+                      objective absorb the shift in their RHS, a change of
+                      direction negates the column, and a basic column's
+                      row is negated to keep its basic coefficient at 1.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::move_origin(int j, T old_origin, T new_origin, bool flip){
+
+  T old_dir = flipped[j] ? -1 : 1;
+  T shift = old_dir*(new_origin-old_origin);
+
+  int row=-1;
+  for (size_t i = 0; i < m; i++) {
+    T a=(*this)[i][j];
+    if (a==0) continue;
+    (*this)[i][n-1]-=a*shift;
+    if (i<m-1 && basis[i]==j) row=i;
+  }
 
-      //Copy parent_tab's RHS of constraints
-      arr[i][n-1] = parent_tab[i][n-2];
+  if (flip!=flipped[j]) {
+    if (row!=-1) {
+      scale_row((*this)[row], -1, stride);
+      (*this)[row][j]=1;
     }
+    else {
+      for (size_t i = 0; i < m; i++) (*this)[i][j]=-(*this)[i][j];
+    }
+    flipped[j]=flip;
+  }
+}
+
+/*=========================================================================
+Tableau::set_bounds - change the bounds of a column, keeping it measured
+                      from its current side when that bound is finite.
+                      Basic values that leave their bounds, and a lower
+                      bound above the upper one, are found by simplex.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::set_bounds(int j, T new_lower, T new_upper){
+
+  if (new_lower <= -FLT_MAX && new_upper >= FLT_MAX) throw std::invalid_argument("free columns are not supported");
 
-    //Add new single variable branch constraint
-    arr[m-2] = new float[n];
-    signs[m-2] = sign;
+  T old_origin = flipped[j] ? upper[j] : lower[j];
 
-    for (size_t j = 0; j < n; j++) {
-      arr[m-2][j] = (j==decision_var) ? sign : 0;
+  bool flip=flipped[j];
+  if (!flip && new_lower <= -FLT_MAX) flip=true;
+  if (flip && new_upper >= FLT_MAX) flip=false;
+
+  lower[j]=new_lower;
+  upper[j]=new_upper;
+
+  move_origin(j, old_origin, flip ? new_upper : new_lower, flip);
+
+  if (new_lower > new_upper) feasible=false;
+}
+
+/*=========================================================================
+Tableau::basis_words - words needed by compress_basis
+==========================================================================*/
+template<class T>
+int BasicTableau<T>::basis_words(){
+  return 2*((n-1+31)/32);
+}
+
+/*=========================================================================
+Tableau::compress_basis - store the set of basic columns, then the set of
+                          columns measured from their upper bound, as one
+                          bit per column each. Enough to restore the basis
+                          in a rebuilt child since pivots decide the row
+                          of each column.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::compress_basis(unsigned* bits){
+
+  int words=basis_words()/2;
+  for (size_t w = 0; w < 2*words; w++) bits[w]=0;
+
+  for (size_t i = 0; i < m-1; i++) bits[basis[i]/32] |= 1u<<(basis[i]%32);
+  for (size_t j = 0; j < n-1; j++) if (flipped[j]) bits[words+j/32] |= 1u<<(j%32);
+}
+
+/*=========================================================================
+Tableau::reinvert - pivot the parent's basic columns into the basis, then
+                    measure each column from the same side as the parent
+                    did. Return false if a column finds no usable pivot row.
+==========================================================================*/
+template<class T>
+bool BasicTableau<T>::reinvert(const unsigned* bits){
+
+  int cols=n-1;
+  int words=basis_words()/2;
+
+  auto bit=[&](int word_offset, int col){
+    return (bits[word_offset+col/32]>>(col%32))&1u;
+  };
+
+  bool* is_basic=(bool*)node_pool().acquire(cols);
+  for (size_t j = 0; j < cols; j++) is_basic[j]=false;
+  for (size_t i = 0; i < m-1; i++) is_basic[basis[i]]=true;
+
+  bool restored=true;
+
+  for (size_t j = 0; j < cols && restored; j++) {
+
+    if (!bit(0, j) || is_basic[j]) continue;
+
+    //leave on the largest entry among rows whose basic column is not wanted
+    int row=-1;
+    for (size_t i = 0; i < m-1; i++) {
+      if (bit(0, basis[i])) continue;
+      if (std::fabs((*this)[i][j]) > tolerances.pivot && (row==-1 || std::fabs((*this)[i][j]) > std::fabs((*this)[row][j]))) row=i;
     }
-    arr[m-2][n-2]=1;
-    arr[m-2][n-1]=sign*new_rhs;
 
-    //Copy objective function row
-    arr[m-1] = new float[n];
+    if (row==-1) { restored=false; break; }
 
-    //Store objective function coefficients
-    for (size_t j = 0; j<n; j++) arr[m-1][j] = (j<vars) ? parent_tab[m-2][j] : 0;
+    is_basic[basis[row]]=false;
+    is_basic[j]=true;
+    pivot(row, j);
+  }
 
-    status=false;
-    feasible=true;
+  node_pool().release(is_basic, cols);
 
+  //measure columns from the parent's side wherever that bound is finite
+  for (size_t j = 0; j < cols && restored; j++) {
+    bool flip=bit(words, j);
+    if (flip==flipped[j]) continue;
+    if (flip && upper[j] >= FLT_MAX) continue;
+    if (!flip && lower[j] <= -FLT_MAX) continue;
+    move_origin(j, flipped[j] ? upper[j] : lower[j], flip ? upper[j] : lower[j], flip);
+  }
 
+  return restored;
 }
 
 
 
 /*=========================================================================
-Tableau::Destructor - Free space allocated for the Tableau
-=========================================================================*/
-Tableau::~Tableau(){
+Tableau::reshape - move the rows and columns into a block of new
+                   dimensions. row_from and col_from give the old index of
+                   each new constraint row and column, -1 for a new one,
+                   which starts as zeros with bounds [0, inf). The
+                   objective row and the RHS column keep their places at
+                   the end, new rows leave their basic column to the caller.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::reshape(int rows, int columns, const int* row_from, const int* col_from){
+
+  int old_m=m, old_n=n, old_stride=stride;
+  T* old_arr=arr;
+  T* old_lower=lower;
+  T* old_upper=upper;
+  float* old_cost=cost;
+  float* old_rhs=model_rhs;
+  int* old_basis=basis;
+  bool* old_flipped=flipped;
+  size_t old_bytes=block_bytes;
+
+  m=rows;
+  n=columns;
+  stride=padded_stride(n, sizeof(T));
+  allocate();
+
+  //new index of every old column, for renumbering the basis
+  int* col_to=(int*)node_pool().acquire((old_n-1)*sizeof(int));
+  for (size_t j = 0; j < old_n-1; j++) col_to[j]=-1;
+  for (size_t j = 0; j < n-1; j++) if (col_from[j]!=-1) col_to[col_from[j]]=j;
 
-  //Free each length n column
   for (size_t i = 0; i < m; i++) {
-    delete arr[i];
+    int from = i==m-1 ? old_m-1 : row_from[i];
+    if (from==-1) continue;
+
+    const T* old_row=old_arr+(size_t)from*old_stride;
+    T* row=(*this)[i];
+    for (size_t j = 0; j < n-1; j++) if (col_from[j]!=-1) row[j]=old_row[col_from[j]];
+    row[n-1]=old_row[old_n-1];
+
+    if (i<m-1) basis[i]=col_to[old_basis[from]];
+  }
+
+  for (size_t j = 0; j < n-1; j++) {
+    int from=col_from[j];
+    lower[j] = from==-1 ? 0 : old_lower[from];
+    upper[j] = from==-1 ? FLT_MAX : old_upper[from];
+    flipped[j] = from==-1 ? false : old_flipped[from];
   }
+  std::memcpy(cost, old_cost, vars*sizeof(float));
+  for (size_t j = vars; j < n-1; j++) model_rhs[j-vars] = col_from[j]==-1 ? 0 : old_rhs[col_from[j]-vars];
 
-  //Free Row memory
-  delete arr;
+  node_pool().release(col_to, (old_n-1)*sizeof(int));
+  node_pool().release(old_arr, old_bytes);
 
-  //Free sign cache
-  delete signs;
+  status=false;
+  sol=NULL;
+}
+
+/*=========================================================================
+Tableau::add_cut - append the constraint coef.y >= rhs over the values y
+                   of the first count columns. Written in the columns'
+                   distances and with the basic columns eliminated, it is
+                   the row -coef.z + t = -rhs' of a new slack column t =
+                   coef.y - rhs, basic in it. A cut the current solution
+                   violates leaves t negative for the dual simplex.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::add_cut(const float* coef, int count, float rhs){
+
+  int cols=n-1;
+
+  //row over the current columns, RHS last
+  double* row=(double*)node_pool().acquire((cols+1)*sizeof(double));
+  double shifted_rhs=rhs;
+  for (size_t j = 0; j < cols; j++) row[j]=0;
+  for (size_t j = 0; j < count; j++) {
+    if (coef[j]==0) continue;
+    row[j] = flipped[j] ? coef[j] : -coef[j];
+    shifted_rhs -= coef[j]*(double)(flipped[j] ? upper[j] : lower[j]);
+  }
+  row[cols]=-shifted_rhs;
+
+  for (size_t i = 0; i < m-1; i++) {
+    double a=row[basis[i]];
+    if (a==0) continue;
+    const T* basic_row=(*this)[i];
+    for (size_t j = 0; j <= cols; j++) row[j]-=a*basic_row[j==cols ? n-1 : j];
+    row[basis[i]]=0;
+  }
+
+  //every old row and column keeps its place, the cut goes in before the objective row
+  int* row_from=(int*)node_pool().acquire(m*sizeof(int));
+  int* col_from=(int*)node_pool().acquire(n*sizeof(int));
+  for (size_t i = 0; i < m-1; i++) row_from[i]=i;
+  row_from[m-1]=-1;
+  for (size_t j = 0; j < cols; j++) col_from[j]=j;
+  col_from[cols]=-1;
+
+  reshape(m+1, n+1, row_from, col_from);
 
+  node_pool().release(row_from, (m-1)*sizeof(int));
+  node_pool().release(col_from, (n-1)*sizeof(int));
+
+  T* cut_row=(*this)[m-2];
+  for (size_t j = 0; j < cols; j++) cut_row[j]=row[j];
+  cut_row[cols]=1;
+  cut_row[n-1]=row[cols];
+  basis[m-2]=cols;
+  model_rhs[cols-vars]=-rhs;
+
+  node_pool().release(row, (cols+1)*sizeof(double));
 }
 
 /*=========================================================================
-Tableau::[] - access tableau row, which can then be indexed with another []
-=========================================================================*/
-float* Tableau::operator[] (int i){
-  return arr[i];
+Tableau::remove_cut - drop the slack column of a constraint together with
+                      the row it is basic in. A basic column is zero in
+                      every other row, so the remaining rows are unchanged.
+                      Return false, keeping the constraint, if the column
+                      is nonbasic.
+==========================================================================*/
+template<class T>
+bool BasicTableau<T>::remove_cut(int column){
+
+  int row=-1;
+  for (size_t i = 0; i < m-1; i++) if (basis[i]==column) row=i;
+  if (row==-1) return false;
+
+  int* row_from=(int*)node_pool().acquire(m*sizeof(int));
+  int* col_from=(int*)node_pool().acquire(n*sizeof(int));
+  for (size_t i = 0; i < m-2; i++) row_from[i] = i<row ? i : i+1;
+  for (size_t j = 0; j < n-2; j++) col_from[j] = j<column ? j : j+1;
+
+  int old_m=m, old_n=n;
+  reshape(m-1, n-1, row_from, col_from);
+
+  node_pool().release(row_from, old_m*sizeof(int));
+  node_pool().release(col_from, old_n*sizeof(int));
+  return true;
 }
 
+/*=========================================================================
+Tableau::Destructor - Free space allocated for the Tableau
+=========================================================================*/
+template<class T>
+BasicTableau<T>::~BasicTableau(){
+
+  //Return rows, arguments, bounds and basis to the pool
+  node_pool().release(arr, block_bytes);
+
+}
 
 /*=================================================
 Tableau::print - print current Tableau for debugging
 ====================================================*/
-void Tableau::print(){
+template<class T>
+void BasicTableau<T>::print(){
 
   std::cout<<std::endl<<"    ";
   for (int i=0;i<m;i++){
 
     for (int j=0; j<n;j++){
       //std::cout<<"HIT HERE"<<std::endl;
-      std::cout<<arr[i][j]<<", ";
+      std::cout<<(*this)[i][j]<<", ";
     }
     std::cout<<std::endl<<"    ";
   }
@@ -224,108 +564,494 @@ void Tableau::print(){
 
 
 /*=========================================================================
-find_departing_var- find the row to use in the pivot, as well as which current
-                    basic variable will be replaced.
+Tableau::pivot - scale the pivot row and use row operations to create a
+                column of zeros above and below the pivot element, the
+                entering column becomes basic in the pivot row
+=========================================================================*/
+template<class T>
+void BasicTableau<T>::pivot(int departing_row, int entering_column){
+
+  pivots++;
+
+  T* pivot_row=(*this)[departing_row];
+
+  //scale pivot row
+  scale_row(pivot_row, pivot_row[entering_column], stride);
+
+  //eliminate entering column from every other row, including the objective row,
+  //summing the new column norms while each row is in cache under steepest edge
+  if (edge_weights!=NULL) for (size_t j = 0; j < n-1; j++) edge_weights[j]=1;
+
+  for (size_t i = 0; i < m; i++) {
+    T* row=(*this)[i];
+    if (i != departing_row && row[entering_column] != 0){
+      add_rows(row, pivot_row, row[entering_column], stride);
+    }
+    if (edge_weights!=NULL && i < m-1) add_squares(edge_weights, row, n-1);
+  }
+
+  //update basic variables
+  basis[departing_row]=entering_column;
+}
+
+/*=========================================================================
+Tableau::flip_basic - measure the basic variable of a row from its other
+                      bound, so a value above its upper bound becomes a
+                      negative value for the dual ratio test
+=========================================================================*/
+template<class T>
+void BasicTableau<T>::flip_basic(int row){
+  int j=basis[row];
+  bool flip=!flipped[j];
+  move_origin(j, flipped[j] ? upper[j] : lower[j], flip ? upper[j] : lower[j], flip);
+}
+
+/*=========================================================================
+Tableau::model_distance - basic distance of a constraint row recomputed in
+                          double from the unshifted model RHS. The row is
+                          the basis inverse times the starting rows, that
+                          inverse read from the slack columns, so its RHS
+                          in the variables themselves is the inverse times
+                          model_rhs, less the origin every column is
+                          measured from. -FLT_MAX if an origin is infinite.
+==========================================================================*/
+template<class T>
+double BasicTableau<T>::model_distance(int i){
+
+  const T* row=(*this)[i];
+  double distance=0;
+  for (size_t j = 0; j < n-1; j++) {
+    if (row[j]==0) continue;
+    double coef = flipped[j] ? -row[j] : row[j];
+    double origin = flipped[j] ? upper[j] : lower[j];
+    if (std::fabs(origin) >= FLT_MAX) return -FLT_MAX;
+    if (j>=vars) distance+=coef*model_rhs[j-vars];
+    distance-=coef*origin;
+  }
+  return distance;
+}
+
+/*=========================================================================
+Tableau::harris_slack - slack the Harris ratio tests give bounds and
+                        reduced costs
+=========================================================================*/
+template<class T>
+T BasicTableau<T>::harris_slack(){
+  return HARRIS_FRACTION*std::fmin(tolerances.feasibility, tolerances.optimality);
+}
+
+/*=========================================================================
+Tableau::edge_norms - steepest edge weight of every column, one plus the
+                      squared norm of its entries in the constraint rows
+=========================================================================*/
+template<class T>
+void BasicTableau<T>::edge_norms(T* weights){
+  for (size_t j = 0; j < n-1; j++) weights[j]=1;
+  for (size_t i = 0; i < m-1; i++) add_squares(weights, (*this)[i], n-1);
+}
+
+/*=========================================================================
+Tableau::price - entering column of the primal simplex among those whose
+                reduced cost is below minus the optimality tolerance,
+                under the pricing rule, with the Devex or steepest edge
+                weights given for those rules. Bland's rule takes the
+                lowest such column instead. Partial pricing scans whole
+                blocks, and the full row before giving up. Return -1 if
+                there is none.
+=========================================================================*/
+template<class T>
+int BasicTableau<T>::price(const T* weights, bool bland){
+
+  T* obj=(*this)[m-1];
+  T threshold=-T(tolerances.optimality);
+  int cols=n-1;
+
+  if (bland) {
+    for (size_t j = 0; j < cols; j++) if (obj[j] < threshold) return j;
+    return -1;
+  }
+
+  if (pricing==PRICE_DEVEX || pricing==PRICE_STEEPEST_EDGE) {
+    int best=-1;
+    T best_score=0;
+    for (size_t j = 0; j < cols; j++) {
+      if (obj[j] >= threshold) continue;
+      T score=obj[j]*obj[j]/weights[j];
+      if (score > best_score) {
+        best_score=score;
+        best=j;
+      }
+    }
+    return best;
+  }
+
+  if (pricing==PRICE_PARTIAL && cols >= PARTIAL_MIN_COLUMNS) {
+    int block=(cols+PARTIAL_BLOCKS-1)/PARTIAL_BLOCKS;
+    int blocks=(cols+block-1)/block;
+    if (partial_start >= blocks) partial_start=0;
+
+    //whole blocks from the last productive one, wrapping around the row once
+    for (int k = 0; k < blocks; k++) {
+      int b=(partial_start+k)%blocks;
+      int begin=b*block;
+      int length=std::min(block, cols-begin);
+      int j=begin+argmin(obj+begin, length);
+      if (obj[j] < threshold) {
+        partial_start=b;
+        return j;
+      }
+    }
+  }
+
+  //Dantzig's rule, which also rescans the row for partial pricing so a
+  //column is never missed by the block boundaries
+  int j=argmin(obj, cols);
+  return obj[j] < threshold ? j : -1;
+}
+
+/*=========================================================================
+Tableau::find_departing_row - bounded primal ratio test, find how far the
+                    entering column can increase before a basic variable
+                    reaches either of its bounds, or the entering column
+                    reaches its own upper bound. Returns the row, or -1
+                    for a bound flip of the entering column, and sets
+                    to_upper if the basic variable leaves at its upper
+                    bound. Returns -2 if nothing limits it.
+                    Harris' two passes: the step is limited with every
+                    bound relaxed by the Harris slack, then the largest pivot
+                    among the rows reaching a bound within that step
+                    leaves, so round-off is never pivoted on. Under
+                    Bland's rule the step is not relaxed and the row
+                    of the lowest basic column leaves among the ties.
 =======================================================================*/
-int find_departing_row(Tableau* tab){
+template<class T>
+int BasicTableau<T>::find_departing_row(int entering_column, bool& to_upper, bool bland){
+
+  T tol=0;
+  for (size_t i = 0; i < m-1; i++) tol=std::fmax(tol, std::fabs((*this)[i][entering_column]));
+  tol=T(tolerances.pivot)*std::fmax(T(1), tol);
+  T harris = bland ? T(0) : harris_slack();
+
+  //largest step keeping every basic variable within its relaxed bounds
+  T step=width(entering_column);
+  bool limited=(step < FLT_MAX);
+
+  for (size_t i = 0; i < m-1; i++) {
+
+    T a=(*this)[i][entering_column];
+    T value=(*this)[i][n-1];
+
+    //basic variable decreases to zero, or increases to its width, values already
+    //outside their bounds within the feasibility tolerance count as on them so the step stays positive
+    if (a > tol) step=std::fmin(step, (std::fmax(value, T(0))+harris)/a);
+    else if (a < -tol && width(basis[i]) < FLT_MAX) step=std::fmin(step, (std::fmax(width(basis[i])-value, T(0))+harris)/-a);
+    else continue;
 
-  int m=tab->get_rows();
-  int n=tab->get_columns();
+    limited=true;
+  }
 
-  int entering_column=argmin((*tab)[m-1],n);
-  int departing_row=0;
+  if (!limited) return -2;
 
-  //find non-negative starting variable
-  for (size_t i = 0; i < m-1; i++)  if ((*tab)[i][entering_column] > 0) { departing_row = i; break;}
+  //the entering column's own bound is reached first
+  int departing_row=-1;
+  T largest=0;
+  to_upper=false;
+  if (width(entering_column) <= step) return departing_row;
 
   for (size_t i = 0; i < m-1; i++) {
 
-    if (((*tab)[i][entering_column]==0) || (*tab)[departing_row][entering_column] ==0) continue;
+    T a=(*this)[i][entering_column];
+    T value=(*this)[i][n-1];
+    T ratio;
+    bool upper_side;
+
+    if (a > tol) { ratio=value/a; upper_side=false; }
+    else if (a < -tol && width(basis[i]) < FLT_MAX) { ratio=(width(basis[i])-value)/-a; upper_side=true; }
+    else continue;
 
-    //departing variable is the smallest ratio of (RHS/entering_column element)
-    if ((*tab)[i][n-1]/(*tab)[i][entering_column]<(*tab)[departing_row][n-1]/(*tab)[departing_row][entering_column] &&
-        (*tab)[i][n-1]/(*tab)[i][entering_column]>=0){
+    if (ratio > step) continue;
+
+    if (bland ? (departing_row==-1 || basis[i] < basis[departing_row]) : std::fabs(a) > largest){
+      largest=std::fabs(a);
       departing_row=i;
+      to_upper=upper_side;
     }
-
   }
 
   return departing_row;
 }
 
-/*=========================================================================================
-Tableau::simplex - reduce tableau to optimal simplex form, and return optimal solution and arguments
-===========================================================================================*/
-OptimalSolution* Tableau::simplex(){
+/*=========================================================================
+Tableau::find_entering_column - dual ratio test, find the column to enter the basis
+                      when the departing row has a negative RHS while every
+                      reduced cost stays non-negative. Columns fixed by equal
+                      bounds cannot move and never enter. Return -1 if there
+                      is none, meaning the LP is infeasible. Harris' two
+                      passes as in the primal test: of the columns within
+                      the smallest ratio with reduced costs relaxed by
+                      the Harris slack, the largest row element enters.
+=======================================================================*/
+template<class T>
+int BasicTableau<T>::find_entering_column(int departing_row){
+
+  T* row=(*this)[departing_row];
+  T* obj=(*this)[m-1];
+
+  T tol=0;
+  for (size_t j = 0; j < n-1; j++) tol=std::fmax(tol, std::fabs(row[j]));
+  tol=T(tolerances.pivot)*std::fmax(T(1), tol);
+  T harris=harris_slack();
+
+  //smallest ratio of (reduced cost/|departing row element|), reduced costs relaxed
+  T bound=FLT_MAX;
+  for (size_t j = 0; j < n-1; j++) {
+    if (row[j] >= -tol || width(j)==0) continue;
+    bound=std::fmin(bound, (std::fmax(obj[j], T(0))+harris)/-row[j]);
+  }
 
-  //create backup of non-optimal tableau
-  float** backup = create_backup(arr,m,n);
+  int entering_column=-1;
+  T largest=0;
+  for (size_t j = 0; j < n-1; j++) {
+    if (row[j] >= -tol || width(j)==0) continue;
+    if (std::fmax(obj[j], T(0))/-row[j] <= bound && -row[j] > largest){
+      largest=-row[j];
+      entering_column=j;
+    }
+  }
 
-  //Initialize basic variables
-  int* basic_vars = new int[m-1];
-  for (size_t i = 0; i < m-1; i++) basic_vars[i]=vars+i;
+  return entering_column;
+}
 
-  int entering_column, departing_row;
-  float scale;
+/*=========================================================================
+Tableau::reprice - rebuild the objective row from the stored objective for
+                  the current basis, directions and origins
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::reprice(){
 
-  //Determine pivot element for row operation
-  entering_column=argmin(arr[m-1],n);
-  departing_row=find_departing_row(this);
+  T* obj=(*this)[m-1];
 
-  //Continue until objective row has no negative values;
-  while (arr[m-1][entering_column] < 0) {
+  for (size_t j = 0; j < stride; j++) obj[j]=0;
 
-    //scale pivot row
-    scale=arr[departing_row][entering_column];
-    for (size_t j = 0; j < n; j++) arr[departing_row][j] =   arr[departing_row][j] / scale;
+  //objective value of the columns sitting at their origins
+  for (size_t j = 0; j < vars; j++) {
+    T dir = flipped[j] ? -1 : 1;
+    obj[j]=-dir*cost[j];
+    obj[n-1]+=cost[j]*(flipped[j] ? upper[j] : lower[j]);
+  }
 
-    //Use row operations to create a column of zeros above and below the pivot element
-    for (size_t i = 0; i < m; i++) {
-      if (i != departing_row){
-        add_rows(arr[i],arr[departing_row], arr[i][entering_column]/arr[departing_row][entering_column], n);
-      }
-    }
+  //eliminate the basic columns
+  for (size_t i = 0; i < m-1; i++) {
+    int j=basis[i];
+    if (j < vars && obj[j] != 0) add_rows(obj, (*this)[i], obj[j], stride);
+  }
+}
 
-    //update basic variables
-    basic_vars[departing_row]=entering_column;
+/*=========================================================================
+Tableau::set_cost - replace the objective coefficients of the decision
+                    variables and reprice for the current basis, which
+                    stays primal feasible for the primal simplex
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::set_cost(const float* obj){
 
-    //move to next (possible) entering variable
-    entering_column=argmin(arr[m-1],n);
-    departing_row=find_departing_row(this);
-  }
+  std::memcpy(cost, obj, vars*sizeof(float));
+  reprice();
+  status=false;
+  sol=NULL;
+}
+
+/*=========================================================================
+Tableau::shift_rhs - add delta to the RHS of a constructor row. As with
+                     moving the origin of the row's slack, every row and
+                     the objective take delta times their entry in the
+                     slack's column, so the basis keeps its reduced costs
+                     and is left for the dual simplex.
+==========================================================================*/
+template<class T>
+void BasicTableau<T>::shift_rhs(int row, float delta){
 
-  //Create OptimalSolution structure for returning
-  OptimalSolution* solution=new OptimalSolution;
+  int slack=vars+row;
+  T shift = flipped[slack] ? -delta : delta;
+  for (size_t i = 0; i < m; i++) (*this)[i][n-1]+=shift*(*this)[i][slack];
+  model_rhs[row]+=delta;
+  status=false;
+  sol=NULL;
+}
 
-  //Store optimal arguments from basic variables
-  solution->args= new double[vars];
-  for (size_t i = 0; i < vars; i++) solution->args[i]=0;
+/*=========================================================================================
+Tableau::simplex - reduce tableau to optimal simplex form, and return optimal solution and arguments.
+                  The dual simplex first brings every basic variable within its bounds, as left
+                  by a tightened branch bound on a warm-started child, then the primal simplex
+                  removes negative reduced costs. If the start is neither primal nor dual feasible
+                  the negative reduced costs are zeroed for the dual phase and the objective is
+                  repriced before the primal phase. An entering column nothing limits marks
+                  the LP unbounded, and infeasible. The reduced tableau and basis are kept for
+                  warm-starting children.
+===========================================================================================*/
+template<class T>
+OptimalSolution* BasicTableau<T>::simplex(){
+
+  int entering_column, departing_row;
+  T* obj=(*this)[m-1];
+  T feasibility=tolerances.feasibility;
 
+  bool primal_feasible=true;
   for (size_t i = 0; i < m-1; i++) {
-    //save non-slack variables
-    if (basic_vars[i]<vars) solution->args[basic_vars[i]]=(double)arr[i][n-1];
+    T value=(*this)[i][n-1];
+    if (value < -feasibility || value > width(basis[i])+feasibility) primal_feasible=false;
   }
 
-  solution->eval=arr[m-1][n-1];
+  //Shift costs so the dual simplex starts from a dual feasible basis
+  bool shifted=false;
+  if (!primal_feasible && feasible) {
+    for (size_t j = 0; j < n-1; j++) {
+      if (obj[j] < 0) { obj[j]=0; shifted=true; }
+    }
+  }
 
-  status=true;
+  //Rows whose violation no column can repair but which is round-off on the scale of
+  //the row are taken as satisfied until the next pivot changes them
+  bool* settled=(bool*)node_pool().acquire((m-1)*sizeof(bool));
+  for (size_t i = 0; i < m-1; i++) settled[i]=false;
+
+  //Dual simplex: leave on the largest bound violation until the basis is primal feasible
+  while (feasible) {
+
+    //under steepest edge the violation is weighed by the norm of the row's
+    //part of the basis inverse, held in the columns that started as the identity
+    departing_row=-1;
+    T worst=feasibility;
+    T best_score=0;
+    for (size_t i = 0; i < m-1; i++) {
+      T value=(*this)[i][n-1];
+      T violation=std::fmax(-value, value-width(basis[i]));
+      if (violation <= feasibility || settled[i]) continue;
+
+      T score=violation;
+      if (pricing==PRICE_STEEPEST_EDGE) {
+        const T* row=(*this)[i];
+        T norm=0;
+        for (size_t j = vars; j < n-1; j++) norm+=row[j]*row[j];
+        score=violation*violation/std::fmax(norm, T(tolerances.pivot));
+      }
+      if (score > best_score) { best_score=score; worst=violation; departing_row=i; }
+    }
+    if (departing_row==-1) break;
+
+    //a variable above its upper bound leaves there, measured from that bound
+    if ((*this)[departing_row][n-1] > 0) flip_basic(departing_row);
+
+    entering_column=find_entering_column(departing_row);
+
+    //No column can repair the row, so the branch bounds cut off every feasible point,
+    //unless the violation is round-off on the scale of the row. The RHS the pivots
+    //carried is not trusted for that, the distance is recomputed from the model first
+    if (entering_column==-1) {
+      const T* row=(*this)[departing_row];
+      T scale=1;
+      for (size_t j = 0; j < n; j++) scale=std::fmax(scale, std::fabs(row[j]));
+      if (-model_distance(departing_row) <= feasibility*scale) {
+        settled[departing_row]=true;
+        continue;
+      }
+      feasible=false;
+      break;
+    }
 
-  for (size_t i = 0; i < m-1; i++){if (arr[i][n-1] < 0) feasible=false;}
+    pivot(departing_row, entering_column);
+    for (size_t i = 0; i < m-1; i++) settled[i]=false;
+  }
+  node_pool().release(settled, (m-1)*sizeof(bool));
+
+  if (feasible && shifted) reprice();
+
+  //Primal simplex: continue until no reduced cost is below the optimality tolerance
+  if (feasible) {
+
+    //Devex reference weights start at one, steepest edge weights are exact
+    //column norms that every pivot recomputes
+    int cols=n-1;
+    bool weighted = pricing==PRICE_DEVEX || pricing==PRICE_STEEPEST_EDGE;
+    T* weights = weighted ? (T*)node_pool().acquire(cols*sizeof(T)) : NULL;
+    if (pricing==PRICE_DEVEX) for (size_t j = 0; j < cols; j++) weights[j]=1;
+    if (pricing==PRICE_STEEPEST_EDGE) {
+      edge_norms(weights);
+      edge_weights=weights;
+    }
 
-  delete basic_vars;
+    int degenerate=0;
+    while (true) {
 
-  //Restore Tableau and free memory
+      bool bland = degenerate >= DEGENERATE_LIMIT;
+      entering_column=price(weights, bland);
+      if (entering_column==-1) break;
 
-  //Free each length n column
-  for (size_t i = 0; i < m; i++) {
-    delete arr[i];
+      T before=obj[n-1];
+      bool to_upper;
+      departing_row=find_departing_row(entering_column, to_upper, bland);
+
+      //unbounded in the entering direction, there is no optimal vertex to report
+      if (departing_row==-2) {
+        unbounded=true;
+        feasible=false;
+        break;
+      }
+
+      //entering column reaches its own upper bound first, flip it without a pivot
+      if (departing_row==-1) {
+        bool flip=!flipped[entering_column];
+        move_origin(entering_column, flipped[entering_column] ? upper[entering_column] : lower[entering_column],
+                    flip ? upper[entering_column] : lower[entering_column], flip);
+      }
+      else {
+        if (to_upper) flip_basic(departing_row);
+        pivot(departing_row, entering_column);
+
+        //every column's reference weight grows to cover its share of the entering column's
+        if (pricing==PRICE_DEVEX) {
+          T entering_weight=weights[entering_column];
+          const T* pivot_row=(*this)[departing_row];
+          if (entering_weight > DEVEX_RESET) for (size_t j = 0; j < cols; j++) weights[j]=1;
+          else for (size_t j = 0; j < cols; j++) weights[j]=std::fmax(weights[j], pivot_row[j]*pivot_row[j]*entering_weight);
+        }
+      }
+
+      //pivots that leave the objective in place count towards Bland's rule
+      if (obj[n-1]-before <= T(tolerances.feasibility)*std::fmax(T(1), std::fabs(before))) degenerate++;
+      else degenerate=0;
+    }
+
+    edge_weights=NULL;
+    if (weights!=NULL) node_pool().release(weights, cols*sizeof(T));
+  }
+
+  //Store optimal arguments in the preallocated solution: columns sit at
+  //their origin plus, for basic ones, the row value in their direction
+  for (size_t j = 0; j < vars; j++) solution.args[j]=flipped[j] ? upper[j] : lower[j];
+
+  for (size_t i = 0; i < m-1; i++) {
+    //save non-slack variables
+    int j=basis[i];
+    if (j<vars) solution.args[j]+=(flipped[j] ? -1 : 1)*(double)(*this)[i][n-1];
   }
 
-  //Free Row memory
-  delete arr;
+  solution.eval=obj[n-1];
 
-  arr = backup;
+  status=true;
 
-  this->sol=solution;
-  return solution;
+  this->sol=&solution;
+  return sol;
 }
+
+/*=========================================================================
+Tableau::scalar_name - name of the scalar type of the rows
+==========================================================================*/
+template<> const char* BasicTableau<float>::scalar_name(){ return "float"; }
+template<> const char* BasicTableau<double>::scalar_name(){ return "double"; }
+template<> const char* BasicTableau<long double>::scalar_name(){ return "long double"; }
+
+//the scalar types the LP engine is built for
+template class BasicTableau<float>;
+template class BasicTableau<double>;
+template class BasicTableau<long double>;
@@ -2,52 +2,112 @@
 #include <climits>
 #include <cmath>
 #include <stdexcept>
+#include "Kernels.hpp"
+#include "Pool.hpp"
+#include "LinearProgram.hpp"
 
 #ifndef TABLEAU_HPP
 #define TABLEAU_HPP
 
+// scalar type of the rows of Tableau, the dense engine the search, presolve
+// and benchmarks build. Build with -DBB_TABLEAU_SCALAR=double for stability
+// on large or badly scaled models, float is faster on small well scaled ones.
+#ifndef BB_TABLEAU_SCALAR
+#define BB_TABLEAU_SCALAR float
+#endif
 
 /*=============================================================================
 find_float - Helper to determine which index of the current optimal arguments
             is a non-integer in order to branch on the lower and upper integer
-            values of that float. Return -1 if they're all integers.
+            values of that float. Return -1 if they're all integers, up to
+            the integrality tolerance.
 ===============================================================================*/
-int find_float(double*, int);
-
-/*=================================================
-OptimalSolution - structure holding the optimal objective
-                  function evaluation and it's corresponding
-                  decision variable arguments.
-====================================================*/
-struct OptimalSolution{
-  float eval=0;        // function evaluation of optimal value
-  double* args=NULL;   // returns optimal value of decision variables
-};
+int find_float(double*, int, double integrality);
 
 /*=====================================================================
 print_solution - clean print OptimalSolution arguments and evaluation
 ======================================================================*/
 void print_solution(OptimalSolution*, int);
 
+/*=====================================================================
+copy_solution - caller-owned copy of an OptimalSolution and its arguments
+======================================================================*/
+OptimalSolution* copy_solution(OptimalSolution*, int);
+
+
+/*=============================================================================
+PricingRule - how the primal simplex picks its entering column among those
+              with a negative reduced cost d_j. Every rule falls back on
+              Bland's rule while the objective stalls over degenerate pivots.
+              Under steepest edge the dual simplex also weighs each row's
+              infeasibility by the norm of its row of the basis inverse.
+===============================================================================*/
+enum PricingRule{
+  PRICE_DANTZIG,        // most negative d_j over the whole objective row
+  PRICE_PARTIAL,        // most negative d_j of the first block of columns that has one,
+                        // the scan resuming at the block last chosen from
+  PRICE_DEVEX,          // largest d_j^2/w_j, with Devex reference weights w_j updated from each pivot row
+  PRICE_STEEPEST_EDGE   // largest d_j^2/(1+|column j|^2), exact column norms kept up by every pivot
+};
 
 /*=================================================
-Tableau - Augmented matrix row-reduced until optimal
+BasicTableau - Augmented matrix row-reduced until optimal
   members: m,n: dimensions of underlying array)
            var: number of decision variables being optimized
            arr: underlying array
+  Every column j has bounds lower[j] <= x[j] <= upper[j]
+  and is held in the rows as its distance from one of
+  them, upwards from lower[j] or downwards from upper[j]
+  if flipped[j], so nonbasic columns always read 0 and
+  the RHS column holds the basic distances.
+  The rows, bounds and pivots are in the scalar type T,
+  float, double or long double, the model data and the
+  objective stay float. Bounds at or beyond FLT_MAX are
+  infinite whatever T is.
 ====================================================*/
-class Tableau{
+template<class T>
+class BasicTableau: public LinearProgram{
   private:
     int m,n;              // Dimensions of underlying 2-D array
+    int stride;           // scalars per stored row, n padded to whole cache lines
     int vars;             // count of decision variables
-    short* signs;         // signs of constraints, either 1 for standard <= or -1 for >=
+    int* basis;           // column index of the basic variable of each constraint row
     bool feasible;        // set to true if there is a feasible solution
+    bool unbounded;       // set to true if the objective increases without limit
     bool status;          // set to true if simplex has been run and Tabluea reduced
-    OptimalSolution* sol; // stores solution to LP represented by Tableau
+    OptimalSolution* sol; // stores solution to LP represented by Tableau, NULL until solved
+    OptimalSolution solution; // storage sol points to, its args live in the pooled block
+    T* lower;             // lower bound of each column, -FLT_MAX if none
+    T* upper;             // upper bound of each column, FLT_MAX if none
+    bool* flipped;        // column measured downwards from its upper bound
+    float* cost;          // objective coefficients, for repricing
+    float* model_rhs;     // unshifted RHS of each constraint row, by slack column from vars on
+    Tolerances tolerances; // pivot, feasibility, optimality and integrality thresholds
+    PricingRule pricing=PRICE_STEEPEST_EDGE; // entering column rule of the primal simplex
+    int partial_start=0;  // block partial pricing scans first
+    T* edge_weights=NULL; // squared column norms pivot keeps exact, only during steepest edge simplex
+    size_t block_bytes;   // size of the pooled block holding rows, args, bounds and basis
+    long pivots=0;        // pivots made, reinversion included
+    void allocate();      // take the pooled block for m, stride and vars
+    void load(BasicTableau&, const BoundChange*, int); // copy the root and apply branch bound changes
+    bool reinvert(const unsigned*);   // pivot a compressed parent basis back in
+    void pivot(int, int); // pivot on (row, column), making the column basic in that row
+    T width(int);         // upper minus lower bound of a column, FLT_MAX if unbounded
+    void move_origin(int, T, T, bool); // re-express a column from another bound
+    void flip_basic(int); // measure a row's basic variable from its other bound
+    void reprice();       // rebuild the objective row from cost
+    double model_distance(int); // basic distance of a row recomputed from model_rhs
+    T harris_slack();     // relaxation of bounds and reduced costs in the ratio tests
+    void edge_norms(T*);  // 1 plus the squared norm of every column over the constraint rows
+    int price(const T*, bool);          // entering column under the pricing rule, or Bland's, -1 if optimal
+    int find_departing_row(int, bool&, bool); // bounded primal ratio test
+    int find_entering_column(int);      // dual ratio test
+    void reshape(int, int, const int*, const int*); // move rows and columns into a block of new dimensions
 
   public:
-    float** arr;    // Underlying 2-D array
-    Tableau(float*, int, float**, int); // Constructor accepts coefficient arrays of objective function, constraints, and dimensions.
+    typedef T Scalar;
+    T* arr;         // Underlying 2-D array, contiguous and cache-line aligned, row i starts at arr+i*stride
+    BasicTableau(float*, int, float**, int); // Constructor accepts coefficient arrays of objective function, constraints, and dimensions.
 
     /*          args:   float* obj,               // coefficients of objective function
                         int var_count,            // number of decision variables in LP
@@ -55,27 +115,55 @@ class Tableau{
                         int constraint_count):    // number of independent constraints
     */
 
-    Tableau(Tableau&, size_t, float, bool); // Constructor for adding new row of a single variable constraint to an existing tableau
+    BasicTableau(BasicTableau&, const BoundChange*, int, const unsigned* basis_bits=NULL); // Constructor rebuilding a tree node's LP from the root
+                                            // Tableau, tightening one variable bound per branch
 
-      /*        args:   Tableau& parent_tab,      // Original Tableau we are expanding
-                        size_t decision_var,      // Variable to add branch constraint
-                        float new_rhs,            // RHS of new branch constraint
-                        bool geq                  // If the new row is given in >= form
+      /*        args:   BasicTableau& root_tab,        // Root Tableau, its current rows, basis, bounds and tolerances are the starting point
+                        const BoundChange* changes,    // branch constraints from the root down to this node
+                        int count,                     // number of branch constraints
+                        const unsigned* basis_bits     // parent's optimal basis from compress_basis, or NULL
     */
 
-    ~Tableau();                                // Destructor - free underlying 2-D array and signs
+    ~BasicTableau();                           // Destructor - return underlying 2-D array and bounds to the pool
+    static void* operator new(size_t);         // Tableau objects are pooled as well
+    static void operator delete(void*, size_t);
     void print();                              // print current Tableau for debugging
-    OptimalSolution* simplex();                // Find optimal solution of corresponding linear program
+    OptimalSolution* simplex();                // Find optimal solution of corresponding linear program, dual then primal
+    void set_bounds(int, T, T);                // set lower and upper bound of a column, slacks follow the variables
+    LinearProgram* rebuild(const BoundChange*, int, const unsigned*); // new Tableau for a tree node, see the constructor
+    int basis_words();                         // length of a compressed basis in 32 bit words
+    void compress_basis(unsigned*);            // store the basic and flipped columns as bitsets for warm-starting children
+    void add_cut(const float*, int, float);    // append the row coef.y >= rhs over the first columns, its slack basic in a new column
+    bool remove_cut(int);                      // drop a basic slack column and its row, false if the column is nonbasic
+    void set_cost(const float*);               // replace the objective coefficients of the decision variables
+    void shift_rhs(int, float);                // add to the RHS of a constructor row, keeping the basis
+    void set_tolerances(const Tolerances& t) { tolerances=t;} // replace the thresholds, rebuilt nodes inherit them
+    void set_pricing(PricingRule rule) { pricing=rule;} // replace the pricing rule, rebuilt nodes inherit it
+    static const char* scalar_name();          // name of T
 
     // Accessors
     int get_rows(){ return m;}                 // return count of rows
     int get_columns() { return n;}             // return count of columns
     int get_vars() { return vars;}             // return count of decision variables for this problem
-    float* operator[](int);                    // access Tableau element
-    short* get_signs() {return signs;}         // return list of constraint signs
+    int get_stride() { return stride;}         // return scalars per stored row
+    T* operator[](int i) { return arr+(size_t)i*stride;} // access Tableau element
+    const float* get_cost() {return cost;}     // return objective coefficients of the decision variables
+    T* get_lower() {return lower;}             // return lower bound of each column
+    T* get_upper() {return upper;}             // return upper bound of each column
+    int* get_basis() {return basis;}           // return basic variable column of each constraint row
+    bool* get_flipped() {return flipped;}      // return if each column is measured from its upper bound
     bool get_feasibility() { return feasible;} // return if the tableau has a feasible solution
+    bool get_unbounded() { return unbounded;}  // return if the objective is unbounded
     bool get_status() {return status;}         // return if the tableau is currently in reduced simplex form
     OptimalSolution* get_sol() {return sol;}   // optimal solution to LP represented by Tableau
+    long get_pivots() {return pivots;}         // return pivots made since construction
+    const Tolerances& get_tolerances() {return tolerances;} // return the thresholds in use
 };
 
+/*=================================================
+Tableau - the dense engine in the scalar type chosen
+          at compile time by BB_TABLEAU_SCALAR
+====================================================*/
+typedef BasicTableau<BB_TABLEAU_SCALAR> Tableau;
+
 #endif
@@ -0,0 +1,369 @@
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#ifndef TINYSOLVER_HPP
+#define TINYSOLVER_HPP
+
+// largest models branch_and_bound hands to a TinySolver
+const int TINY_MAX_VARS=8;
+const int TINY_MAX_ROWS=8;
+
+// upper bounds at or beyond this are none
+constexpr double TINY_INFINITY=1e30;
+
+/*=============================================================================
+TinyModel - maximize obj.x subject to rows a.x <= rhs, each row of cons its
+            vars coefficients then its RHS, and lower[j] <= x[j] <= upper[j]
+            for integer x. Every upper bound starts out infinite.
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+struct TinyModel{
+  int vars=0;
+  int rows=0;
+  std::array<double, MAX_VARS> obj;
+  std::array<std::array<double, MAX_VARS+1>, MAX_ROWS> cons;
+  std::array<double, MAX_VARS> lower;
+  std::array<double, MAX_VARS> upper;
+
+  constexpr TinyModel(): obj{}, cons{}, lower{}, upper{} {
+    for (int j = 0; j < MAX_VARS; j++) upper[j]=TINY_INFINITY;
+  }
+};
+
+/*=============================================================================
+TinyStatus - outcome of a TinySolver
+===============================================================================*/
+enum TinyStatus{
+  TINY_OPTIMAL,       // args holds the best integer solution
+  TINY_INFEASIBLE,    // there is no integer solution
+  TINY_UNSOLVED       // an LP was unbounded, or the open nodes or node budget ran out: use the general search
+};
+
+template<int MAX_VARS>
+struct TinyResult{
+  TinyStatus status=TINY_INFEASIBLE;
+  bool found=false;                   // an integer solution was found, also when the model is handed on
+  double eval=0;                      // objective of the best integer solution
+  std::array<double, MAX_VARS> args{};  // its values, snapped onto the integers
+  long nodes=0;                       // node LPs solved
+  long branched=0;                    // nodes split in two
+  long pivots=0;                      // simplex pivots over every node LP
+};
+
+/*=============================================================================
+TinySolver - depth first branch and bound for models of at most MAX_VARS
+             variables and MAX_ROWS constraints, held entirely in fixed-size
+             arrays: no pool, no heap, no linked nodes. Each node is a box of
+             variable bounds on an array stack, and its LP is built afresh
+             in double precision: variables shifted to their lower bounds,
+             one row per finite upper bound, a dual simplex on shifted costs
+             then a primal simplex under Bland's rule. Columns sit at fixed
+             positions, so every row operation spans a compile-time width
+             and is unrolled into one expression. The whole solve is
+             constexpr, so a model known at compile time can be solved
+             by the compiler.
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+class TinySolver{
+  public:
+    static constexpr int ROWS=MAX_ROWS+MAX_VARS;  // model rows and one upper bound row per variable
+    static constexpr int COLS=MAX_VARS+ROWS+1;    // variables, slacks, then the RHS
+    static constexpr int RHS=COLS-1;
+    static constexpr int STACK=8*MAX_VARS+8;      // open nodes held at once
+    static constexpr long NODE_BUDGET=100000;     // node LPs before handing the model on
+    static constexpr int ITERATIONS=50*COLS;      // pivots per simplex phase before handing the model on
+
+    // thresholds of the double engine's scalar_tolerances
+    static constexpr double PIVOT=1e-9;
+    static constexpr double FEASIBILITY=1e-7;
+    static constexpr double OPTIMALITY=1e-7;
+    static constexpr double INTEGRALITY=1e-6;
+
+    typedef std::array<double, COLS> Row;
+    typedef TinyModel<MAX_VARS, MAX_ROWS> Model;
+    typedef TinyResult<MAX_VARS> Result;
+
+    static constexpr Result solve(const Model&, double abs_gap=1e-6, double rel_gap=0);
+
+  private:
+    enum LPStatus{ LP_OPTIMAL, LP_INFEASIBLE, LP_UNSOLVED };
+
+    //a node: the bounds its branches left, and its parent's LP value
+    struct Box{
+      std::array<double, MAX_VARS> lower;
+      std::array<double, MAX_VARS> upper;
+      double bound;
+    };
+
+    std::array<Row, ROWS+1> tab{};    // constraint rows, then the objective row at ROWS
+    Row cost{};                       // objective row before any pivot, for repricing
+    std::array<int, ROWS> basis{};    // basic column of each constraint row
+    int rows=0;                       // constraint rows in use
+    long pivots=0;
+
+    constexpr TinySolver() {}
+
+    static constexpr double absolute(double x) { return x < 0 ? -x : x; }
+    static constexpr double floor_of(double x) {
+      double t=(double)(long long)x;
+      return t > x ? t-1 : t;
+    }
+
+    //row -= f * other, over every column in one unrolled expression
+    template<size_t... J>
+    static constexpr void eliminate(Row& row, const Row& other, double f, std::index_sequence<J...>) {
+      ((row[J]-=f*other[J]), ...);
+    }
+
+    template<size_t... J>
+    static constexpr void scale(Row& row, double f, std::index_sequence<J...>) {
+      ((row[J]*=f), ...);
+    }
+
+    static constexpr bool within_gap(double bound, double incumbent, double abs_gap, double rel_gap) {
+      double gap=bound-incumbent;
+      return gap <= abs_gap || (incumbent!=0 && gap/absolute(incumbent) <= rel_gap);
+    }
+
+    constexpr void load(const Model&, const Box&);
+    constexpr void pivot(int, int);
+    constexpr void reprice();
+    constexpr LPStatus simplex();
+    constexpr double value(int j, const Box& box) const;
+};
+
+/*=============================================================================
+TinySolver::load - the LP of a box: x = lower + y with y >= 0, the model rows
+                   shifted by the lower bounds, an upper bound row per
+                   bounded variable and every slack basic
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr void TinySolver<MAX_VARS, MAX_ROWS>::load(const Model& model, const Box& box){
+
+  tab={};
+  rows=0;
+
+  for (int i = 0; i < model.rows; i++) {
+    double rhs=model.cons[i][model.vars];
+    for (int j = 0; j < model.vars; j++) {
+      tab[rows][j]=model.cons[i][j];
+      rhs-=model.cons[i][j]*box.lower[j];
+    }
+    tab[rows][MAX_VARS+rows]=1;
+    tab[rows][RHS]=rhs;
+    basis[rows]=MAX_VARS+rows;
+    rows++;
+  }
+
+  for (int j = 0; j < model.vars; j++) {
+    if (box.upper[j] >= TINY_INFINITY) continue;
+    tab[rows][j]=1;
+    tab[rows][MAX_VARS+rows]=1;
+    tab[rows][RHS]=box.upper[j]-box.lower[j];
+    basis[rows]=MAX_VARS+rows;
+    rows++;
+  }
+
+  //objective row z - obj.y = obj.lower
+  Row& obj=tab[ROWS];
+  for (int j = 0; j < model.vars; j++) {
+    obj[j]=-model.obj[j];
+    obj[RHS]+=model.obj[j]*box.lower[j];
+  }
+  cost=obj;
+}
+
+/*=============================================================================
+TinySolver::pivot - make column c basic in row r
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr void TinySolver<MAX_VARS, MAX_ROWS>::pivot(int r, int c){
+
+  scale(tab[r], 1/tab[r][c], std::make_index_sequence<COLS>());
+  tab[r][c]=1;
+
+  for (int i = 0; i < rows; i++) {
+    if (i!=r && tab[i][c]!=0) eliminate(tab[i], tab[r], tab[i][c], std::make_index_sequence<COLS>());
+  }
+  if (tab[ROWS][c]!=0) eliminate(tab[ROWS], tab[r], tab[ROWS][c], std::make_index_sequence<COLS>());
+
+  basis[r]=c;
+  pivots++;
+}
+
+/*=============================================================================
+TinySolver::reprice - rebuild the objective row from the costs in the
+                      current basis
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr void TinySolver<MAX_VARS, MAX_ROWS>::reprice(){
+
+  tab[ROWS]=cost;
+  for (int i = 0; i < rows; i++) {
+    double f=tab[ROWS][basis[i]];
+    if (f!=0) eliminate(tab[ROWS], tab[i], f, std::make_index_sequence<COLS>());
+  }
+}
+
+/*=============================================================================
+TinySolver::simplex - dual simplex with improving costs shifted to zero until
+                      every RHS is non-negative, then the primal simplex on
+                      the real costs, entering the first improving column
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr typename TinySolver<MAX_VARS, MAX_ROWS>::LPStatus TinySolver<MAX_VARS, MAX_ROWS>::simplex(){
+
+  Row& obj=tab[ROWS];
+
+  bool shifted=false;
+  for (int i = 0; i < rows && !shifted; i++) {
+    if (tab[i][RHS] < -FEASIBILITY) shifted=true;
+  }
+  if (shifted) {
+    for (int j = 0; j < RHS; j++) if (obj[j] < 0) obj[j]=0;
+  }
+
+  for (int iteration = 0; ; iteration++) {
+    if (iteration > ITERATIONS) return LP_UNSOLVED;
+
+    int r=-1;
+    double worst=-FEASIBILITY;
+    for (int i = 0; i < rows; i++) {
+      if (tab[i][RHS] < worst) { worst=tab[i][RHS]; r=i; }
+    }
+    if (r==-1) break;
+
+    int c=-1;
+    double ratio=0;
+    for (int j = 0; j < RHS; j++) {
+      if (tab[r][j] >= -PIVOT) continue;
+      double q=obj[j]/-tab[r][j];
+      if (c==-1 || q < ratio) { c=j; ratio=q; }
+    }
+    if (c==-1) return LP_INFEASIBLE;
+    pivot(r, c);
+  }
+
+  if (shifted) reprice();
+
+  for (int iteration = 0; ; iteration++) {
+    if (iteration > ITERATIONS) return LP_UNSOLVED;
+
+    int c=-1;
+    for (int j = 0; j < RHS && c==-1; j++) {
+      if (obj[j] < -OPTIMALITY) c=j;
+    }
+    if (c==-1) return LP_OPTIMAL;
+
+    int r=-1;
+    double ratio=0;
+    for (int i = 0; i < rows; i++) {
+      if (tab[i][c] <= PIVOT) continue;
+      double q=tab[i][RHS]/tab[i][c];
+      if (r==-1 || q < ratio || (q==ratio && basis[i] < basis[r])) { r=i; ratio=q; }
+    }
+    if (r==-1) return LP_UNSOLVED;
+    pivot(r, c);
+  }
+}
+
+/*=============================================================================
+TinySolver::value - x[j] of the solved LP of a box
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr double TinySolver<MAX_VARS, MAX_ROWS>::value(int j, const Box& box) const{
+
+  for (int i = 0; i < rows; i++) {
+    if (basis[i]==j) return box.lower[j]+(tab[i][RHS] > 0 ? tab[i][RHS] : 0);
+  }
+  return box.lower[j];
+}
+
+/*=============================================================================
+TinySolver::solve - depth first over boxes, up branch first, on the most
+                    fractional variable. Boxes whose parent bound, or whose
+                    own LP value, is within either gap of the incumbent are
+                    pruned. Integral solutions are snapped onto the
+                    integers and their objective recomputed from them.
+===============================================================================*/
+template<int MAX_VARS, int MAX_ROWS>
+constexpr typename TinySolver<MAX_VARS, MAX_ROWS>::Result TinySolver<MAX_VARS, MAX_ROWS>::solve(const Model& model,
+                                                                                                double abs_gap, double rel_gap){
+
+  TinySolver solver;
+  Result result;
+  bool found=false;
+
+  std::array<Box, STACK> open{};
+  int top=0;
+  open[top++]=Box{model.lower, model.upper, TINY_INFINITY};
+
+  while (top > 0) {
+    Box box=open[--top];
+    if (found && within_gap(box.bound, result.eval, abs_gap, rel_gap)) continue;
+
+    if (++result.nodes > NODE_BUDGET) {
+      result.status=TINY_UNSOLVED;
+      break;
+    }
+
+    solver.load(model, box);
+    LPStatus status=solver.simplex();
+    if (status==LP_UNSOLVED) {
+      result.status=TINY_UNSOLVED;
+      break;
+    }
+    if (status==LP_INFEASIBLE) continue;
+
+    double bound=solver.tab[ROWS][RHS];
+    if (found && within_gap(bound, result.eval, abs_gap, rel_gap)) continue;
+
+    int branch=-1;
+    double most=INTEGRALITY;
+    double x=0;
+    for (int j = 0; j < model.vars; j++) {
+      double v=solver.value(j, box);
+      double frac=v-floor_of(v);
+      double distance = frac < 1-frac ? frac : 1-frac;
+      if (distance > most) { most=distance; branch=j; x=v; }
+    }
+
+    if (branch==-1) {
+      std::array<double, MAX_VARS> snapped{};
+      double eval=0;
+      for (int j = 0; j < model.vars; j++) {
+        snapped[j]=floor_of(solver.value(j, box)+0.5);
+        eval+=model.obj[j]*snapped[j];
+      }
+      if (!found || eval > result.eval) {
+        found=true;
+        result.found=true;
+        result.status=TINY_OPTIMAL;
+        result.eval=eval;
+        result.args=snapped;
+      }
+      continue;
+    }
+
+    if (top+2 > STACK) {
+      result.status=TINY_UNSOLVED;
+      break;
+    }
+    result.branched++;
+
+    Box down=box;
+    down.upper[branch]=floor_of(x);
+    down.bound=bound;
+    Box up=box;
+    up.lower[branch]=floor_of(x)+1;
+    up.bound=bound;
+    open[top++]=down;
+    open[top++]=up;
+  }
+
+  result.pivots=solver.pivots;
+  return result;
+}
+
+#endif
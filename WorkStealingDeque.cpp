@@ -0,0 +1,97 @@
+#include "WorkStealingDeque.hpp"
+
+// initial slots per deque
+const long DEQUE_START_SIZE=64;
+
+/*============================================================
+ WorkStealingDeque Constructor - empty deque with a small ring
+=============================================================*/
+WorkStealingDeque::WorkStealingDeque(): top(0), bottom(0), ring(new Ring(DEQUE_START_SIZE)) {}
+
+/*============================================================
+ WorkStealingDeque Destructor - free current and retired rings
+=============================================================*/
+WorkStealingDeque::~WorkStealingDeque(){
+  Ring* r=ring.load(std::memory_order_relaxed);
+  while (r!=NULL){
+    Ring* next=r->retired;
+    delete r;
+    r=next;
+  }
+}
+
+/*============================================================
+ WorkStealingDeque::grow - copy live entries into a ring of
+                          twice the size, keeping the old one
+=============================================================*/
+WorkStealingDeque::Ring* WorkStealingDeque::grow(Ring* old, long b, long t){
+  Ring* bigger=new Ring(2*old->size);
+  for (long i = t; i < b; i++) bigger->put(i, old->get(i));
+  bigger->retired=old;
+  ring.store(bigger, std::memory_order_release);
+  return bigger;
+}
+
+/*============================================================
+ WorkStealingDeque::push - owner adds a node at the bottom
+=============================================================*/
+void WorkStealingDeque::push(Node* n){
+  long b=bottom.load(std::memory_order_relaxed);
+  long t=top.load(std::memory_order_acquire);
+  Ring* r=ring.load(std::memory_order_relaxed);
+
+  if (b-t > r->size-1) r=grow(r, b, t);
+
+  r->put(b, n);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b+1, std::memory_order_relaxed);
+}
+
+/*============================================================
+ WorkStealingDeque::pop - owner takes the newest node, racing
+                          thieves only for the last one
+=============================================================*/
+Node* WorkStealingDeque::pop(){
+  long b=bottom.load(std::memory_order_relaxed)-1;
+  Ring* r=ring.load(std::memory_order_relaxed);
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  long t=top.load(std::memory_order_relaxed);
+
+  Node* n=NULL;
+  if (t <= b){
+    n=r->get(b);
+    if (t == b){
+      //last node, whoever moves top first gets it
+      if (!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed)) n=NULL;
+      bottom.store(b+1, std::memory_order_relaxed);
+    }
+  }
+  else bottom.store(b+1, std::memory_order_relaxed);
+
+  return n;
+}
+
+/*============================================================
+ WorkStealingDeque::steal - take the oldest node from the top
+=============================================================*/
+Node* WorkStealingDeque::steal(){
+  long t=top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  long b=bottom.load(std::memory_order_acquire);
+
+  if (t >= b) return NULL;
+
+  Ring* r=ring.load(std::memory_order_acquire);
+  Node* n=r->get(t);
+  if (!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed)) return NULL;
+
+  return n;
+}
+
+/*============================================================
+ WorkStealingDeque::is_empty - return if no nodes are queued
+=============================================================*/
+bool WorkStealingDeque::is_empty(){
+  return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,44 @@
+#include <atomic>
+#include "Stack.hpp"
+
+#ifndef WORKSTEALINGDEQUE_HPP
+#define WORKSTEALINGDEQUE_HPP
+
+/*=====================================================================
+WorkStealingDeque - Chase-Lev deque of open nodes. The owning worker
+                    pushes and pops at the bottom, so it searches its
+                    own nodes depth first, while idle workers steal the
+                    oldest node, the one nearest the root, from the top.
+                    The circular array grows when full, replaced arrays
+                    are kept until destruction since a thief may still
+                    be reading one.
+=======================================================================*/
+class WorkStealingDeque{
+  private:
+    struct Ring{
+      long size;                        // slots, a power of two
+      std::atomic<Node*>* slots;        // circular node array
+      Ring* retired;                    // previously replaced ring
+
+      Ring(long size): size(size), slots(new std::atomic<Node*>[size]), retired(NULL) {}
+      ~Ring() { delete[] slots; }
+      Node* get(long i) { return slots[i&(size-1)].load(std::memory_order_relaxed); }
+      void put(long i, Node* n) { slots[i&(size-1)].store(n, std::memory_order_relaxed); }
+    };
+
+    std::atomic<long> top;              // next index to steal
+    std::atomic<long> bottom;           // next index to push
+    std::atomic<Ring*> ring;            // current array
+
+    Ring* grow(Ring*, long bottom, long top);
+
+  public:
+    WorkStealingDeque();                // Constructor, empty deque
+    ~WorkStealingDeque();               // Destructor, frees rings but not the nodes
+    void push(Node*);                   // owner only: push onto bottom
+    Node* pop();                        // owner only: pop from bottom, NULL if empty
+    Node* steal();                      // any thread: take from top, NULL if empty or lost a race
+    bool is_empty();                    // approximate when called concurrently
+};
+
+#endif
@@ -0,0 +1,519 @@
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Generators.hpp"
+#include "../BranchAndBound.hpp"
+#include "../Distributed.hpp"
+
+//***************************************
+// Benchmark driver: solves generated
+// instances and prints one JSON object
+// per run, for comparing across commits
+//***************************************
+
+/*=============================================================================
+BenchOptions - what to run, from the command line
+===============================================================================*/
+struct BenchOptions{
+  int family=-1;                // one InstanceFamily, -1 for all of them
+  int size=0;                   // instance size, 0 for the family's default
+  uint64_t seed=1;              // seed of the first run
+  int runs=1;                   // runs per family, seeds seed, seed+1, ...
+  int batch=0;                  // instances per run solved together by a BatchSolver, 0 for one search per run
+  int resolve=0;                // perturbed re-solves per run on an IncrementalSolver, each against a cold solve
+  bool sparse=false;            // SparseLP instead of Tableau
+  bool presolve=false;          // run each single search through a Presolver, timed with the search
+  const char* label="";         // copied into every result, e.g. a commit id
+  const char* trace=NULL;       // file receiving the explored trees, DOT if it ends in .dot
+  const char* coordinate=NULL;  // address a coordinate_search listens on, NULL to search in process
+  int workers=0;                // local worker processes forked for each coordinated run
+  const char* serve=NULL;       // address of a coordinator to serve each run's instance to
+  bool incumbents=false;        // print each improving solution's value and time on stderr
+  SearchSettings settings;
+};
+
+// seconds a worker keeps trying to reach a coordinator that is not listening yet
+const int CONNECT_SECONDS=10;
+
+// sizes that solve in well under a second each on the dense engine
+const int DEFAULT_SIZES[FAMILY_COUNT]={35, 70, 150, 40, 35};
+
+/*=============================================================================
+peak_rss_kb - largest resident set of the process so far, in KiB
+===============================================================================*/
+long peak_rss_kb(){
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+/*=============================================================================
+usage - print the command line options and exit
+===============================================================================*/
+void usage(const char* program){
+  std::cerr<<"usage: "<<program<<" [--family name|all] [--size n] [--seed s] [--runs k] [--batch n] [--resolve k]"<<std::endl
+           <<"       [--engine dense|sparse] [--threads t] [--deterministic] [--presolve]"<<std::endl
+           <<"       [--selection depth|best|estimate|depth_then_best] [--label text]"<<std::endl
+           <<"       [--cuts rounds] [--cut-depth d]"<<std::endl
+           <<"       [--branching first|most|pseudocost|strong|reliability]"<<std::endl
+           <<"       [--no-heuristics] [--heuristic-frequency n]"<<std::endl
+           <<"       [--pricing dantzig|partial|devex|steepest] [--no-tiny]"<<std::endl
+           <<"       [--spill nodes] [--spill-dir directory]"<<std::endl
+           <<"       [--checkpoint file] [--checkpoint-interval s] [--resume]"<<std::endl
+           <<"       [--coordinate unix:path|host:port [--workers n]] [--serve unix:path|host:port]"<<std::endl
+           <<"       [--time-limit s] [--node-limit n] [--memory-stop MiB] [--incumbents]"<<std::endl
+           <<"       [--trace file.jsonl|file.dot]"<<std::endl
+           <<"families:";
+  for (int f = 0; f < FAMILY_COUNT; f++) std::cerr<<" "<<family_name((InstanceFamily)f);
+  std::cerr<<std::endl;
+  exit(2);
+}
+
+/*=============================================================================
+parse_options - fill BenchOptions from argv, exit with usage on bad input
+===============================================================================*/
+BenchOptions parse_options(int argc, char const *argv[]){
+
+  BenchOptions options;
+
+  for (int i = 1; i < argc; i++){
+    const char* arg=argv[i];
+    const char* value = (i+1 < argc) ? argv[i+1] : NULL;
+    bool takes_value=true;
+
+    if (strcmp(arg, "--deterministic")==0) { options.settings.deterministic=true; takes_value=false; }
+    else if (strcmp(arg, "--presolve")==0) { options.presolve=true; takes_value=false; }
+    else if (strcmp(arg, "--no-heuristics")==0) { options.settings.heuristics=false; takes_value=false; }
+    else if (strcmp(arg, "--no-tiny")==0) { options.settings.tiny=false; takes_value=false; }
+    else if (strcmp(arg, "--resume")==0) { options.settings.resume=true; takes_value=false; }
+    else if (strcmp(arg, "--incumbents")==0) { options.incumbents=true; takes_value=false; }
+    else if (value==NULL) usage(argv[0]);
+    else if (strcmp(arg, "--family")==0) {
+      options.family = strcmp(value, "all")==0 ? -1 : parse_family(value);
+      if (options.family==FAMILY_COUNT) usage(argv[0]);
+    }
+    else if (strcmp(arg, "--size")==0) options.size=atoi(value);
+    else if (strcmp(arg, "--seed")==0) options.seed=strtoull(value, NULL, 10);
+    else if (strcmp(arg, "--runs")==0) options.runs=atoi(value);
+    else if (strcmp(arg, "--batch")==0) options.batch=atoi(value);
+    else if (strcmp(arg, "--resolve")==0) options.resolve=atoi(value);
+    else if (strcmp(arg, "--threads")==0) options.settings.threads=atoi(value);
+    else if (strcmp(arg, "--cuts")==0) options.settings.cut_rounds=atoi(value);
+    else if (strcmp(arg, "--cut-depth")==0) options.settings.cut_depth=atoi(value);
+    else if (strcmp(arg, "--heuristic-frequency")==0) options.settings.heuristic_frequency=atoi(value);
+    else if (strcmp(arg, "--spill")==0) options.settings.spill_nodes=atoi(value);
+    else if (strcmp(arg, "--spill-dir")==0) options.settings.spill_directory=value;
+    else if (strcmp(arg, "--checkpoint")==0) options.settings.checkpoint=value;
+    else if (strcmp(arg, "--checkpoint-interval")==0) options.settings.checkpoint_interval=atof(value);
+    else if (strcmp(arg, "--time-limit")==0) options.settings.time_limit=atof(value);
+    else if (strcmp(arg, "--node-limit")==0) options.settings.node_limit=atol(value);
+    else if (strcmp(arg, "--memory-stop")==0) options.settings.memory_stop=(size_t)atol(value)<<20;
+    else if (strcmp(arg, "--coordinate")==0) options.coordinate=value;
+    else if (strcmp(arg, "--workers")==0) options.workers=atoi(value);
+    else if (strcmp(arg, "--serve")==0) options.serve=value;
+    else if (strcmp(arg, "--label")==0) options.label=value;
+    else if (strcmp(arg, "--trace")==0) options.trace=value;
+    else if (strcmp(arg, "--engine")==0) {
+      if (strcmp(value, "sparse")==0) options.sparse=true;
+      else if (strcmp(value, "dense")!=0) usage(argv[0]);
+    }
+    else if (strcmp(arg, "--branching")==0) {
+      if (strcmp(value, "first")==0) options.settings.branching=FIRST_FRACTIONAL;
+      else if (strcmp(value, "most")==0) options.settings.branching=MOST_FRACTIONAL;
+      else if (strcmp(value, "pseudocost")==0) options.settings.branching=PSEUDOCOST;
+      else if (strcmp(value, "strong")==0) options.settings.branching=STRONG;
+      else if (strcmp(value, "reliability")==0) options.settings.branching=RELIABILITY;
+      else usage(argv[0]);
+    }
+    else if (strcmp(arg, "--pricing")==0) {
+      if (strcmp(value, "dantzig")==0) options.settings.pricing=PRICE_DANTZIG;
+      else if (strcmp(value, "partial")==0) options.settings.pricing=PRICE_PARTIAL;
+      else if (strcmp(value, "devex")==0) options.settings.pricing=PRICE_DEVEX;
+      else if (strcmp(value, "steepest")==0) options.settings.pricing=PRICE_STEEPEST_EDGE;
+      else usage(argv[0]);
+    }
+    else if (strcmp(arg, "--selection")==0) {
+      if (strcmp(value, "depth")==0) options.settings.selection=DEPTH_FIRST;
+      else if (strcmp(value, "best")==0) options.settings.selection=BEST_FIRST;
+      else if (strcmp(value, "estimate")==0) options.settings.selection=BEST_ESTIMATE;
+      else if (strcmp(value, "depth_then_best")==0) options.settings.selection=DEPTH_THEN_BEST;
+      else usage(argv[0]);
+    }
+    else usage(argv[0]);
+
+    if (takes_value) i++;
+  }
+
+  if (options.runs < 1 || options.size < 0 || options.batch < 0 || options.resolve < 0 || options.settings.threads < 1 || options.settings.spill_nodes < 0 ||
+      options.workers < 0) usage(argv[0]);
+  if ((options.coordinate!=NULL || options.serve!=NULL) && (options.presolve || options.batch > 0)) usage(argv[0]);
+  if (options.resolve > 0 && (options.batch > 0 || options.presolve || options.sparse || options.coordinate!=NULL ||
+                              options.serve!=NULL)) usage(argv[0]);
+  return options;
+}
+
+/*=============================================================================
+print_histogram - a Histogram as a JSON object of its count, mean and
+                  bucketed median, 90th and 99th percentile
+===============================================================================*/
+void print_histogram(const Histogram& h){
+  std::cout<<"{\"count\":"<<h.count
+           <<",\"mean\":"<<h.mean()
+           <<",\"p50\":"<<h.quantile(0.5)
+           <<",\"p90\":"<<h.quantile(0.9)
+           <<",\"p99\":"<<h.quantile(0.99)
+           <<"}";
+}
+
+/*=============================================================================
+status_name - a SearchStatus as it appears in the JSON output
+===============================================================================*/
+const char* status_name(SearchStatus status){
+  switch (status) {
+    case SEARCH_TIME_LIMIT: return "time_limit";
+    case SEARCH_NODE_LIMIT: return "node_limit";
+    case SEARCH_MEMORY_LIMIT: return "memory_limit";
+    case SEARCH_UNBOUNDED: return "unbounded";
+    default: return "complete";
+  }
+}
+
+/*=============================================================================
+print_incumbent - incumbent callback of --incumbents, one JSON line per
+                  improving solution on stderr, timed from the search's start
+===============================================================================*/
+void print_incumbent(const OptimalSolution* sol, void* data){
+  auto start=*(std::chrono::steady_clock::time_point*)data;
+  std::cerr<<"{\"incumbent\":"<<sol->eval
+           <<",\"t_s\":"<<std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()
+           <<"}"<<std::endl;
+}
+
+/*=============================================================================
+serve_instance - be a worker for the instance's coordinator, retrying while
+                 it is not listening yet
+===============================================================================*/
+void serve_instance(InstanceFamily family, int size, uint64_t seed, BenchOptions& options){
+
+  LinearProgram* lp=generate_instance(family, size, seed, options.sparse);
+  for (int attempt = 0; ; attempt++) {
+    try {
+      serve_search(lp, options.serve, options.settings);
+      break;
+    }
+    catch (const std::runtime_error& e) {
+      if (attempt >= CONNECT_SECONDS*10) {
+        std::cerr<<e.what()<<std::endl;
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+  delete lp;
+}
+
+/*=============================================================================
+coordinate_instance - coordinate_search an instance with the local workers
+                      forked for it, each regenerating the instance. The
+                      wall time includes forking them.
+===============================================================================*/
+OptimalSolution* coordinate_instance(InstanceFamily family, int size, uint64_t seed, BenchOptions& options,
+                                     LinearProgram* lp, SearchSettings& settings){
+
+  std::vector<pid_t> children;
+  for (int w = 0; w < options.workers; w++) {
+    pid_t pid=fork();
+    if (pid==0) {
+      BenchOptions worker=options;
+      worker.serve=options.coordinate;
+      serve_instance(family, size, seed, worker);
+      _exit(0);
+    }
+    if (pid > 0) children.push_back(pid);
+  }
+
+  OptimalSolution* opt=coordinate_search(lp, options.coordinate, std::max(options.workers, 1), settings);
+  //workers still trying to join a search that already ended are stopped
+  for (size_t w = 0; w < children.size(); w++) {
+    kill(children[w], SIGTERM);
+    waitpid(children[w], NULL, 0);
+  }
+  return opt;
+}
+
+/*=============================================================================
+run_instance - generate, solve and report one instance as a JSON line.
+              Generation is not timed, peak RSS covers the whole process.
+===============================================================================*/
+void run_instance(InstanceFamily family, int size, uint64_t seed, BenchOptions& options, TreeTrace* trace){
+
+  if (options.serve!=NULL) {
+    serve_instance(family, size, seed, options);
+    return;
+  }
+
+  LinearProgram* lp=NULL;
+  Presolver* presolver=NULL;
+  if (options.presolve) presolver=generate_presolver(family, size, seed);
+  else lp=generate_instance(family, size, seed, options.sparse);
+
+  SearchStats stats;
+  SearchSettings settings=options.settings;
+  settings.stats=&stats;
+  settings.trace=trace;
+
+  auto start=std::chrono::steady_clock::now();
+  if (options.incumbents) {
+    settings.on_incumbent=print_incumbent;
+    settings.callback_data=&start;
+  }
+  OptimalSolution* opt;
+  if (options.coordinate!=NULL) opt=coordinate_instance(family, size, seed, options, lp, settings);
+  else opt = presolver!=NULL ? branch_and_bound(*presolver, settings, options.sparse)
+                             : branch_and_bound(lp, settings);
+  double wall=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+  std::cout<<"{\"label\":\""<<options.label<<"\""
+           <<",\"family\":\""<<family_name(family)<<"\""
+           <<",\"size\":"<<size
+           <<",\"seed\":"<<seed
+           <<",\"engine\":\""<<(options.sparse ? "sparse" : "dense")<<"\""
+           <<",\"scalar\":\""<<(options.sparse ? "double" : Tableau::scalar_name())<<"\""
+           <<",\"threads\":"<<settings.threads
+           <<",\"workers\":"<<options.workers
+           <<",\"presolve\":"<<(options.presolve ? "true" : "false");
+  if (presolver!=NULL) {
+    std::cout<<",\"presolved_rows\":"<<presolver->get_rows()
+             <<",\"presolved_vars\":"<<presolver->get_vars();
+  }
+  std::cout<<",\"objective\":";
+  if (opt==NULL) std::cout<<"null";
+  else std::cout<<opt->eval;
+  std::cout<<",\"status\":\""<<status_name(stats.status)<<"\""
+           <<",\"bound\":";
+  if (stats.bound==-FLT_MAX || std::isinf(stats.bound)) std::cout<<"null";
+  else std::cout<<stats.bound;
+  std::cout<<",\"gap\":";
+  if (std::isinf(stats.gap)) std::cout<<"null";
+  else std::cout<<stats.gap;
+  std::cout<<",\"wall_s\":"<<wall
+           <<",\"nodes\":"<<stats.nodes
+           <<",\"nodes_per_s\":"<<stats.nodes/wall
+           <<",\"lps\":"<<stats.lps
+           <<",\"pivots\":"<<stats.pivots
+           <<",\"pivots_per_s\":"<<stats.pivots/wall
+           <<",\"tree_size\":"<<stats.tree_size
+           <<",\"max_open\":"<<stats.max_open
+           <<",\"pruned\":"<<stats.pruned
+           <<",\"infeasible\":"<<stats.infeasible
+           <<",\"integral\":"<<stats.integral
+           <<",\"unsolved\":"<<stats.unsolved
+           <<",\"root_cuts\":"<<stats.root_cuts
+           <<",\"node_cuts\":"<<stats.node_cuts
+           <<",\"strong_lps\":"<<stats.strong_lps
+           <<",\"heuristic_lps\":"<<stats.heuristic_lps
+           <<",\"heuristic_solutions\":"<<stats.heuristic_solutions
+           <<",\"spilled\":"<<stats.spilled
+           <<",\"restored\":"<<stats.restored
+           <<",\"peak_rss_kb\":"<<peak_rss_kb();
+
+#ifdef BB_PROFILE
+  std::cout<<",\"pivots_per_lp\":";
+  print_histogram(stats.pivots_per_lp);
+  for (int p = 0; p < PHASE_COUNT; p++){
+    std::cout<<",\""<<phase_name((ProfilePhase)p)<<"_ns\":";
+    print_histogram(stats.phase_ns[p]);
+  }
+#endif
+  std::cout<<"}"<<std::endl;
+
+  if (opt!=NULL) {
+    delete[] opt->args;
+    delete opt;
+  }
+  delete lp;
+  delete presolver;
+}
+
+/*=============================================================================
+run_batch - generate options.batch instances with consecutive seeds, solve
+            them on the solver's workers and report the batch as a JSON line.
+            Generation is not timed.
+===============================================================================*/
+void run_batch(InstanceFamily family, int size, uint64_t seed, BenchOptions& options, BatchSolver& solver){
+
+  std::vector<LinearProgram*> problems;
+  for (int i = 0; i < options.batch; i++) problems.push_back(generate_instance(family, size, seed+i, options.sparse));
+
+  auto start=std::chrono::steady_clock::now();
+  std::vector<OptimalSolution*> results=solver.solve(problems, options.settings);
+  double wall=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+  int solved=0;
+  for (size_t i = 0; i < results.size(); i++){
+    if (results[i]==NULL) continue;
+    solved++;
+    delete[] results[i]->args;
+    delete results[i];
+  }
+  for (size_t i = 0; i < problems.size(); i++) delete problems[i];
+
+  std::cout<<"{\"label\":\""<<options.label<<"\""
+           <<",\"family\":\""<<family_name(family)<<"\""
+           <<",\"size\":"<<size
+           <<",\"seed\":"<<seed
+           <<",\"engine\":\""<<(options.sparse ? "sparse" : "dense")<<"\""
+           <<",\"scalar\":\""<<(options.sparse ? "double" : Tableau::scalar_name())<<"\""
+           <<",\"threads\":"<<options.settings.threads
+           <<",\"batch\":"<<options.batch
+           <<",\"solved\":"<<solved
+           <<",\"wall_s\":"<<wall
+           <<",\"problems_per_s\":"<<options.batch/wall
+           <<",\"peak_rss_kb\":"<<peak_rss_kb()
+           <<"}"<<std::endl;
+}
+
+/*=============================================================================
+run_resolve - solve an instance, then options.resolve times move about a
+              quarter of its objective coefficients by up to 5% and its
+              right hand sides by up to 3%, as a rolling horizon would.
+              Each change is solved warm on the IncrementalSolver and cold
+              on a fresh one given the same data, and the run is reported
+              as a JSON line with the totals of both. Only the solves are
+              timed, the first one excluded.
+===============================================================================*/
+void run_resolve(InstanceFamily family, int size, uint64_t seed, BenchOptions& options){
+
+  IncrementalSolver* warm=generate_incremental(family, size, seed);
+  SeededRandom rng(seed);
+  int vars=warm->get_vars(), rows=warm->get_rows();
+  std::vector<float> cost(warm->get_cost(), warm->get_cost()+vars);
+
+  SearchStats stats;
+  SearchSettings settings=options.settings;
+  settings.stats=&stats;
+
+  OptimalSolution* opt=warm->solve(settings);
+  double warm_s=0, cold_s=0;
+  long warm_nodes=0, cold_nodes=0, warm_pivots=0, cold_pivots=0;
+  int mismatches=0;
+
+  for (int k = 0; k < options.resolve; k++){
+    for (size_t j = 0; j < vars; j++) {
+      if (rng.between(0, 3)==0) cost[j]*=1+rng.between(-5, 5)/100.0f;
+    }
+    warm->set_cost(cost.data());
+    for (size_t i = 0; i < rows; i++) {
+      float rhs=warm->get_rhs(i);
+      if (rhs >= 10) warm->set_rhs(i, std::floor(rhs*(1+rng.between(-3, 3)/100.0f)));
+    }
+
+    IncrementalSolver* cold=generate_incremental(family, size, seed);
+    cold->set_cost(cost.data());
+    for (size_t i = 0; i < rows; i++) cold->set_rhs(i, warm->get_rhs(i));
+
+    if (opt!=NULL) {
+      delete[] opt->args;
+      delete opt;
+    }
+    auto start=std::chrono::steady_clock::now();
+    opt=warm->solve(settings);
+    warm_s+=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    warm_nodes+=stats.nodes;
+    warm_pivots+=stats.pivots;
+
+    start=std::chrono::steady_clock::now();
+    OptimalSolution* reference=cold->solve(settings);
+    cold_s+=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    cold_nodes+=stats.nodes;
+    cold_pivots+=stats.pivots;
+
+    if ((opt==NULL)!=(reference==NULL) ||
+        (opt!=NULL && std::fabs(opt->eval-reference->eval) > 1e-3*std::fmax(1.0f, std::fabs(reference->eval)))) mismatches++;
+    if (reference!=NULL) {
+      delete[] reference->args;
+      delete reference;
+    }
+    delete cold;
+  }
+
+  std::cout<<"{\"label\":\""<<options.label<<"\""
+           <<",\"family\":\""<<family_name(family)<<"\""
+           <<",\"size\":"<<size
+           <<",\"seed\":"<<seed
+           <<",\"engine\":\"dense\""
+           <<",\"scalar\":\""<<Tableau::scalar_name()<<"\""
+           <<",\"threads\":"<<settings.threads
+           <<",\"resolves\":"<<options.resolve
+           <<",\"objective\":";
+  if (opt==NULL) std::cout<<"null";
+  else std::cout<<opt->eval;
+  std::cout<<",\"warm_s\":"<<warm_s
+           <<",\"cold_s\":"<<cold_s
+           <<",\"warm_fraction\":"<<(cold_s > 0 ? warm_s/cold_s : 0)
+           <<",\"warm_nodes\":"<<warm_nodes
+           <<",\"cold_nodes\":"<<cold_nodes
+           <<",\"warm_pivots\":"<<warm_pivots
+           <<",\"cold_pivots\":"<<cold_pivots
+           <<",\"mismatches\":"<<mismatches
+           <<",\"peak_rss_kb\":"<<peak_rss_kb()
+           <<"}"<<std::endl;
+
+  if (opt!=NULL) {
+    delete[] opt->args;
+    delete opt;
+  }
+  delete warm;
+}
+
+/*=============================================================================
+Benchmark driver - every selected family, runs times each with consecutive
+                  seeds, one JSON object per line on stdout
+===============================================================================*/
+int main(int argc, char const *argv[]) {
+
+  BenchOptions options=parse_options(argc, argv);
+
+  std::ofstream trace_file;
+  TreeTrace* trace=NULL;
+  if (options.trace!=NULL){
+    trace_file.open(options.trace);
+    if (!trace_file) {
+      std::cerr<<options.trace<<": cannot open"<<std::endl;
+      return 1;
+    }
+    size_t length=strlen(options.trace);
+    bool dot = length >= 4 && strcmp(options.trace+length-4, ".dot")==0;
+    trace=new TreeTrace(trace_file, dot ? TRACE_DOT : TRACE_JSONL);
+  }
+
+  //batches run on workers of their own, each search stays serial
+  BatchSolver* solver = options.batch > 0 ? new BatchSolver(options.settings.threads) : NULL;
+
+  for (int f = 0; f < FAMILY_COUNT; f++){
+    if (options.family!=-1 && options.family!=f) continue;
+
+    InstanceFamily family=(InstanceFamily)f;
+    int size = options.size > 0 ? options.size : DEFAULT_SIZES[f];
+
+    for (int r = 0; r < options.runs; r++){
+      if (options.batch > 0) run_batch(family, size, options.seed+(uint64_t)r*options.batch, options, *solver);
+      else if (options.resolve > 0) run_resolve(family, size, options.seed+r, options);
+      else run_instance(family, size, options.seed+r, options, trace);
+    }
+  }
+
+  delete solver;
+  delete trace;
+  return 0;
+}
@@ -0,0 +1,211 @@
+#include <cstring>
+#include <algorithm>
+#include "Generators.hpp"
+
+//***************************************
+// Seeded generators of benchmark integer
+// programs, in the dense row form both
+// LP engines are constructed from
+//***************************************
+
+const char* FAMILY_NAMES[FAMILY_COUNT]={"knapsack", "multi_knapsack", "set_cover", "assignment", "random_dense"};
+
+const char* family_name(InstanceFamily family){
+  return FAMILY_NAMES[family];
+}
+
+InstanceFamily parse_family(const char* name){
+  for (int f = 0; f < FAMILY_COUNT; f++) if (strcmp(name, FAMILY_NAMES[f])==0) return (InstanceFamily)f;
+  return FAMILY_COUNT;
+}
+
+/*=============================================================================
+DenseInstance - objective, rows of var_count+1 entries ending in the right
+                hand side, and the column and row bounds to apply once the
+                LP is built. Rows are A x <= rhs unless marked equal.
+===============================================================================*/
+struct DenseInstance{
+  int vars, rows;
+  float* obj;
+  float** cons;
+  bool binary;        // every variable in [0,1]
+  bool* equal;        // row holds with equality, its slack fixed at 0
+
+  DenseInstance(int var_count, int row_count): vars(var_count), rows(row_count), binary(false){
+    obj=new float[vars]();
+    cons=new float*[rows];
+    equal=new bool[rows]();
+    for (size_t i = 0; i < rows; i++) cons[i]=new float[vars+1]();
+  }
+
+  ~DenseInstance(){
+    for (size_t i = 0; i < rows; i++) delete[] cons[i];
+    delete[] cons;
+    delete[] equal;
+    delete[] obj;
+  }
+
+  //build an engine, or a Presolver, from the arrays and apply the bounds
+  template<class LP> LP* build(){
+    LP* lp=new LP(obj, vars, cons, rows);
+    if (binary) for (size_t j = 0; j < vars; j++) lp->set_bounds(j, 0, 1);
+    for (size_t i = 0; i < rows; i++) if (equal[i]) lp->set_bounds(vars+i, 0, 0);
+    return lp;
+  }
+};
+
+/*=============================================================================
+knapsack - weights in [10,100], profits 10 above their weight, capacity
+          half the total weight
+===============================================================================*/
+static void knapsack(DenseInstance& ip, SeededRandom& rng){
+  float total=0;
+  for (size_t j = 0; j < ip.vars; j++) {
+    int weight=rng.between(10, 100);
+    ip.cons[0][j]=weight;
+    ip.obj[j]=weight+10;
+    total+=weight;
+  }
+  ip.cons[0][ip.vars]=std::floor(total/2);
+  ip.binary=true;
+}
+
+/*=============================================================================
+multi_knapsack - independent weights and profits in [1,100], each row's
+                capacity half its total weight
+===============================================================================*/
+static void multi_knapsack(DenseInstance& ip, SeededRandom& rng){
+  for (size_t j = 0; j < ip.vars; j++) ip.obj[j]=rng.between(1, 100);
+  for (size_t i = 0; i < ip.rows; i++) {
+    float total=0;
+    for (size_t j = 0; j < ip.vars; j++) {
+      ip.cons[i][j]=rng.between(1, 100);
+      total+=ip.cons[i][j];
+    }
+    ip.cons[i][ip.vars]=std::floor(total/2);
+  }
+  ip.binary=true;
+}
+
+/*=============================================================================
+set_cover - each row covered by 2 to 5 random columns, costs in [1,100].
+            Written for maximization as -cost.x with -A x <= -1.
+===============================================================================*/
+static void set_cover(DenseInstance& ip, SeededRandom& rng){
+  for (size_t j = 0; j < ip.vars; j++) ip.obj[j]=-rng.between(1, 100);
+  for (size_t i = 0; i < ip.rows; i++) {
+    int covers=rng.between(2, 5);
+    for (int k = 0; k < covers; k++) ip.cons[i][rng.between(0, ip.vars-1)]=-1;
+    ip.cons[i][ip.vars]=-1;
+  }
+  ip.binary=true;
+}
+
+/*=============================================================================
+assignment - profit in [1,100] of worker w on job t at column w*n+t, one
+            equality row per worker and per job
+===============================================================================*/
+static void assignment(DenseInstance& ip, SeededRandom& rng, int n){
+  for (size_t j = 0; j < ip.vars; j++) ip.obj[j]=rng.between(1, 100);
+  for (int w = 0; w < n; w++) {
+    for (int t = 0; t < n; t++) {
+      ip.cons[w][w*n+t]=1;
+      ip.cons[n+t][w*n+t]=1;
+    }
+  }
+  for (size_t i = 0; i < ip.rows; i++) {
+    ip.cons[i][ip.vars]=1;
+    ip.equal[i]=true;
+  }
+  ip.binary=true;
+}
+
+/*=============================================================================
+random_dense - every coefficient in [0,20], objective in [1,30], rows with
+              capacity a quarter of their total, so every variable is
+              bounded by the rows alone
+===============================================================================*/
+static void random_dense(DenseInstance& ip, SeededRandom& rng){
+  for (size_t j = 0; j < ip.vars; j++) ip.obj[j]=rng.between(1, 30);
+  for (size_t i = 0; i < ip.rows; i++) {
+    float total=0;
+    for (size_t j = 0; j < ip.vars; j++) {
+      ip.cons[i][j]=rng.between(0, 20);
+      total+=ip.cons[i][j];
+    }
+    ip.cons[i][ip.vars]=std::floor(total/4);
+  }
+  //every column needs a positive entry somewhere to stay bounded
+  for (size_t j = 0; j < ip.vars; j++) if (ip.cons[j%ip.rows][j]==0) ip.cons[j%ip.rows][j]=1;
+}
+
+/*=============================================================================
+fill_instance - arrays of a seeded instance of a family, the caller owns them
+===============================================================================*/
+static DenseInstance* fill_instance(InstanceFamily family, int size, uint64_t seed){
+
+  SeededRandom rng(seed*FAMILY_COUNT+family);
+  int vars=size, rows;
+
+  switch (family){
+    case KNAPSACK:        rows=1; break;
+    case MULTI_KNAPSACK:  rows=std::max(2, size/10); break;
+    case SET_COVER:       rows=2*size; break;
+    case ASSIGNMENT:      vars=size*size; rows=2*size; break;
+    default:              rows=std::max(1, size/2); break;
+  }
+
+  DenseInstance* ip=new DenseInstance(vars, rows);
+
+  switch (family){
+    case KNAPSACK:        knapsack(*ip, rng); break;
+    case MULTI_KNAPSACK:  multi_knapsack(*ip, rng); break;
+    case SET_COVER:       set_cover(*ip, rng); break;
+    case ASSIGNMENT:      assignment(*ip, rng, size); break;
+    default:              random_dense(*ip, rng); break;
+  }
+
+  return ip;
+}
+
+/*=============================================================================
+generate_instance - seeded instance of a family, size items, columns, workers
+                    or variables. Built as a SparseLP if sparse, else as a
+                    Tableau, the caller owns it.
+===============================================================================*/
+LinearProgram* generate_instance(InstanceFamily family, int size, uint64_t seed, bool sparse){
+
+  DenseInstance* ip=fill_instance(family, size, seed);
+  LinearProgram* lp;
+  if (sparse) lp=ip->build<SparseLP>();
+  else lp=ip->build<Tableau>();
+
+  delete ip;
+  return lp;
+}
+
+/*=============================================================================
+generate_presolver - the same instance as generate_instance, handed to a
+                     Presolver instead of an LP engine
+===============================================================================*/
+Presolver* generate_presolver(InstanceFamily family, int size, uint64_t seed){
+
+  DenseInstance* ip=fill_instance(family, size, seed);
+  Presolver* presolver=ip->build<Presolver>();
+
+  delete ip;
+  return presolver;
+}
+
+/*=============================================================================
+generate_incremental - the same instance as generate_instance, held by an
+                       IncrementalSolver for repeated solves
+===============================================================================*/
+IncrementalSolver* generate_incremental(InstanceFamily family, int size, uint64_t seed){
+
+  DenseInstance* ip=fill_instance(family, size, seed);
+  IncrementalSolver* solver=ip->build<IncrementalSolver>();
+
+  delete ip;
+  return solver;
+}
@@ -0,0 +1,65 @@
+#include <cstdint>
+#include "../Presolve.hpp"
+#include "../Incremental.hpp"
+
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+/*=============================================================================
+InstanceFamily - families of generated pure integer programs, all maximizing
+===============================================================================*/
+enum InstanceFamily{
+  KNAPSACK,           // one strongly correlated knapsack row, binary items
+  MULTI_KNAPSACK,     // several uncorrelated knapsack rows, binary items
+  SET_COVER,          // cover every row at least once at least cost, binary columns
+  ASSIGNMENT,         // size workers to size jobs, one each, as equality rows
+  RANDOM_DENSE,       // dense non-negative rows, general integers
+  FAMILY_COUNT
+};
+
+/*=============================================================================
+family_name - name of a family as used on the command line and in results,
+              parse_family - the family of a name, FAMILY_COUNT if unknown
+===============================================================================*/
+const char* family_name(InstanceFamily);
+InstanceFamily parse_family(const char*);
+
+/*=============================================================================
+SeededRandom - splitmix64, so an instance depends only on its seed and not
+               on the standard library's distributions
+===============================================================================*/
+struct SeededRandom{
+  uint64_t state;
+
+  SeededRandom(uint64_t seed): state(seed) {}
+
+  uint64_t next() {
+    uint64_t z=(state+=0x9E3779B97F4A7C15ull);
+    z=(z^(z>>30))*0xBF58476D1CE4E5B9ull;
+    z=(z^(z>>27))*0x94D049BB133111EBull;
+    return z^(z>>31);
+  }
+
+  //uniform integer in [low, high]
+  int between(int low, int high) { return low+(int)(next()%(uint64_t)(high-low+1)); }
+};
+
+/*=============================================================================
+generate_instance - seeded instance of a family, size items, columns, workers
+                    or variables. Built as a SparseLP if sparse, else as a
+                    Tableau, the caller owns it.
+===============================================================================*/
+LinearProgram* generate_instance(InstanceFamily, int size, uint64_t seed, bool sparse);
+
+/*=============================================================================
+generate_presolver - the instance generate_instance builds, as a Presolver
+===============================================================================*/
+Presolver* generate_presolver(InstanceFamily, int size, uint64_t seed);
+
+/*=============================================================================
+generate_incremental - the instance generate_instance builds, as an
+                       IncrementalSolver
+===============================================================================*/
+IncrementalSolver* generate_incremental(InstanceFamily, int size, uint64_t seed);
+
+#endif
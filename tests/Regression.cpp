@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include "../bench/Generators.hpp"
+#include "../BranchAndBound.hpp"
+#include "../Presolve.hpp"
+
+//***************************************
+// Regression driver: each case solves a
+// small instance that once went wrong and
+// checks the result, exit status is the
+// number of failed cases
+//***************************************
+
+/*=============================================================================
+check - report one case, true if it passed
+===============================================================================*/
+bool check(const char* name, bool passed){
+  std::cout<<(passed ? "pass " : "FAIL ")<<name<<std::endl;
+  return passed;
+}
+
+/*=============================================================================
+free_solution - release a solution the search returned, NULL included
+===============================================================================*/
+void free_solution(OptimalSolution* opt){
+  if (opt==NULL) return;
+  delete[] opt->args;
+  delete opt;
+}
+
+/*=============================================================================
+infeasible_shifted_row - a row violated by 3 once a bound of 1e6 has been
+                         folded into its RHS must not be settled as round-off
+===============================================================================*/
+bool infeasible_shifted_row(){
+
+  float obj[]={1,1};
+  float c1[]={1,1,-1000003};
+  float* cons[]={c1};
+
+  Tableau tab(obj,2,cons,1);
+  tab.set_bounds(0,-1e6,10);
+
+  SearchSettings settings;
+  settings.tiny=false;
+  OptimalSolution* opt=branch_and_bound(&tab, settings);
+  bool passed = opt==NULL;
+  free_solution(opt);
+  return check("infeasible_shifted_row", passed);
+}
+
+/*=============================================================================
+rounded_cut_row - round-off a cut row carries from the pivots must not cut
+                  off the optimum of random dense size 40, seed 3, with
+                  three cut rounds
+===============================================================================*/
+bool rounded_cut_row(){
+
+  LinearProgram* lp=generate_instance(RANDOM_DENSE, 40, 3, false);
+  SearchSettings settings;
+  settings.cut_rounds=3;
+  OptimalSolution* opt=branch_and_bound(lp, settings);
+  bool passed = opt!=NULL && std::fabs(opt->eval-249) < 1e-6;
+  free_solution(opt);
+  delete lp;
+  return check("rounded_cut_row", passed);
+}
+
+/*=============================================================================
+presolved_gap - a presolved search stopped early reports its bound and gap
+                in the original problem, a fixed column adding 300 to both
+                the bound and the incumbent
+===============================================================================*/
+bool presolved_gap(){
+
+  float obj[]={23,19,17,13,11,7,100};
+  float c1[]={11,9,8,6,5,3,1,25};
+  float c2[]={3,7,2,9,4,6,1,20};
+  float* cons[]={c1,c2};
+
+  Presolver presolver(obj,7,cons,2);
+  presolver.set_bounds(6,3,3);
+
+  SearchStats stats;
+  SearchSettings settings;
+  settings.stats=&stats;
+  settings.node_limit=1;
+  OptimalSolution* opt=branch_and_bound(presolver, settings);
+  bool passed = opt!=NULL && stats.bound > opt->eval &&
+                std::fabs(stats.gap-(stats.bound-opt->eval)/std::fabs(opt->eval)) < 1e-9;
+  free_solution(opt);
+  return check("presolved_gap", passed);
+}
+
+/*=============================================================================
+large_integer_bound - a fractional LP bound far from zero still rounds down
+                      to the integer below it under an integral objective
+===============================================================================*/
+bool large_integer_bound(){
+
+  float obj[]={3,2};
+  float c1[]={1,1,4};
+  float* cons[]={c1};
+
+  Tableau tab(obj,2,cons,1);
+  SearchContext ctx(&tab, SearchSettings());
+  bool passed = ctx.integer_bound(123456.8)==123456 && ctx.integer_bound(-654321.3)==-654322;
+  return check("large_integer_bound", passed);
+}
+
+int main(int argc, char const *argv[]) {
+
+  int failed=0;
+  failed+=!infeasible_shifted_row();
+  failed+=!rounded_cut_row();
+  failed+=!presolved_gap();
+  failed+=!large_integer_bound();
+
+  std::cout<<failed<<" failed"<<std::endl;
+  return failed;
+}